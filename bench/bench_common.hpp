@@ -0,0 +1,51 @@
+#pragma once
+#include "SimCore.hpp"
+#include <vector>
+#include <cmath>
+#include <thread>
+
+// Settings for headless runs: unbounded frames, no drift logging; frames
+// are driven with SimCore::step() so no real-time pacing is involved.
+inline SimCore::Settings benchSettings(std::size_t threads, std::size_t chunk = 256) {
+    SimCore::Settings s;
+    s.maxFrames = -1;
+    s.threads = threads ? threads : 1;
+    s.chunkSize = chunk;
+    s.driftLogInterval = 0;
+    s.adaptive = false;
+    return s;
+}
+
+// The main.cpp vehicle workload: serial throttle input, parallel force and
+// semi-implicit Euler integration over SoA columns.
+struct PhysicsWorkload {
+    explicit PhysicsWorkload(std::size_t n)
+        : pos(n, 0.0), vel(n, 10.0), thr(n, 0.5), force(n, 0.0) {}
+
+    void install(SimCore& sim) {
+        const std::size_t n = pos.size();
+        auto input   = sim.addPhase("Input");
+        auto physics = sim.addPhase("Physics", n);
+
+        sim.addSerialSubsystem(input, [this, n](std::int64_t f, SimCore::Seconds dt){
+            double t = double(f) * dt.count();
+            for (std::size_t i=0;i<n;++i)
+                thr[i] = 0.5 + 0.05 * std::sin(t + double(i)*0.0005);
+        });
+        sim.addParallelRangeTask(physics, [this](std::size_t b, std::size_t e,
+                                                 std::int64_t, SimCore::Seconds){
+            for (std::size_t i=b;i<e;++i)
+                force[i] = thr[i] * 1000.0;
+        });
+        sim.addParallelRangeTask(physics, [this](std::size_t b, std::size_t e,
+                                                 std::int64_t, SimCore::Seconds dt){
+            double dts = dt.count();
+            for (std::size_t i=b;i<e;++i){
+                vel[i] += (force[i] / 1200.0) * dts;
+                pos[i] += vel[i] * dts;
+            }
+        });
+    }
+
+    std::vector<double> pos, vel, thr, force;
+};
@@ -0,0 +1,432 @@
+#include <benchmark/benchmark.h>
+#include "bench_common.hpp"
+#include "tyre.hpp"
+#include "rigid_body.hpp"
+#include "broadphase.hpp"
+#include "narrowphase.hpp"
+#include "constraint_solver.hpp"
+#include "islands.hpp"
+#include "terrain.hpp"
+#include "aero.hpp"
+#include "powertrain.hpp"
+#include "lod.hpp"
+#include <functional>
+
+// Frame with one empty phase: fixed per-frame bookkeeping cost.
+static void BM_EmptyFrame(benchmark::State& state) {
+    SimCore sim(benchSettings(1));
+    auto phase = sim.addPhase("Empty");
+    sim.addSerialSubsystem(phase, [](std::int64_t, SimCore::Seconds){});
+    for (auto _ : state) sim.step();
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_EmptyFrame);
+
+// One single-chunk wave per frame: dispatch + wake + completion latency.
+static void BM_WaveDispatch(benchmark::State& state) {
+    SimCore sim(benchSettings(std::size_t(state.range(0)), 64));
+    auto phase = sim.addPhase("Wave", 64);
+    sim.addParallelRangeTask(phase, [](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+        benchmark::DoNotOptimize(b + e);
+    });
+    for (auto _ : state) sim.step();
+    state.counters["threads"] = double(state.range(0));
+}
+BENCHMARK(BM_WaveDispatch)->RangeMultiplier(2)->Range(2, 64)->UseRealTime();
+
+// Fixed element count, trivial body: cost per chunk as chunkSize shrinks.
+static void BM_ChunkOverhead(benchmark::State& state) {
+    const std::size_t n = 1u << 16;
+    const auto chunk = std::size_t(state.range(0));
+    SimCore sim(benchSettings(std::thread::hardware_concurrency(), chunk));
+    std::vector<float> data(n, 1.0f);
+    auto phase = sim.addPhase("Chunks", n);
+    sim.addParallelRangeTask(phase, [&](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+        for (std::size_t i=b;i<e;++i) data[i] += 1.0f;
+    });
+    for (auto _ : state) sim.step();
+    const double chunks = double((n + chunk - 1) / chunk);
+    state.counters["chunks"] = chunks;
+    state.counters["ns_per_chunk"] = benchmark::Counter(
+        chunks * double(state.iterations()),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+}
+BENCHMARK(BM_ChunkOverhead)->RangeMultiplier(4)->Range(16, 16384)->UseRealTime();
+
+// Eight back-to-back waves per frame; each wave ends in a full barrier.
+static void BM_Barrier(benchmark::State& state) {
+    constexpr int kWaves = 8;
+    SimCore sim(benchSettings(std::size_t(state.range(0)), 1));
+    auto phase = sim.addPhase("Barriers", std::size_t(state.range(0)));
+    for (int w = 0; w < kWaves; ++w)
+        sim.addParallelRangeTask(phase, [](std::size_t b, std::size_t, std::int64_t, SimCore::Seconds){
+            benchmark::DoNotOptimize(b);
+        });
+    for (auto _ : state) sim.step();
+    state.counters["ns_per_barrier"] = benchmark::Counter(
+        double(kWaves) * double(state.iterations()),
+        benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_Barrier)->RangeMultiplier(2)->Range(2, 64)->UseRealTime();
+
+// Indirect call through SimCore::RangeTask vs. the same lambda called directly.
+static void BM_StdFunctionCall(benchmark::State& state) {
+    double acc = 0.0;
+    SimCore::RangeTask fn = [&acc](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+        acc += double(e - b);
+    };
+    benchmark::DoNotOptimize(fn);
+    for (auto _ : state) {
+        fn(0, 1, 0, SimCore::Seconds{0.001});
+        benchmark::DoNotOptimize(acc);
+    }
+}
+BENCHMARK(BM_StdFunctionCall);
+
+static void BM_DirectCall(benchmark::State& state) {
+    double acc = 0.0;
+    auto fn = [&acc](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+        acc += double(e - b);
+    };
+    for (auto _ : state) {
+        fn(0, 1, 0, SimCore::Seconds{0.001});
+        benchmark::DoNotOptimize(acc);
+    }
+}
+BENCHMARK(BM_DirectCall);
+
+// main.cpp physics (serial input + force + integrate) at 1k .. 10M elements.
+static void BM_PhysicsWorkload(benchmark::State& state) {
+    const auto n = std::size_t(state.range(0));
+    SimCore sim(benchSettings(std::thread::hardware_concurrency()));
+    PhysicsWorkload w(n);
+    w.install(sim);
+    for (auto _ : state) sim.step();
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+    state.counters["elements"] = double(n);
+}
+BENCHMARK(BM_PhysicsWorkload)->RangeMultiplier(10)->Range(1000, 10'000'000)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Telemetry snapshot of 200 channels per frame (copy + block hand-off);
+// the budget is 1% of a 1 kHz frame, i.e. 10 us.
+static void BM_TelemetryRecord(benchmark::State& state) {
+    const std::size_t channels = std::size_t(state.range(0));
+    std::vector<double> col(channels, 1.0);
+    TelemetryRecorder::Config cfg;
+    cfg.path = "/tmp/simcore_bench.stel";
+    cfg.queueBlocks = 64;
+    TelemetryRecorder rec(cfg);
+    rec.addColumn("ch", col);
+    rec.open();
+    std::int64_t frame = 0;
+    for (auto _ : state) {
+        col[std::size_t(frame) % channels] += 0.001;
+        rec.record(frame++);
+    }
+    rec.flush();
+    state.counters["dropped_blocks"] = double(rec.droppedBlocks());
+    std::remove(cfg.path.c_str());
+}
+BENCHMARK(BM_TelemetryRecord)->Arg(200);
+
+// Magic Formula tyre kernel, vectorized (arg1 = 1) vs libm reference (0).
+static void BM_TyreKernel(benchmark::State& state) {
+    const auto n = std::size_t(state.range(0));
+    TyreBatch t(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        t.slipRatio[i] = 0.2 * std::sin(double(i));
+        t.slipAngle[i] = 0.1 * std::cos(double(i));
+        t.load[i]      = 3000.0 + double(i % 100) * 20.0;
+    }
+    const bool vectorized = state.range(1) != 0;
+    for (auto _ : state) {
+        if (vectorized) t.evaluate(0, n);
+        else            t.evaluateReference(0, n);
+        benchmark::DoNotOptimize(t.fx.data());
+    }
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+}
+BENCHMARK(BM_TyreKernel)->ArgsProduct({{400, 4000, 40000}, {0, 1}});
+
+// Tyre phase through SimCore: 4 wheels x cars.
+static void BM_TyrePhase(benchmark::State& state) {
+    const auto wheels = 4 * std::size_t(state.range(0));
+    SimCore sim(benchSettings(std::thread::hardware_concurrency(), 64));
+    TyreBatch t(wheels);
+    std::fill(t.load.begin(), t.load.end(), 3500.0);
+    std::fill(t.slipRatio.begin(), t.slipRatio.end(), 0.04);
+    t.install(sim, sim.addPhase("Tyres"));
+    for (auto _ : state) sim.step();
+    state.SetItemsProcessed(std::int64_t(wheels) * state.iterations());
+}
+BENCHMARK(BM_TyrePhase)->RangeMultiplier(4)->Range(100, 6400)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// 6-DOF integration per scheme (arg0: 0 Euler, 1 Verlet, 2 RK4) over n bodies.
+static void BM_RigidBodyIntegrate(benchmark::State& state) {
+    const auto n = std::size_t(state.range(1));
+    RigidBodySet r(n);
+    for (std::size_t i = 0; i < n; ++i) { r.setBox(i, 1200.0, 1.8, 1.3, 4.4); r.wz[i] = 0.2; }
+    RigidBodyIntegrator::Config cfg;
+    cfg.scheme = RigidBodyIntegrator::Scheme(state.range(0));
+    RigidBodyIntegrator integ(r, cfg);
+    for (auto _ : state) {
+        integ.integrate(0, n, 1e-3);
+        benchmark::DoNotOptimize(r.px.data());
+    }
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+}
+BENCHMARK(BM_RigidBodyIntegrate)->ArgsProduct({{0, 1, 2}, {1000, 10000}});
+
+// Broad phase through SimCore, 100 .. 100k car-sized boxes at constant
+// density (~one car per 200 m^2), bodies moving a little every frame.
+static void BM_BroadPhase(benchmark::State& state) {
+    const auto n = std::size_t(state.range(0));
+    SimCore sim(benchSettings(std::thread::hardware_concurrency()));
+    BroadPhase bp(n);
+    const double side = std::sqrt(double(n) * 200.0);
+    std::vector<double> x(n), y(n);
+    std::uint64_t h = 88172645463325252ull;
+    auto rnd = [&]{ h ^= h << 13; h ^= h >> 7; h ^= h << 17; return double(h >> 11) * 0x1.0p-53; };
+    for (std::size_t i = 0; i < n; ++i) { x[i] = rnd() * side; y[i] = rnd() * side; }
+    auto move = sim.addPhase("Move");
+    sim.addSerialSubsystem(move, [&](std::int64_t f, SimCore::Seconds){
+        const double dx = 0.05 * double(f % 2 ? 1 : -1);
+        for (std::size_t i = 0; i < n; ++i) bp.setBox(i, x[i] + dx, y[i], 0.5, 2.3, 1.0, 0.7);
+    });
+    bp.install(sim);
+    for (auto _ : state) sim.step();
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+    state.counters["pairs"] = double(bp.pairs().size());
+}
+BENCHMARK(BM_BroadPhase)->RangeMultiplier(10)->Range(100, 100'000)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Bounds, broad and narrow phase for tightly packed, tilted boxes resting on
+// the ground (roughly two box/box contacts per body).
+static void BM_NarrowPhase(benchmark::State& state) {
+    const auto n = std::size_t(state.range(0));
+    SimCore sim(benchSettings(std::thread::hardware_concurrency()));
+    RigidBodySet bodies(n);
+    BroadPhase bp(n);
+    NarrowPhase np(bodies, bp);
+    const auto row = std::size_t(std::ceil(std::sqrt(double(n))));
+    std::uint64_t h = 88172645463325252ull;
+    auto rnd = [&]{ h ^= h << 13; h ^= h >> 7; h ^= h << 17; return double(h >> 11) * 0x1.0p-53; };
+    for (std::size_t i = 0; i < n; ++i) {
+        bodies.px[i] = 1.9 * double(i % row) + 0.1 * rnd();
+        bodies.py[i] = 1.9 * double(i / row) + 0.1 * rnd();
+        bodies.pz[i] = 0.45;
+        const double a = 0.2 * (rnd() - 0.5);
+        bodies.qw[i] = std::cos(a); bodies.qx[i] = 0.6 * std::sin(a); bodies.qz[i] = 0.8 * std::sin(a);
+        np.hx[i] = 1.0; np.hy[i] = 1.0; np.hz[i] = 0.5;
+    }
+    auto bounds = sim.addPhase("Bounds", n);
+    sim.addParallelRangeTask(bounds, [&](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+        np.writeBounds(bp, b, e);
+    });
+    bp.install(sim);
+    np.install(sim);
+    for (auto _ : state) sim.step();
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+    state.counters["pairs"]    = double(bp.pairs().size());
+    state.counters["contacts"] = double(np.contacts().size());
+}
+BENCHMARK(BM_NarrowPhase)->RangeMultiplier(10)->Range(1'000, 100'000)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Colored solver alone (contacts collected once) on a resting grid of
+// boxes with springs; arg1 = threads.
+static void BM_ConstraintSolver(benchmark::State& state) {
+    const auto n = std::size_t(state.range(0));
+    SimCore sim(benchSettings(std::size_t(state.range(1))));
+    RigidBodySet bodies(n);
+    BroadPhase bp(n);
+    NarrowPhase np(bodies, bp);
+    ConstraintSolver solver(bodies);
+    const auto row = std::size_t(std::ceil(std::sqrt(double(n))));
+    for (std::size_t i = 0; i < n; ++i) {
+        bodies.px[i] = 0.98 * double(i % row);
+        bodies.py[i] = 0.98 * double(i / row);
+        bodies.pz[i] = 0.49;
+        bodies.setBox(i, 1.0, 1.0, 1.0, 1.0);
+    }
+    for (std::uint32_t i = 0; i + 1 < n; i += 2) {
+        ConstraintSolver::Joint j;
+        j.a = i; j.b = i + 1; j.rest = 0.98; j.frequency = 2.0;
+        solver.addJoint(j);
+    }
+    np.writeBounds(bp, 0, n);
+    bp.update();
+    np.update();
+    solver.setContactSource(&np);
+    solver.install(sim);
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < n; ++i) bodies.vz[i] = -0.1;
+        sim.step();
+    }
+    state.SetItemsProcessed(std::int64_t(solver.constraintCount()) * state.iterations());
+    state.counters["constraints"] = double(solver.constraintCount());
+    state.counters["overflow"]    = double(solver.overflowCount());
+}
+BENCHMARK(BM_ConstraintSolver)->ArgsProduct({{1'000, 10'000}, {1, 4}})
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Island build over a sparse joint graph (many small islands, a few long
+// chains) through SimCore.
+static void BM_Islands(benchmark::State& state) {
+    const auto n = std::size_t(state.range(0));
+    SimCore sim(benchSettings(std::thread::hardware_concurrency()));
+    RigidBodySet bodies(n);
+    ConstraintSolver solver(bodies);
+    std::uint64_t h = 88172645463325252ull;
+    auto rnd = [&]{ h ^= h << 13; h ^= h >> 7; h ^= h << 17; return h; };
+    for (std::size_t k = 0; k < n / 2; ++k) {
+        ConstraintSolver::Joint j;
+        j.a = std::uint32_t(rnd() % n);
+        j.b = std::uint32_t(rnd() % n);
+        solver.addJoint(j);
+    }
+    IslandBuilder::Config cfg;
+    cfg.sleepFrames = 0;                     // all awake: every island gets a job
+    IslandBuilder islands(bodies, cfg);
+    islands.setJointSource(&solver);
+    islands.install(sim);
+    for (auto _ : state) sim.step();
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+    state.counters["islands"] = double(islands.islands().size());
+    state.counters["jobs"]    = double(islands.jobCount());
+}
+BENCHMARK(BM_Islands)->RangeMultiplier(10)->Range(1'000, 100'000)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// Wheel queries on a 1.5 km tiled heightfield: four wheels per car, cars
+// scattered over the map, answered through SimCore. Arg 1 toggles the
+// per-batch sort by tile.
+static void BM_TerrainQuery(benchmark::State& state) {
+    const auto cars = std::size_t(state.range(0));
+    const std::string path = "/tmp/simcore_bench_terrain.ter";
+    {
+        TerrainWriter w(1537, 1537, 1.0);
+        for (std::uint32_t y = 0; y < 1537; ++y)
+            for (std::uint32_t x = 0; x < 1537; ++x) {
+                w.height(x, y) = float(std::sin(x * 0.01) * 5.0 + std::cos(y * 0.013) * 3.0);
+                if (x < 1536 && y < 1536) w.material(x, y) = std::uint8_t((x / 64 + y / 64) % 4);
+            }
+        for (std::uint8_t m = 0; m < 4; ++m) w.setFriction(m, 0.6f + 0.1f * m);
+        if (!w.write(path)) { state.SkipWithError("cannot write terrain"); return; }
+    }
+    Terrain::Config cfg;
+    cfg.sortByTile = state.range(1) != 0;
+    Terrain terrain(cfg);
+    if (!terrain.open(path)) { state.SkipWithError(terrain.error().c_str()); return; }
+    TerrainQueries q;
+    q.resize(cars * 4);
+    std::uint64_t h = 88172645463325252ull;
+    auto rnd = [&]{ h ^= h << 13; h ^= h >> 7; h ^= h << 17; return double(h % 1'000'000) * 1e-6; };
+    for (std::size_t c = 0; c < cars; ++c) {
+        const double x = rnd() * 1530.0, y = rnd() * 1530.0;
+        for (std::size_t w = 0; w < 4; ++w) {
+            q.x[c * 4 + w] = x + (w & 1 ? 1.5 : -1.5);
+            q.y[c * 4 + w] = y + (w & 2 ? 0.8 : -0.8);
+        }
+    }
+    SimCore sim(benchSettings(std::thread::hardware_concurrency()));
+    terrain.install(sim, q);
+    for (auto _ : state) sim.step();
+    state.SetItemsProcessed(std::int64_t(q.size()) * state.iterations());
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_TerrainQuery)->ArgsProduct({{1'000, 25'000}, {0, 1}})
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+// 4D aero lookup over a 16x16x9x9 map (arg1: 0 scalar reference,
+// 1 vectorized, 4 vectorized at rate divider 4, frame advancing).
+static void BM_AeroMap(benchmark::State& state) {
+    const auto n = std::size_t(state.range(0));
+    AeroMap map({AeroMap::Grid{0.01, 0.12, 16}, AeroMap::Grid{0.02, 0.18, 16},
+                 AeroMap::Grid{-0.3, 0.3, 9}, AeroMap::Grid{-0.6, 0.6, 9}});
+    for (std::size_t k = 0; k < map.nodes() * AeroMap::kChannels; ++k) map.data()[k] = float(std::sin(double(k)));
+    const int mode = int(state.range(1));
+    AeroBatch::Config cfg;
+    cfg.rateDivider = mode == 4 ? 4 : 1;
+    AeroBatch a(map, n, cfg);
+    for (std::size_t i = 0; i < n; ++i) {
+        a.rideFront[i] = 0.01 + 0.11 * std::fabs(std::sin(double(i)));
+        a.rideRear[i]  = 0.02 + 0.16 * std::fabs(std::cos(double(i)));
+        a.yaw[i]       = 0.3 * std::sin(0.7 * double(i));
+        a.steer[i]     = 0.6 * std::cos(1.3 * double(i));
+        a.speed[i]     = 60.0;
+    }
+    std::int64_t frame = 0;
+    for (auto _ : state) {
+        if (mode == 0) a.evaluateReference(0, n);
+        else           a.step(0, n, frame++);
+        benchmark::DoNotOptimize(a.force[0].data());
+    }
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+}
+BENCHMARK(BM_AeroMap)->ArgsProduct({{400, 4000}, {0, 1, 4}});
+
+// Powertrain integration of one 1 ms frame (arg1: sub-steps), mixed gears,
+// throttle and clutch so both the locked and the slipping branch are live.
+static void BM_Powertrain(benchmark::State& state) {
+    const auto n = std::size_t(state.range(0));
+    PowertrainBatch::Config cfg;
+    cfg.substeps = int(state.range(1));
+    PowertrainBatch p(n, cfg);
+    for (std::size_t i = 0; i < n; ++i) {
+        p.gear[i] = std::int32_t(1 + i % 6);
+        p.throttle[i] = double(i % 10) / 9.0;
+        p.clutch[i] = i % 7 == 0 ? 0.5 : 1.0;
+        p.engineSpeed[i] = 300.0 + double(i % 300);
+        p.wheelSpeedLeft[i] = p.wheelSpeedRight[i] = 5.0 + double(i % 40);
+    }
+    for (auto _ : state) {
+        p.integrate(0, n, 1e-3);
+        benchmark::DoNotOptimize(p.torqueLeft.data());
+    }
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+}
+BENCHMARK(BM_Powertrain)->ArgsProduct({{400, 4000}, {1, 4}});
+
+// 10k AI cars through SimCore with LOD levels (arg: percent of cars near).
+// Near cars run the powertrain at full rate, mid every 2nd frame, far a
+// kinematic update every 8th; compare 100 (everything at full detail).
+static void BM_Lod(benchmark::State& state) {
+    const std::size_t n = 10'000;
+    const auto nearCars = n * std::size_t(state.range(0)) / 100;
+    SimCore sim(benchSettings(std::thread::hardware_concurrency(), 64));
+    LodScheduler lod(n);
+    PowertrainBatch p(n);
+    std::vector<double> travelled(n, 0.0);
+    for (std::size_t i = 0; i < n; ++i) {
+        p.gear[i] = std::int32_t(1 + i % 6);
+        p.throttle[i] = 0.6;
+        p.engineSpeed[i] = 300.0;
+        p.wheelSpeedLeft[i] = p.wheelSpeedRight[i] = 20.0;
+        lod.distance[i] = i < nearCars ? 50.0 : (i % 2 ? 250.0 : 2000.0);
+    }
+    lod.install(sim);
+    const auto nearPhase = lod.addLevelPhase(sim, 0, "Near");
+    lod.addLevelTask(sim, nearPhase, [&](const std::uint32_t* ids, const double* dt,
+                                         std::size_t b, std::size_t e, std::int64_t) {
+        for (std::size_t k = b; k < e; ++k) p.integrate(ids[k], ids[k] + 1, dt[k]);
+    });
+    const auto midPhase = lod.addLevelPhase(sim, 1, "Mid");
+    lod.addLevelTask(sim, midPhase, [&](const std::uint32_t* ids, const double* dt,
+                                        std::size_t b, std::size_t e, std::int64_t) {
+        for (std::size_t k = b; k < e; ++k) p.integrate(ids[k], ids[k] + 1, dt[k]);
+    });
+    const auto farPhase = lod.addLevelPhase(sim, 2, "Far");
+    lod.addLevelTask(sim, farPhase, [&](const std::uint32_t* ids, const double* dt,
+                                        std::size_t b, std::size_t e, std::int64_t) {
+        for (std::size_t k = b; k < e; ++k) travelled[ids[k]] += 20.0 * 0.3 * dt[k];
+    });
+    for (auto _ : state) sim.step();
+    state.SetItemsProcessed(std::int64_t(n) * state.iterations());
+    state.counters["near"] = double(lod.members(0).size());
+}
+BENCHMARK(BM_Lod)->Arg(100)->Arg(5)->Unit(benchmark::kMicrosecond)->UseRealTime();
@@ -0,0 +1,203 @@
+// Strong / weak scaling harness. Runs workloads headless (SimCore::step,
+// no pacing), sweeps thread and element counts and writes CSV with
+// throughput, speedup, parallel efficiency, worker utilization and a
+// per-phase time breakdown.
+//
+//   simcore_scaling --mode both --threads 1,2,4,8,16,32,64 --elements 100000,1000000
+#include "bench_common.hpp"
+#include "workloads.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static long parseLong(const char* s, long def){ if(!s) return def; char* e=nullptr; long v=strtol(s,&e,10); return (e && *e==0)? v: def; }
+static std::size_t parseSize(const char* s, std::size_t def){
+    if(!s) return def;
+    char* e=nullptr; unsigned long long v=strtoull(s,&e,10); return (e && *e==0)? (std::size_t)v : def;
+}
+static std::vector<std::size_t> parseList(const char* s) {
+    std::vector<std::size_t> out;
+    std::stringstream ss(s);
+    std::string tok;
+    while (std::getline(ss, tok, ','))
+        if (!tok.empty()) out.push_back(parseSize(tok.c_str(), 0));
+    return out;
+}
+
+// Compute-bound kernel: a few transcendental ops per element.
+struct ComputeWorkload {
+    explicit ComputeWorkload(std::size_t n) : x(n, 0.1), y(n, 0.0) {}
+    void install(SimCore& sim) {
+        auto ph = sim.addPhase("Compute", x.size());
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t i=b;i<e;++i) {
+                double v = x[i];
+                for (int k=0;k<8;++k) v = std::sin(v) * 0.5 + std::sqrt(v * v + 1.0) * 0.25;
+                y[i] = v;
+            }
+        });
+    }
+    std::vector<double> x, y;
+};
+
+// Memory-bound kernel: STREAM triad a = b + s*c.
+struct StreamWorkload {
+    explicit StreamWorkload(std::size_t n) : a(n, 0.0), b(n, 1.0), c(n, 2.0) {}
+    void install(SimCore& sim) {
+        auto ph = sim.addPhase("Triad", a.size());
+        sim.addParallelRangeTask(ph, [this](std::size_t lo, std::size_t hi, std::int64_t, SimCore::Seconds){
+            for (std::size_t i=lo;i<hi;++i) a[i] = b[i] + 3.0 * c[i];
+        });
+    }
+    std::vector<double> a, b, c;
+};
+
+struct RunResult {
+    double seconds = 0.0;
+    double workerUtil = 0.0;
+    std::vector<std::pair<std::string, double>> phaseUs;   // avg per frame
+};
+
+template <class W, class... Args>
+static RunResult runOne(std::size_t threads, std::size_t n, std::size_t chunk,
+                        std::int64_t warmup, std::int64_t frames, const Args&... args) {
+    auto s = benchSettings(threads, chunk);
+    s.timePhases = true;
+    SimCore sim(s);
+    auto w = std::make_unique<W>(n, args...);
+    w->install(sim);
+    sim.step(warmup);
+
+    std::vector<std::uint64_t> busy0(sim.workerCount());
+    for (std::size_t i=0;i<busy0.size();++i) busy0[i] = sim.workerBusyNs(i);
+    std::vector<double> phaseNs(sim.phaseCount(), 0.0);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::int64_t f = 0; f < frames; ++f) {
+        sim.step();
+        for (std::size_t p=0;p<phaseNs.size();++p) phaseNs[p] += double(sim.lastPhaseNs(p));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    RunResult r;
+    r.seconds = std::chrono::duration<double>(t1 - t0).count();
+    double busy = 0.0;
+    for (std::size_t i=0;i<busy0.size();++i) busy += double(sim.workerBusyNs(i) - busy0[i]);
+    if (!busy0.empty() && r.seconds > 0)
+        r.workerUtil = busy / (1e9 * r.seconds * double(busy0.size()));
+    for (std::size_t p=0;p<phaseNs.size();++p)
+        r.phaseUs.emplace_back(sim.phaseName(p), phaseNs[p] / double(frames) / 1e3);
+    return r;
+}
+
+static RunResult runWorkload(const std::string& wl, std::size_t threads, std::size_t n,
+                             std::size_t chunk, std::int64_t warmup, std::int64_t frames) {
+    if (wl == "compute") return runOne<ComputeWorkload>(threads, n, chunk, warmup, frames);
+    if (wl == "stream")  return runOne<StreamWorkload>(threads, n, chunk, warmup, frames);
+    if (wl.rfind("synth", 0) == 0) {
+        // synth[:dist+kernel+shape], e.g. synth:heavy+memory+pipeline
+        SyntheticWorkload::Config cfg;
+        SyntheticWorkload::parse(wl.size() > 6 ? wl.substr(6) : std::string(), cfg);
+        return runOne<SyntheticWorkload>(threads, n, chunk, warmup, frames, cfg);
+    }
+    return runOne<PhysicsWorkload>(threads, n, chunk, warmup, frames);
+}
+
+int main(int argc, char* argv[]) {
+    std::string mode = "strong";
+    std::string workload = "physics";
+    std::vector<std::size_t> threadList;
+    std::vector<std::size_t> elemList = {100000, 1000000};
+    std::size_t chunk = 256;
+    std::int64_t frames = 200, warmup = 20;
+    int reps = 3;
+    const char* outPath = nullptr;
+
+    for (std::size_t t = 1; t <= std::max<std::size_t>(1, std::thread::hardware_concurrency()); t *= 2)
+        threadList.push_back(t);
+
+    for (int i=1;i<argc;++i){
+        if (std::strcmp(argv[i],"--mode")==0 && i+1<argc) mode = argv[++i];
+        else if (std::strcmp(argv[i],"--workload")==0 && i+1<argc) workload = argv[++i];
+        else if (std::strcmp(argv[i],"--threads")==0 && i+1<argc) threadList = parseList(argv[++i]);
+        else if (std::strcmp(argv[i],"--elements")==0 && i+1<argc) elemList = parseList(argv[++i]);
+        else if (std::strcmp(argv[i],"--chunk")==0 && i+1<argc) chunk = parseSize(argv[++i], chunk);
+        else if (std::strcmp(argv[i],"--frames")==0 && i+1<argc) frames = parseLong(argv[++i], frames);
+        else if (std::strcmp(argv[i],"--warmup")==0 && i+1<argc) warmup = parseLong(argv[++i], warmup);
+        else if (std::strcmp(argv[i],"--reps")==0 && i+1<argc) reps = (int)parseLong(argv[++i], reps);
+        else if (std::strcmp(argv[i],"--out")==0 && i+1<argc) outPath = argv[++i];
+        else {
+            std::fprintf(stderr,
+                "usage: %s [--mode strong|weak|both] [--workload physics|compute|stream|synth:SPEC]\n"
+                "          [--threads 1,2,4] [--elements N[,N..]] [--chunk C]\n"
+                "          [--frames F] [--warmup W] [--reps R] [--out file.csv]\n"
+                "  strong: N is the total element count; weak: N is elements per thread\n"
+                "  synth:SPEC = '+' list of uniform|heavy|hotspots|varying, compute|memory,\n"
+                "               single|multitask|pipeline (see src/workloads.hpp)\n", argv[0]);
+            return 2;
+        }
+    }
+    if (threadList.empty() || elemList.empty() || frames <= 0 || reps <= 0) return 2;
+    SyntheticWorkload::Config probe;
+    if (workload.rfind("synth", 0) == 0 &&
+        !SyntheticWorkload::parse(workload.size() > 6 ? workload.substr(6) : std::string(), probe)) {
+        std::fprintf(stderr, "bad synth spec '%s' (uniform|heavy|hotspots|varying + compute|memory +"
+                             " single|multitask|pipeline)\n", workload.c_str());
+        return 2;
+    }
+
+    std::FILE* out = outPath ? std::fopen(outPath, "w") : stdout;
+    if (!out) { std::fprintf(stderr, "cannot open %s\n", outPath); return 1; }
+
+    bool header = false;
+    std::vector<std::string> modes;
+    if (mode == "strong" || mode == "both") modes.push_back("strong");
+    if (mode == "weak"   || mode == "both") modes.push_back("weak");
+
+    for (auto& m : modes) {
+        for (std::size_t base : elemList) {
+            double refSeconds = 0.0, refThroughput = 0.0;
+            std::size_t refThreads = 0;
+            for (std::size_t t : threadList) {
+                std::size_t n = (m == "weak") ? base * t : base;
+                // Best of `reps`: the least-disturbed sample of the machine.
+                RunResult best;
+                for (int r = 0; r < reps; ++r) {
+                    auto res = runWorkload(workload, t, n, chunk, warmup, frames);
+                    if (r == 0 || res.seconds < best.seconds) best = std::move(res);
+                }
+                double throughput = double(n) * double(frames) / best.seconds;
+                if (refThreads == 0) {
+                    refThreads = t; refSeconds = best.seconds; refThroughput = throughput;
+                }
+                double scale = double(t) / double(refThreads);
+                double speedup = (m == "strong") ? refSeconds / best.seconds
+                                                 : throughput / refThroughput;
+                double efficiency = (m == "strong") ? speedup / scale
+                                                    : refSeconds / best.seconds;
+
+                if (!header) {
+                    std::fprintf(out, "mode,workload,threads,elements,frames,chunk,seconds,frame_us,"
+                                      "throughput_eps,speedup,efficiency,worker_util");
+                    for (auto& p : best.phaseUs) std::fprintf(out, ",phase_%s_us", p.first.c_str());
+                    std::fprintf(out, "\n");
+                    header = true;
+                }
+                std::fprintf(out, "%s,%s,%zu,%zu,%lld,%zu,%.6f,%.3f,%.0f,%.3f,%.3f,%.3f",
+                             m.c_str(), workload.c_str(), t, n, (long long)frames, chunk,
+                             best.seconds, best.seconds / double(frames) * 1e6,
+                             throughput, speedup, efficiency, best.workerUtil);
+                for (auto& p : best.phaseUs) std::fprintf(out, ",%.3f", p.second);
+                std::fprintf(out, "\n");
+                std::fflush(out);
+            }
+        }
+    }
+    if (out != stdout) std::fclose(out);
+}
@@ -10,8 +10,15 @@
 #include <algorithm>
 #include <string>
 #include <cstring>
+#include <memory>
 #include "logger.hpp"
 #include "profiler.hpp"
+#include "metrics_shm.hpp"
+#include "state_shm.hpp"
+#include "input_channel.hpp"
+#include "telemetry.hpp"
+#include "trace_capture.hpp"
+#include "usdt.hpp"
 
 class SimCore {
 public:
@@ -30,6 +37,7 @@ public:
         int           spinMicros = 200;
         bool          logPhases = false;
         bool          logRangeTasks = false;
+        bool          timePhases = false;   // per-phase / worker busy timing
     };
 
     using Subsystem     = std::function<void(std::int64_t frame, Seconds dt)>;
@@ -44,6 +52,17 @@ public:
         std::vector<ReductionTask> reductions;
         std::size_t                elementCount = 0;
         bool                       enabled      = true;
+        std::size_t                chunkSize    = 0;    // 0 = Settings::chunkSize
+    };
+
+    // Timing of the most recent paced frame (see advance()).
+    struct FrameTiming {
+        std::int64_t frame        = 0;
+        std::int64_t computeNs    = 0;   // doOneStep wall time
+        std::int64_t latenessNs   = 0;   // completion vs deadline (>0 == late)
+        std::int64_t wakeErrorNs  = 0;   // pacing wake-up past the target
+        double       driftMs      = 0.0;
+        int          catchUpSteps = 0;
     };
 
     SimCore() : SimCore(Settings{}) {}
@@ -52,6 +71,45 @@ public:
 
     void setLogger(Logger* l)    { logger_ = l; }
     void setProfiler(Profiler* p){ profiler_ = p; }
+    // Publishing costs a seqlock copy of the frame summary per frame, and
+    // turns on per-phase and per-worker timing (two clock reads per phase
+    // and per worker wave, as with timePhases).
+    void setMetricsPublisher(MetricsPublisher* m) {
+        metrics_ = (m && m->ok()) ? m : nullptr;
+        metricsNamesDirty_ = true;
+        if (metrics_) metrics_->setHz(settings_.hz);
+    }
+    // Device input: producers push from any thread; each frame consumes the
+    // samples timestamped up to its nominal start (now, when stepping).
+    InputChannel& input() { return input_; }
+    // End-to-end latency: an output point reports the age of the newest
+    // input that influenced it each time it is emitted. The default tag is
+    // the newest input consumed so far (main thread / frame tasks only);
+    // pass input().stampNs(ch) for a narrower dependency, or a tag carried
+    // through a pipeline (StateReader::Snapshot::inputNs) from other threads.
+    std::size_t addOutputPoint(const std::string& name) {
+        outputs_.push_back(std::make_unique<OutputLatency>(name));
+        return outputs_.size() - 1;
+    }
+    void markOutput(std::size_t id, std::int64_t inputNs = -1) {
+        outputs_[id]->emit(inputNs < 0 ? input_.newestNs() : inputNs);
+    }
+    OutputLatency& outputPoint(std::size_t id) { return *outputs_[id]; }
+    std::size_t outputPointCount() const { return outputs_.size(); }
+    // Registered columns are copied out at the end of every frame.
+    void setStatePublisher(StatePublisher* s) { state_ = s; }
+    void setTelemetry(TelemetryRecorder* t) {
+        telemetry_ = t;
+        if (telemetry_) telemetry_->setHz(settings_.hz);
+    }
+    // Called on the main thread after every paced frame (see FrameTiming).
+    void setFrameObserver(std::function<void(const FrameTiming&)> fn) {
+        frameObserver_ = std::move(fn);
+    }
+    void setTraceCapture(TraceCapture* t) {
+        trace_ = t;
+        if (trace_) trace_->setSettingsTag(settingsTag());
+    }
 
     void applySettings(const Settings& s) {
         settings_ = s;
@@ -59,6 +117,8 @@ public:
         if (settings_.threads == 0) settings_.threads = 1;
         if (settings_.maxCatchUp < 0) settings_.maxCatchUp = 0;
         recalcTiming();
+        if (metrics_) metrics_->setHz(settings_.hz);
+        if (trace_) trace_->setSettingsTag(settingsTag());
         if (!threads_.empty() && settings_.threads != threadCount_) {
             stopThreads();
             initThreads();
@@ -72,6 +132,8 @@ public:
 
     std::size_t addPhase(const std::string& name, std::size_t elemCount = 0) {
         phases_.emplace_back(Phase{name, {}, {}, {}, elemCount, true});
+        phaseNs_.push_back(0);
+        metricsNamesDirty_ = true;
         LOG_DEBUG(logger_, "AddPhase '{}' elemCount={}", name, elemCount);
         return phases_.size()-1;
     }
@@ -80,6 +142,11 @@ public:
         LOG_DEBUG(logger_, "Phase '{}' set elementCount={}",
                   phases_[phaseIndex].name, count);
     }
+    // Per-phase chunk size, for phases whose elements are coarse work items
+    // (e.g. fixed blocks of a larger array) rather than individual elements.
+    void setPhaseChunkSize(std::size_t phaseIndex, std::size_t chunk) {
+        phases_[phaseIndex].chunkSize = chunk;
+    }
     void addSerialSubsystem(std::size_t phaseIndex, Subsystem fn) {
         phases_[phaseIndex].serialSubsystems.push_back(std::move(fn));
         LOG_TRACE(logger_, "Add serial subsystem to phase '{}'",
@@ -103,16 +170,42 @@ public:
     std::int64_t frame() const { return frame_; }
     double dtSeconds()  const { return dtMicro_.count(); }
     double lastDriftMs() const { return lastDriftMs_; }
+    const FrameTiming& lastFrameTiming() const { return timing_; }
+
+    // Per-phase and per-worker timing; populated when timePhases is set or
+    // a metrics publisher is attached.
+    std::size_t phaseCount() const { return phases_.size(); }
+    const std::string& phaseName(std::size_t i) const { return phases_[i].name; }
+    std::int64_t lastPhaseNs(std::size_t i) const { return phaseNs_[i]; }
+    std::size_t workerCount() const { return threadCount_; }
+    std::uint64_t workerBusyNs(std::size_t i) const {
+        return workerStats_[i].busyNs.load(std::memory_order_relaxed);
+    }
 
     void run() {
         LOG_INFO(logger_, "Run loop start (accumulator)");
         startReal_ = Clock::now();
         accumulator_ = Seconds{0};
         nextFrameTarget_ = startReal_;
+        runStartFrame_ = frame_;
+        paced_ = true;
         while (advance()) { /* loop */ }
+        paced_ = false;
         LOG_INFO(logger_, "Run loop end frame={}", frame_);
     }
 
+    // Run up to n frames back to back with no real-time pacing (benchmarks,
+    // offline batch runs). Honors maxFrames / requestExit; returns frames run.
+    std::int64_t step(std::int64_t n = 1) {
+        std::int64_t done = 0;
+        for (; done < n; ++done) {
+            if (terminate_) break;
+            if (settings_.maxFrames >= 0 && frame_ >= settings_.maxFrames) break;
+            doOneStep();
+        }
+        return done;
+    }
+
 private:
     struct ActiveRange {
         RangeTask*   task         = nullptr;
@@ -121,6 +214,12 @@ private:
         std::size_t  chunkSize    = 0;
         std::int64_t frame        = 0;
         Seconds      dt{};
+        bool         timed        = false;
+        TraceCapture* trace       = nullptr;
+    };
+
+    struct alignas(64) WorkerStat {
+        std::atomic<std::uint64_t> busyNs{0};
     };
 
     void initThreads() {
@@ -128,8 +227,9 @@ private:
         threadCount_ = settings_.threads;
         shutdown_.store(false, std::memory_order_relaxed);
         threads_.reserve(threadCount_);
+        workerStats_ = std::make_unique<WorkerStat[]>(threadCount_);
         for (std::size_t i=0;i<threadCount_;++i)
-            threads_.emplace_back([this]{ workerLoop(); });
+            threads_.emplace_back([this,i]{ workerLoop(i); });
         LOG_INFO(logger_, "Threads initialized count={}", threadCount_);
     }
 
@@ -142,7 +242,7 @@ private:
         LOG_INFO(logger_, "Threads stopped");
     }
 
-    void workerLoop() {
+    void workerLoop(std::size_t workerIdx) {
         std::uint64_t localToken = dispatchToken_.load(std::memory_order_acquire);
         LOG_DEBUG(logger_, "Worker start tid={}", std::this_thread::get_id());
         for (;;) {
@@ -152,12 +252,26 @@ private:
             }
             if (shutdown_.load(std::memory_order_acquire)) break;
             localToken = dispatchToken_.load(std::memory_order_acquire);
-            processActiveRange();
+            TraceCapture* tr = active_.trace;
+            auto tid = static_cast<std::uint16_t>(workerIdx + 1);
+            SIMCORE_PROBE2(worker_wake, tid, localToken);
+            if (tr) tr->record(TraceKind::WaveBegin, active_.frame, tid, 0);
+            if (active_.timed) {
+                auto t0 = Clock::now();
+                processActiveRange(tid);
+                workerStats_[workerIdx].busyNs.fetch_add(
+                    static_cast<std::uint64_t>(toNs(Clock::now() - t0)),
+                    std::memory_order_relaxed);
+            } else {
+                processActiveRange(tid);
+            }
+            if (tr) tr->record(TraceKind::WaveEnd, active_.frame, tid, 0);
+            SIMCORE_PROBE1(worker_sleep, tid);
         }
         LOG_DEBUG(logger_, "Worker exit tid={}", std::this_thread::get_id());
     }
 
-    void processActiveRange() {
+    void processActiveRange(std::uint16_t tid) {
         for (;;) {
             std::size_t idx = nextChunk_.fetch_add(1, std::memory_order_relaxed);
             if (idx >= active_.totalChunks) break;
@@ -166,7 +280,9 @@ private:
             if (settings_.logRangeTasks)
                 LOG_TRACE(logger_, "ChunkStart tid={} idx={} b={} e={}",
                           std::this_thread::get_id(), idx, begin, end);
+            SIMCORE_PROBE4(chunk_begin, tid, idx, begin, end);
             (*active_.task)(begin, end, active_.frame, active_.dt);
+            SIMCORE_PROBE2(chunk_end, tid, idx);
             std::size_t rem = remaining_.fetch_sub(1, std::memory_order_acq_rel) - 1;
             if (settings_.logRangeTasks)
                 LOG_TRACE(logger_, "ChunkDone tid={} idx={} rem={}",
@@ -181,9 +297,15 @@ private:
         if (settings_.maxFrames >= 0 && frame_ >= settings_.maxFrames) return false;
 
         // Run the frame immediately
+        auto t0 = Clock::now();
         doOneStep();
+        auto t1 = Clock::now();
         // Advance target using correct duration type
         nextFrameTarget_ += std::chrono::duration_cast<Clock::duration>(dtMicro_);
+        timing_.frame        = frame_;
+        timing_.computeNs    = toNs(t1 - t0);
+        timing_.latenessNs   = toNs(t1 - nextFrameTarget_);
+        timing_.catchUpSteps = 0;
 
         // Sleep/spin until target
         auto spinBudget = std::chrono::microseconds(settings_.spinMicros);
@@ -197,6 +319,7 @@ private:
                 std::this_thread::sleep_for(std::chrono::microseconds(50));
             }
         }
+        timing_.wakeErrorNs = toNs(Clock::now() - nextFrameTarget_);
 
         if (settings_.adaptive) {
             logDrift();
@@ -204,22 +327,46 @@ private:
             if (behind.count() > 0) {
                 int extra = int(std::chrono::duration<double>(behind).count() / dtMicro_.count());
                 if (extra > settings_.maxCatchUp) extra = settings_.maxCatchUp;
+                SIMCORE_PROBE3(catchup, frame_, extra, toNs(behind));
                 for (int i=0;i<extra;i++) {
                     if (settings_.maxFrames >= 0 && frame_ >= settings_.maxFrames) break;
                     doOneStep();
+                    ++timing_.catchUpSteps;
                 }
+                if (trace_ && timing_.catchUpSteps)
+                    trace_->record(TraceKind::CatchUp, frame_, 0,
+                                   static_cast<std::uint32_t>(timing_.catchUpSteps));
             }
         } else {
             logDrift();
         }
 
+        auto now = Clock::now();
+        double simT = static_cast<double>(frame_) * dtMicro_.count();
+        timing_.driftMs = (simT - std::chrono::duration<double>(now - startReal_).count()) * 1000.0;
+        if (metrics_) publishMetrics(now);
+        if (trace_)   trace_->endFrame(timing_.frame - 1, timing_.latenessNs, timing_.driftMs);
+        if (frameObserver_) frameObserver_(timing_);
+
         return !(settings_.maxFrames >= 0 && frame_ >= settings_.maxFrames);
     }
 
     void doOneStep() {
         PROF_SCOPE(profiler_, "Frame");
-        for (auto& ph : phases_) {
-            if (!ph.enabled) continue;
+        const bool timed = metrics_ != nullptr || settings_.timePhases;
+        SIMCORE_PROBE1(frame_begin, frame_);
+        input_.drain(inputDueNs());
+        if (trace_) {
+            trace_->beginFrame(frame_);
+            trace_->record(TraceKind::FrameBegin, frame_, 0, 0);
+        }
+        for (std::size_t pIdx = 0; pIdx < phases_.size(); ++pIdx) {
+            auto& ph = phases_[pIdx];
+            if (!ph.enabled) { phaseNs_[pIdx] = 0; continue; }
+            auto phaseT0 = timed ? Clock::now() : Clock::time_point{};
+            const auto pTag = static_cast<std::uint32_t>(pIdx);
+            SIMCORE_PROBE3(phase_begin, frame_, pIdx, SIMCORE_USDT_PTR(ph.name.c_str()));
+            if (trace_) trace_->record(TraceKind::PhaseBegin, frame_, 0, pTag);
             if (settings_.logPhases)
                 LOG_DEBUG(logger_, "PhaseBegin '{}' frame={}", ph.name, frame_);
             PROF_SCOPE(profiler_, "Phase:" + ph.name);
@@ -233,7 +380,10 @@ private:
                 std::size_t count = ph.elementCount;
                 for (std::size_t tIdx=0; tIdx < ph.parallelRangeTasks.size(); ++tIdx) {
                     auto& rt = ph.parallelRangeTasks[tIdx];
-                    std::size_t chunk = settings_.chunkSize ? settings_.chunkSize : 256;
+                    const auto tTag = static_cast<std::uint32_t>(tIdx);
+                    if (trace_) trace_->record(TraceKind::TaskBegin, frame_, 0, tTag);
+                    std::size_t chunk = ph.chunkSize ? ph.chunkSize
+                                      : settings_.chunkSize ? settings_.chunkSize : 256;
                     std::size_t totalChunks = (count + chunk - 1)/chunk;
                     active_.task         = &rt;
                     active_.totalChunks  = totalChunks;
@@ -241,8 +391,11 @@ private:
                     active_.chunkSize    = chunk;
                     active_.frame        = frame_;
                     active_.dt           = dtMicro_;
+                    active_.timed        = timed;
+                    active_.trace        = trace_;
                     nextChunk_.store(0, std::memory_order_relaxed);
                     remaining_.store(totalChunks, std::memory_order_release);
+                    SIMCORE_PROBE4(wave_dispatch, frame_, pIdx, tIdx, totalChunks);
                     dispatchToken_.fetch_add(1, std::memory_order_acq_rel);
 
                     while (remaining_.load(std::memory_order_acquire) > 0) {
@@ -254,15 +407,23 @@ private:
                         std::size_t begin = idx * chunk;
                         std::size_t end   = std::min(begin + chunk, count);
                         PROF_SCOPE(profiler_, "RangeTask:" + ph.name + ":" + std::to_string(tIdx));
+                        SIMCORE_PROBE4(chunk_begin, 0, idx, begin, end);
                         rt(begin, end, frame_, dtMicro_);
+                        SIMCORE_PROBE2(chunk_end, 0, idx);
                         if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1)
                             break;
                     }
+                    if (trace_) trace_->record(TraceKind::TaskEnd, frame_, 0, tTag);
                 }
             } else {
-                for (auto& rt : ph.parallelRangeTasks) {
-                    PROF_SCOPE(profiler_, "RangeTask:" + ph.name + ":S");
-                    rt(0, ph.elementCount, frame_, dtMicro_);
+                for (std::size_t tIdx=0; tIdx < ph.parallelRangeTasks.size(); ++tIdx) {
+                    const auto tTag = static_cast<std::uint32_t>(tIdx);
+                    if (trace_) trace_->record(TraceKind::TaskBegin, frame_, 0, tTag);
+                    {
+                        PROF_SCOPE(profiler_, "RangeTask:" + ph.name + ":S");
+                        ph.parallelRangeTasks[tIdx](0, ph.elementCount, frame_, dtMicro_);
+                    }
+                    if (trace_) trace_->record(TraceKind::TaskEnd, frame_, 0, tTag);
                 }
             }
 
@@ -271,9 +432,16 @@ private:
                 red(frame_, dtMicro_);
             }
 
+            if (timed) phaseNs_[pIdx] = toNs(Clock::now() - phaseT0);
+            if (trace_) trace_->record(TraceKind::PhaseEnd, frame_, 0, pTag);
+            SIMCORE_PROBE2(phase_end, frame_, pIdx);
             if (settings_.logPhases)
                 LOG_DEBUG(logger_, "PhaseEnd   '{}' frame={}", ph.name, frame_);
         }
+        if (state_) state_->publish(frame_, static_cast<double>(frame_ + 1) * dtMicro_.count(), input_.newestNs());
+        if (telemetry_) telemetry_->record(frame_);
+        if (trace_) trace_->record(TraceKind::FrameEnd, frame_, 0, 0);
+        SIMCORE_PROBE1(frame_end, frame_);
         ++frame_;
         if ((frame_ & 0x3FF) == 0)
             LOG_INFO(logger_, "Progress frame={}", frame_);
@@ -291,6 +459,51 @@ private:
                  frame_, simT, realT, driftMs);
     }
 
+    std::string settingsTag() const {
+        return "hz=" + std::to_string(settings_.hz) +
+               " threads=" + std::to_string(settings_.threads) +
+               " chunk=" + std::to_string(settings_.chunkSize) +
+               " adaptive=" + std::to_string(settings_.adaptive) +
+               " maxCatchUp=" + std::to_string(settings_.maxCatchUp) +
+               " spinMicros=" + std::to_string(settings_.spinMicros);
+    }
+
+    std::int64_t inputDueNs() const {
+        if (!paced_) return toNs(Clock::now().time_since_epoch());
+        auto nominal = startReal_ + std::chrono::duration_cast<Clock::duration>(
+                                        dtMicro_ * static_cast<double>(frame_ - runStartFrame_));
+        return toNs(nominal.time_since_epoch());
+    }
+
+    static std::int64_t toNs(Clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    }
+
+    // Seqlock publish of the last frame; the monitor does all formatting.
+    void publishMetrics(Clock::time_point now) {
+        auto& p = metrics_->begin();
+        if (metricsNamesDirty_) {
+            for (std::size_t i = 0; i < phases_.size() && i < MetricsBlock::kMaxPhases; ++i)
+                MetricsPublisher::setName(p, i, phases_[i].name);
+            p.phaseCount = static_cast<std::uint32_t>(
+                std::min(phases_.size(), MetricsBlock::kMaxPhases));
+            ++p.namesVersion;
+            metricsNamesDirty_ = false;
+        }
+        p.frame        = timing_.frame;
+        p.frameNs      = timing_.computeNs;
+        p.latenessNs   = timing_.latenessNs;
+        p.driftMs      = timing_.driftMs;
+        p.catchUpSteps = static_cast<std::uint32_t>(timing_.catchUpSteps);
+        p.wallNs       = static_cast<std::uint64_t>(toNs(now - startReal_));
+        for (std::size_t i = 0; i < p.phaseCount; ++i) p.phaseNs[i] = phaseNs_[i];
+        std::size_t nw = std::min(threadCount_, MetricsBlock::kMaxWorkers);
+        p.workerCount = static_cast<std::uint32_t>(nw);
+        for (std::size_t i = 0; i < nw; ++i)
+            p.workerBusyNs[i] = workerStats_[i].busyNs.load(std::memory_order_relaxed);
+        metrics_->commit();
+    }
+
     void recalcTiming() {
         subSteps_  = (settings_.hz > 1000.0)
                    ? int(std::ceil(settings_.hz / 1000.0))
@@ -323,9 +536,23 @@ private:
     std::atomic<std::size_t> remaining_{0};
     std::atomic<std::uint64_t> dispatchToken_{0};
 
+    std::unique_ptr<WorkerStat[]> workerStats_;
+
     std::uint64_t            deterministicHash_ = 0;
     double                   lastDriftMs_ = 0.0;
+    FrameTiming              timing_{};
+    std::vector<std::int64_t> phaseNs_;
 
     Logger*   logger_   = nullptr;
     Profiler* profiler_ = nullptr;
+    MetricsPublisher* metrics_ = nullptr;
+    TraceCapture*     trace_   = nullptr;
+    StatePublisher*   state_   = nullptr;
+    TelemetryRecorder* telemetry_ = nullptr;
+    InputChannel      input_;
+    std::vector<std::unique_ptr<OutputLatency>> outputs_;
+    std::int64_t      runStartFrame_ = 0;
+    bool              paced_ = false;
+    std::function<void(const FrameTiming&)> frameObserver_;
+    bool      metricsNamesDirty_ = true;
 };
@@ -0,0 +1,275 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "SimCore.hpp"
+#include "simd.hpp"
+
+// Aero coefficient map over (front ride height, rear ride height, yaw,
+// steer), on a uniform grid per axis. Nodes are stored steer-fastest with
+// the four channels interleaved as floats (16 bytes per node), in one
+// 64-byte aligned block that any number of AeroBatch instances read
+// concurrently. Outside the grid the nearest edge value is used.
+class AeroMap {
+public:
+    enum Axis : int { FrontRide, RearRide, Yaw, Steer, kAxes };
+    enum Channel : int { Drag, LiftFront, LiftRear, Side, kChannels };   // coefficients, per q*A
+
+    struct Grid {
+        double        min    = 0.0;
+        double        max    = 1.0;
+        std::uint32_t points = 2;
+    };
+
+    explicit AeroMap(const std::array<Grid, kAxes>& grid) : grid_(grid) {
+        std::size_t n = 1;
+        ok_ = true;
+        for (int a = kAxes - 1; a >= 0; --a) {
+            const Grid& g = grid_[a];
+            ok_ = ok_ && g.points >= 2 && g.max > g.min;
+            stride_[a] = static_cast<std::int32_t>(n);
+            n *= std::max<std::uint32_t>(g.points, 2);
+            step_[a] = (g.max - g.min) / double(std::max<std::uint32_t>(g.points, 2) - 1);
+        }
+        // Float offsets must fit the int32 index math of the kernel.
+        ok_ = ok_ && n * kChannels < (std::size_t(1) << 31);
+        nodes_ = ok_ ? n : 0;
+        lines_.resize((nodes_ * kChannels + 15) / 16);
+    }
+
+    bool valid() const { return ok_; }
+    std::size_t nodes() const { return nodes_; }
+    const Grid& grid(int axis) const { return grid_[axis]; }
+    double breakpoint(int axis, std::uint32_t i) const { return grid_[axis].min + step_[axis] * i; }
+    std::int32_t stride(int axis) const { return stride_[axis]; }   // in nodes
+
+    float& at(std::uint32_t i0, std::uint32_t i1, std::uint32_t i2, std::uint32_t i3, Channel c) {
+        return data()[offset(i0, i1, i2, i3) + c];
+    }
+    float at(std::uint32_t i0, std::uint32_t i1, std::uint32_t i2, std::uint32_t i3, Channel c) const {
+        return data()[offset(i0, i1, i2, i3) + c];
+    }
+    float*       data()       { return lines_.empty() ? nullptr : lines_[0].v; }
+    const float* data() const { return lines_.empty() ? nullptr : lines_[0].v; }
+
+    double step(int axis) const { return step_[axis]; }
+
+    // Cell and fraction along one axis (min, step, points - 1), clamped to
+    // the grid. Static so kernels can pass hoisted copies of the axis.
+    static SIMCORE_SIMD_INLINE void locate(double x, double min, double step, double last,
+                                           std::int32_t& cell, double& t) {
+        const double f = simd::min(simd::max((x - min) / step, 0.0), last);
+        const double c = simd::min(std::floor(f), last - 1.0);
+        cell = static_cast<std::int32_t>(c);
+        t = f - c;
+    }
+
+    // Scalar multilinear lookup; the accuracy baseline for AeroBatch.
+    void lookup(const double x[kAxes], double out[kChannels]) const {
+        std::int32_t cell[kAxes];
+        double t[kAxes];
+        for (int a = 0; a < kAxes; ++a)
+            locate(x[a], grid_[a].min, step_[a], double(grid_[a].points - 1), cell[a], t[a]);
+        for (int c = 0; c < kChannels; ++c) out[c] = 0.0;
+        for (int k = 0; k < (1 << kAxes); ++k) {
+            double w = 1.0;
+            std::size_t node = 0;
+            for (int a = 0; a < kAxes; ++a) {
+                const int bit = (k >> (kAxes - 1 - a)) & 1;
+                w *= bit ? t[a] : 1.0 - t[a];
+                node += std::size_t(cell[a] + bit) * std::size_t(stride_[a]);
+            }
+            for (int c = 0; c < kChannels; ++c) out[c] += w * data()[node * kChannels + c];
+        }
+    }
+
+private:
+    struct alignas(64) Line { float v[16]; };
+
+    std::size_t offset(std::uint32_t i0, std::uint32_t i1, std::uint32_t i2, std::uint32_t i3) const {
+        return (std::size_t(i0) * std::size_t(stride_[0]) + std::size_t(i1) * std::size_t(stride_[1])
+              + std::size_t(i2) * std::size_t(stride_[2]) + i3) * kChannels;
+    }
+
+    std::array<Grid, kAxes> grid_;
+    std::int32_t            stride_[kAxes] = {};
+    double                  step_[kAxes]   = {};
+    std::size_t             nodes_ = 0;
+    bool                    ok_    = false;
+    std::vector<Line>       lines_;
+};
+
+// Batched aero over SoA car columns. The 4D lookup (16 nodes x 4 channels
+// of gathers per car) is the expensive part and changes slowly with ride
+// height and yaw, so with rateDivider = N each car's coefficients are
+// refreshed every N-th frame: cars go in fixed groups, group g on frames
+// where (g + frame) % N == 0, which spreads the lookups evenly over frames.
+// Forces (q * A * coefficient, q = rho v^2 / 2) follow speed every frame.
+// The first frame stepped refreshes every group, so no car waits on zero
+// coefficients for its turn. An invalid map leaves the batch invalid and
+// every output at zero.
+class AeroBatch {
+public:
+    using Channel = AeroMap::Channel;
+    static constexpr int kChannels = AeroMap::kChannels;
+
+    struct Config {
+        double      airDensity  = 1.225;   // kg/m^3
+        double      refArea     = 1.0;     // m^2
+        int         rateDivider = 1;       // coefficients every N frames
+        std::size_t group       = 64;      // cars per stagger group
+    };
+
+    AeroBatch(const AeroMap& map, std::size_t cars, const Config& cfg)
+        : rideFront(cars, 0.0), rideRear(cars, 0.0), yaw(cars, 0.0), steer(cars, 0.0), speed(cars, 0.0),
+          map_(map.valid() ? &map : nullptr), cfg_(cfg) {
+        cfg_.rateDivider = std::max(cfg_.rateDivider, 1);
+        cfg_.group = std::max<std::size_t>(cfg_.group, 1);
+        for (auto& c : coeff) c.assign(cars, 0.0);
+        for (auto& f : force) f.assign(cars, 0.0);
+    }
+    AeroBatch(const AeroMap& map, std::size_t cars) : AeroBatch(map, cars, Config{}) {}
+
+    const Config& config() const { return cfg_; }
+    std::size_t size() const { return speed.size(); }
+    bool valid() const { return map_ != nullptr; }
+
+    // Inputs
+    std::vector<double> rideFront, rideRear;   // m
+    std::vector<double> yaw, steer;            // rad
+    std::vector<double> speed;                 // m/s
+    // Outputs, indexed by AeroMap::Channel
+    std::array<std::vector<double>, kChannels> coeff;
+    std::array<std::vector<double>, kChannels> force;   // N
+
+    // Coefficients and forces for cars [b, e), vectorized.
+    void evaluate(std::size_t b, std::size_t e) {
+        if (!map_) return;
+        interpolate(b, e);
+        forces(b, e);
+    }
+
+    void evaluateReference(std::size_t b, std::size_t e) {
+        if (!map_) return;
+        for (std::size_t i = b; i < e; ++i) {
+            const double x[AeroMap::kAxes] = {rideFront[i], rideRear[i], yaw[i], steer[i]};
+            double c[kChannels];
+            map_->lookup(x, c);
+            for (int k = 0; k < kChannels; ++k) coeff[k][i] = c[k];
+        }
+        forces(b, e);
+    }
+
+    // Whether car i's coefficients are refreshed on `frame`.
+    bool due(std::size_t i, std::int64_t frame) const {
+        const auto n = static_cast<std::int64_t>(cfg_.rateDivider);
+        return (static_cast<std::int64_t>(i / cfg_.group) + frame) % n == 0;
+    }
+
+    // One frame's work for cars [b, e): the due groups' lookups, all forces.
+    void step(std::size_t b, std::size_t e, std::int64_t frame) {
+        if (cfg_.rateDivider == 1 || priming(frame)) { evaluate(b, e); return; }
+        for (std::size_t g = b; g < e;) {
+            const std::size_t end = std::min(e, (g / cfg_.group + 1) * cfg_.group);
+            if (due(g, frame)) interpolate(g, end);
+            g = end;
+        }
+        forces(b, e);
+    }
+
+    // One range task over all cars in `phase`; inputs are expected to be
+    // written by an earlier phase (or serial subsystem) of the same frame.
+    void install(SimCore& sim, std::size_t phase) {
+        sim.setPhaseElementCount(phase, size());
+        sim.addParallelRangeTask(phase, [this](std::size_t b, std::size_t e,
+                                               std::int64_t frame, SimCore::Seconds){
+            step(b, e, frame);
+        });
+    }
+
+private:
+    static constexpr std::int64_t kUnprimed = std::numeric_limits<std::int64_t>::min();
+
+    struct Coeffs { double c0, c1, c2, c3; };
+
+    // True on the first frame step() sees, for every range of that frame
+    // whichever worker claims it; after that a plain shared load.
+    bool priming(std::int64_t frame) {
+        std::int64_t first = firstFrame_.load(std::memory_order_relaxed);
+        if (first == kUnprimed &&
+            firstFrame_.compare_exchange_strong(first, frame, std::memory_order_relaxed)) return true;
+        return first == frame;
+    }
+
+    static SIMCORE_SIMD_INLINE Coeffs lerp(const Coeffs& a, const Coeffs& b, double t) {
+        return {a.c0 + (b.c0 - a.c0) * t, a.c1 + (b.c1 - a.c1) * t,
+                a.c2 + (b.c2 - a.c2) * t, a.c3 + (b.c3 - a.c3) * t};
+    }
+
+    // Both steer neighbours of a node (adjacent in memory), blended. Plain
+    // fields rather than arrays, so nothing is left in memory for the
+    // vectorizer to trip on.
+    static SIMCORE_SIMD_INLINE Coeffs blend(const float* T, std::int32_t o, double t) {
+        const Coeffs a{T[o], T[o + 1], T[o + 2], T[o + 3]};
+        const Coeffs b{T[o + 4], T[o + 5], T[o + 6], T[o + 7]};
+        return lerp(a, b, t);
+    }
+
+    // Multilinear as a lerp tree: steer, yaw, rear, front. The index math
+    // stays in int32 (no double -> int64 conversion in AVX2).
+    void interpolate(std::size_t b, std::size_t e) {
+        static_assert(kChannels == 4, "blend() is written out for four channels");
+        const AeroMap& m = *map_;
+        const float* T = m.data();
+        const std::int32_t s0 = m.stride(0) * kChannels, s1 = m.stride(1) * kChannels;
+        const std::int32_t s2 = m.stride(2) * kChannels;
+        double lo[AeroMap::kAxes], step[AeroMap::kAxes], last[AeroMap::kAxes];
+        for (int a = 0; a < AeroMap::kAxes; ++a) {
+            lo[a] = m.grid(a).min; step[a] = m.step(a); last[a] = double(m.grid(a).points - 1);
+        }
+        const double* rf = rideFront.data();
+        const double* rr = rideRear.data();
+        const double* yw = yaw.data();
+        const double* st = steer.data();
+        double* c0 = coeff[0].data();
+        double* c1 = coeff[1].data();
+        double* c2 = coeff[2].data();
+        double* c3 = coeff[3].data();
+        SIMCORE_SIMD_LOOP
+        for (std::size_t i = b; i < e; ++i) {
+            std::int32_t i0, i1, i2, i3;
+            double t0, t1, t2, t3;
+            AeroMap::locate(rf[i], lo[0], step[0], last[0], i0, t0);
+            AeroMap::locate(rr[i], lo[1], step[1], last[1], i1, t1);
+            AeroMap::locate(yw[i], lo[2], step[2], last[2], i2, t2);
+            AeroMap::locate(st[i], lo[3], step[3], last[3], i3, t3);
+            const std::int32_t o = i0 * s0 + i1 * s1 + i2 * s2 + i3 * kChannels;
+            const Coeffs f0 = lerp(lerp(blend(T, o,           t3), blend(T, o + s2,           t3), t2),
+                                   lerp(blend(T, o + s1,      t3), blend(T, o + s1 + s2,      t3), t2), t1);
+            const Coeffs f1 = lerp(lerp(blend(T, o + s0,      t3), blend(T, o + s0 + s2,      t3), t2),
+                                   lerp(blend(T, o + s0 + s1, t3), blend(T, o + s0 + s1 + s2, t3), t2), t1);
+            const Coeffs r = lerp(f0, f1, t0);
+            c0[i] = r.c0; c1[i] = r.c1; c2[i] = r.c2; c3[i] = r.c3;
+        }
+    }
+
+    void forces(std::size_t b, std::size_t e) {
+        const double qa = 0.5 * cfg_.airDensity * cfg_.refArea;
+        const double* v = speed.data();
+        for (int k = 0; k < kChannels; ++k) {
+            const double* c = coeff[k].data();
+            double* f = force[k].data();
+            SIMCORE_SIMD_LOOP
+            for (std::size_t i = b; i < e; ++i) f[i] = qa * v[i] * v[i] * c[i];
+        }
+    }
+
+    const AeroMap*            map_;
+    Config                    cfg_;
+    std::atomic<std::int64_t> firstFrame_{kUnprimed};
+};
@@ -0,0 +1,448 @@
+#pragma once
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define ASYNC_IO_POSIX 1
+#endif
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#define ASYNC_IO_URING 1
+#endif
+
+// Shared asynchronous file output. Callers (logger file sinks, profiler
+// dumps, telemetry, trace capture) copy bytes into a pool of fixed buffers and
+// return; one submission thread writes full buffers, and partial ones every
+// flushIntervalMs, via io_uring (raw syscalls, buffers registered with the
+// ring) or pwritev when io_uring is unavailable. No caller thread ever
+// issues a write syscall.
+//
+// write() never blocks: a record that does not fit the free pool is
+// dropped whole and counted, so a stream never holds half a record. Length-
+// framed producers that have their own writer thread use writeWait(),
+// which waits for buffers instead. open() and close() are file syscalls
+// (close() also waits for the file's data to be written): call them from
+// setup code or a writer thread, never from the sim thread.
+class AsyncIO {
+public:
+    using FileId = int;
+
+    struct Config {
+        std::size_t bufferSize      = 64u << 10;
+        std::size_t bufferCount     = 64;
+        unsigned    queueDepth      = 64;
+        int         flushIntervalMs = 20;
+        bool        useUring        = true;
+    };
+
+    AsyncIO() : AsyncIO(Config{}) {}
+    explicit AsyncIO(const Config& c) : cfg_(c) {
+        if (cfg_.bufferSize == 0) cfg_.bufferSize = 4096;
+        if (cfg_.bufferCount < 2) cfg_.bufferCount = 2;
+        if (cfg_.queueDepth == 0) cfg_.queueDepth = 1;
+        pool_.reset(new unsigned char[cfg_.bufferSize * cfg_.bufferCount]);
+        for (std::size_t i = cfg_.bufferCount; i-- > 0;) free_.push_back(static_cast<std::uint32_t>(i));
+#ifdef ASYNC_IO_URING
+        if (cfg_.useUring) setupRing();
+#endif
+        thread_ = std::thread([this]{ ioLoop(); });
+    }
+    ~AsyncIO() {
+        flush();
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+#ifdef ASYNC_IO_POSIX
+        for (auto& f : files_) if (f.fd >= 0) ::close(f.fd);
+#endif
+#ifdef ASYNC_IO_URING
+        teardownRing();
+#endif
+    }
+    AsyncIO(const AsyncIO&) = delete;
+    AsyncIO& operator=(const AsyncIO&) = delete;
+
+    // Process-wide instance (default Config), created on first use. Users
+    // that hold the pointer keep it alive past static destruction, so a
+    // static logger's file sink can still close its file at exit.
+    static std::shared_ptr<AsyncIO> shared() {
+        static std::shared_ptr<AsyncIO> io = std::make_shared<AsyncIO>();
+        return io;
+    }
+
+    // Open for appending (or truncate). -1 on failure.
+    FileId open(const std::string& path, bool truncate = false) {
+#ifdef ASYNC_IO_POSIX
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | (truncate ? O_TRUNC : 0), 0644);
+        if (fd < 0) return -1;
+        off_t end = ::lseek(fd, 0, SEEK_END);
+        std::lock_guard<std::mutex> lk(m_);
+        FileState fs;
+        fs.fd = fd;
+        fs.offset = end > 0 ? static_cast<std::uint64_t>(end) : 0;
+        files_.push_back(fs);
+        return static_cast<FileId>(files_.size() - 1);
+#else
+        (void)path; (void)truncate;
+        return -1;
+#endif
+    }
+
+    // Any thread, never blocks. Copies all n bytes into the pool, or none
+    // (false, counted as dropped) if the free buffers cannot hold them.
+    bool write(FileId id, const void* data, std::size_t n) {
+        bool notify = false;
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (!isOpen(id)) return false;
+            auto& fs = files_[id];
+            const std::size_t room = (fs.cur >= 0 ? cfg_.bufferSize - fs.fill : 0) + free_.size() * cfg_.bufferSize;
+            if (n > room) { dropped_ += n; return false; }
+            notify = stage(id, static_cast<const unsigned char*>(data), n);
+        }
+        if (notify) cv_.notify_one();
+        return true;
+    }
+    bool write(FileId id, std::string_view s) { return write(id, s.data(), s.size()); }
+
+    // Like write(), but waits for free buffers instead of dropping. Only
+    // for threads that may block (a producer's own writer thread); false
+    // if the file is closed or fails meanwhile.
+    bool writeWait(FileId id, const void* data, std::size_t n) {
+        auto* src = static_cast<const unsigned char*>(data);
+        std::unique_lock<std::mutex> lk(m_);
+        while (n > 0) {
+            if (!isOpen(id) || files_[id].errors) return false;
+            auto& fs = files_[id];
+            if (fs.cur < 0 && free_.empty()) {
+                ++waiters_;                       // IO thread: hand partial buffers out now
+                cv_.notify_one();
+                freeCv_.wait(lk, [&]{ return !free_.empty() || stop_ || !isOpen(id); });
+                --waiters_;
+                if (stop_) return false;
+                continue;
+            }
+            const std::size_t room = (fs.cur >= 0 ? cfg_.bufferSize - fs.fill : 0) + free_.size() * cfg_.bufferSize;
+            const std::size_t take = std::min(n, room);
+            if (stage(id, src, take)) cv_.notify_one();
+            src += take;
+            n -= take;
+        }
+        return true;
+    }
+    bool writeWait(FileId id, std::string_view s) { return writeWait(id, s.data(), s.size()); }
+
+    // Block until everything written so far has reached the kernel.
+    void flush() {
+        std::unique_lock<std::mutex> lk(m_);
+        std::uint64_t gen = ++flushReq_;
+        cv_.notify_one();
+        idleCv_.wait(lk, [&]{ return flushDone_ >= gen; });
+    }
+
+    // Flushes, then closes. True if every byte accepted for this file was
+    // written without error.
+    bool close(FileId id) {
+        flush();
+        std::lock_guard<std::mutex> lk(m_);
+        if (id < 0 || static_cast<std::size_t>(id) >= files_.size()) return false;
+#ifdef ASYNC_IO_POSIX
+        if (files_[id].fd >= 0 && ::close(files_[id].fd) != 0) ++files_[id].errors;
+#endif
+        files_[id].fd = -1;
+        freeCv_.notify_all();
+        return files_[id].errors == 0;
+    }
+
+    bool usingUring() const { return ringFd_ >= 0; }
+    bool registeredBuffers() const { return fixed_; }
+    std::uint64_t bytesWritten() const { std::lock_guard<std::mutex> lk(m_); return written_; }
+    std::uint64_t droppedBytes() const { std::lock_guard<std::mutex> lk(m_); return dropped_; }
+    std::uint64_t writeErrors() const { std::lock_guard<std::mutex> lk(m_); return errors_; }
+
+private:
+    struct FileState {
+        int           fd     = -1;
+        std::uint64_t offset = 0;     // next write offset, assigned at submission
+        std::int32_t  cur    = -1;    // buffer being filled
+        std::size_t   fill   = 0;
+        std::uint64_t errors = 0;     // failed writes
+    };
+    struct Job {
+        FileId        file;
+        std::uint32_t buf;
+        std::size_t   len;
+        std::uint64_t off;
+        int           fd = -1;
+        bool          failed = false;
+    };
+
+    unsigned char* buffer(std::uint32_t i) const { return pool_.get() + std::size_t(i) * cfg_.bufferSize; }
+
+    bool isOpen(FileId id) const {
+        return id >= 0 && static_cast<std::size_t>(id) < files_.size() && files_[id].fd >= 0;
+    }
+
+    // Copy into the file's current and then free buffers, queueing the full
+    // ones; the caller checked there is room. m_ held. True if a buffer was
+    // queued.
+    bool stage(FileId id, const unsigned char* src, std::size_t n) {
+        auto& fs = files_[id];
+        bool queued = false;
+        while (n > 0) {
+            if (fs.cur < 0) {
+                fs.cur = static_cast<std::int32_t>(free_.back());
+                free_.pop_back();
+                fs.fill = 0;
+            }
+            std::size_t take = std::min(n, cfg_.bufferSize - fs.fill);
+            std::memcpy(buffer(std::uint32_t(fs.cur)) + fs.fill, src, take);
+            fs.fill += take;
+            src += take;
+            n -= take;
+            if (fs.fill == cfg_.bufferSize) {
+                pending_.push_back(Job{id, std::uint32_t(fs.cur), fs.fill, 0});
+                fs.cur = -1;
+                queued = true;
+            }
+        }
+        return queued;
+    }
+
+    void ioLoop() {
+        std::vector<Job> batch;
+        std::unique_lock<std::mutex> lk(m_);
+        for (;;) {
+            bool timedOut = !cv_.wait_for(lk, std::chrono::milliseconds(std::max(1, cfg_.flushIntervalMs)),
+                                          [this]{ return stop_ || !pending_.empty() || flushReq_ > flushDone_ ||
+                                                         (waiters_ > 0 && free_.empty()); });
+            std::uint64_t req = flushReq_;
+            if (timedOut || req > flushDone_ || stop_ || waiters_ > 0) {
+                for (std::size_t i = 0; i < files_.size(); ++i) {
+                    auto& fs = files_[i];
+                    if (fs.cur >= 0 && fs.fill > 0) {
+                        pending_.push_back(Job{FileId(i), std::uint32_t(fs.cur), fs.fill, 0});
+                        fs.cur = -1;
+                    }
+                }
+            }
+            batch.assign(pending_.begin(), pending_.end());
+            pending_.clear();
+            for (auto& j : batch) {
+                j.fd  = files_[j.file].fd;
+                j.off = files_[j.file].offset;
+                files_[j.file].offset += j.len;
+            }
+            lk.unlock();
+
+            std::uint64_t ok = 0, bad = 0;
+            if (!batch.empty()) submit(batch, ok, bad);
+
+            lk.lock();
+            for (auto& j : batch) {
+                free_.push_back(j.buf);
+                if (j.failed) ++files_[j.file].errors;
+            }
+            if (!batch.empty()) freeCv_.notify_all();
+            written_ += ok;
+            errors_  += bad;
+            // Everything staged before flush request `req` was in this batch.
+            if (req > flushDone_) {
+                flushDone_ = req;
+                idleCv_.notify_all();
+            }
+            if (stop_ && pending_.empty()) { freeCv_.notify_all(); return; }
+        }
+    }
+
+    void submit(std::vector<Job>& batch, std::uint64_t& ok, std::uint64_t& bad) {
+#ifdef ASYNC_IO_URING
+        if (ringFd_ >= 0) { submitRing(batch, ok, bad); return; }
+#endif
+        for (auto& j : batch) writeAll(j, 0, ok, bad);
+    }
+
+    // Blocking pwrite of [done, len) on the IO thread: fallback path and
+    // short-write completion for the ring.
+    void writeAll(Job& j, std::size_t done, std::uint64_t& ok, std::uint64_t& bad) {
+#ifdef ASYNC_IO_POSIX
+        while (done < j.len) {
+            iovec iov{buffer(j.buf) + done, j.len - done};
+            ssize_t r = ::pwritev(j.fd, &iov, 1, static_cast<off_t>(j.off + done));
+            if (r < 0 && errno == EINTR) continue;
+            if (r <= 0) { bad += j.len - done; j.failed = true; return; }
+            done += static_cast<std::size_t>(r);
+        }
+        ok += j.len;
+#else
+        (void)done; (void)ok; bad += j.len; j.failed = true;
+#endif
+    }
+
+#ifdef ASYNC_IO_URING
+    void setupRing() {
+        io_uring_params p{};
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, cfg_.queueDepth, &p));
+        if (fd < 0) return;
+        sqBytes_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqBytes_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sqBytes_ = cqBytes_ = std::max(sqBytes_, cqBytes_);
+        sqMap_ = ::mmap(nullptr, sqBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cqMap_ = single ? sqMap_
+                        : ::mmap(nullptr, cqBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        sqesBytes_ = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqesBytes_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqMap_ == MAP_FAILED || cqMap_ == MAP_FAILED || sqes == MAP_FAILED) {
+            if (sqes != MAP_FAILED) ::munmap(sqes, sqesBytes_);
+            if (cqMap_ != MAP_FAILED && cqMap_ != sqMap_) ::munmap(cqMap_, cqBytes_);
+            if (sqMap_ != MAP_FAILED) ::munmap(sqMap_, sqBytes_);
+            sqMap_ = cqMap_ = nullptr;
+            ::close(fd);
+            return;
+        }
+        auto* sq = static_cast<unsigned char*>(sqMap_);
+        auto* cq = static_cast<unsigned char*>(cqMap_);
+        sqTail_  = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sqMask_  = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sqArray_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        cqHead_  = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cqTail_  = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cqMask_  = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_    = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        sqes_    = static_cast<io_uring_sqe*>(sqes);
+        sqEntries_ = p.sq_entries;
+        ringFd_  = fd;
+
+        // Registered buffers spare the kernel a page pin per write; the ring
+        // still works unregistered (e.g. RLIMIT_MEMLOCK too low).
+        std::vector<iovec> iovs(cfg_.bufferCount);
+        for (std::size_t i = 0; i < iovs.size(); ++i) iovs[i] = iovec{buffer(std::uint32_t(i)), cfg_.bufferSize};
+        fixed_ = ::syscall(__NR_io_uring_register, ringFd_, IORING_REGISTER_BUFFERS,
+                           iovs.data(), static_cast<unsigned>(iovs.size())) == 0;
+    }
+
+    void teardownRing() {
+        if (ringFd_ < 0) return;
+        ::munmap(sqes_, sqesBytes_);
+        if (cqMap_ != sqMap_) ::munmap(cqMap_, cqBytes_);
+        ::munmap(sqMap_, sqBytes_);
+        ::close(ringFd_);
+        ringFd_ = -1;
+    }
+
+    // Submit in ring-sized waves and wait for each wave to complete. If
+    // io_uring_enter keeps failing, the ring is retired and whatever has not
+    // completed is written with pwritev (same bytes, same offsets).
+    void submitRing(std::vector<Job>& batch, std::uint64_t& ok, std::uint64_t& bad) {
+        std::vector<char> completed;
+        for (std::size_t first = 0; first < batch.size();) {
+            const std::size_t n = std::min<std::size_t>(sqEntries_, batch.size() - first);
+            unsigned tail = *sqTail_;
+            for (std::size_t k = 0; k < n; ++k) {
+                const Job& j = batch[first + k];
+                unsigned idx = (tail + unsigned(k)) & sqMask_;
+                io_uring_sqe& sqe = sqes_[idx];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode    = static_cast<std::uint8_t>(fixed_ ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE);
+                sqe.fd        = j.fd;
+                sqe.addr      = reinterpret_cast<std::uint64_t>(buffer(j.buf));
+                sqe.len       = static_cast<std::uint32_t>(j.len);
+                sqe.off       = j.off;
+                sqe.buf_index = static_cast<std::uint16_t>(fixed_ ? j.buf : 0);
+                sqe.user_data = first + k;
+                sqArray_[idx] = idx;
+            }
+            __atomic_store_n(sqTail_, tail + unsigned(n), __ATOMIC_RELEASE);
+
+            completed.assign(n, 0);
+            unsigned left = unsigned(n), toSubmit = unsigned(n);
+            int failures = 0;
+            while (left > 0) {
+                long r = ::syscall(__NR_io_uring_enter, ringFd_, toSubmit, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (r < 0) {
+                    if (errno == EINTR) continue;
+                    // EAGAIN / EBUSY are transient; anything else, or a run
+                    // of them, retires the ring for good.
+                    const bool transient = errno == EAGAIN || errno == EBUSY;
+                    if (!transient || ++failures > 100) {
+                        teardownRing();
+                        for (std::size_t k = 0; k < n; ++k)
+                            if (!completed[k]) writeAll(batch[first + k], 0, ok, bad);
+                        for (std::size_t i = first + n; i < batch.size(); ++i) writeAll(batch[i], 0, ok, bad);
+                        return;
+                    }
+                    std::this_thread::yield();
+                    continue;
+                }
+                failures = 0;
+                if (r > 0) toSubmit -= std::min<unsigned>(toSubmit, unsigned(r));
+                unsigned head = *cqHead_;
+                unsigned ctail = __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE);
+                for (; head != ctail; ++head, --left) {
+                    const io_uring_cqe& c = cqes_[head & cqMask_];
+                    const auto k = static_cast<std::size_t>(c.user_data);
+                    Job& j = batch[k];
+                    std::size_t done = c.res > 0 ? static_cast<std::size_t>(c.res) : 0;
+                    if (done >= j.len) ok += j.len;
+                    else writeAll(j, done, ok, bad);
+                    completed[k - first] = 1;
+                }
+                __atomic_store_n(cqHead_, head, __ATOMIC_RELEASE);
+            }
+            first += n;
+        }
+    }
+
+    void*         sqMap_ = nullptr;
+    void*         cqMap_ = nullptr;
+    std::size_t   sqBytes_ = 0, cqBytes_ = 0, sqesBytes_ = 0;
+    unsigned*     sqTail_  = nullptr;
+    unsigned*     sqArray_ = nullptr;
+    unsigned      sqMask_  = 0;
+    unsigned      sqEntries_ = 0;
+    unsigned*     cqHead_  = nullptr;
+    unsigned*     cqTail_  = nullptr;
+    unsigned      cqMask_  = 0;
+    io_uring_sqe* sqes_    = nullptr;
+    io_uring_cqe* cqes_    = nullptr;
+#endif
+
+    Config                           cfg_;
+    std::unique_ptr<unsigned char[]> pool_;
+    int                              ringFd_ = -1;
+    bool                             fixed_  = false;
+
+    mutable std::mutex               m_;
+    std::condition_variable          cv_, idleCv_, freeCv_;
+    std::vector<FileState>           files_;
+    std::vector<std::uint32_t>       free_;
+    std::deque<Job>                  pending_;
+    std::uint64_t                    flushReq_  = 0;
+    std::uint64_t                    flushDone_ = 0;
+    std::size_t                      waiters_   = 0;   // writeWait() callers out of buffers
+    bool                             stop_      = false;
+    std::uint64_t                    written_   = 0;
+    std::uint64_t                    dropped_   = 0;
+    std::uint64_t                    errors_    = 0;
+    std::thread                      thread_;
+};
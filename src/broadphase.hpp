@@ -0,0 +1,261 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include "SimCore.hpp"
+
+// Broad phase over axis-aligned boxes with a uniform spatial hash, built
+// every frame as waves of one SimCore phase. Each body lives in the cell
+// of its box centre; with cellSize >= the largest box extent, overlapping
+// boxes are in the same or adjacent cells, so each cell only looks at
+// itself and its 13 "forward" neighbours.
+//
+// Per frame:
+//   keys     cell coordinates, hashed key (log2(2n) bits), digit histogram
+//   sort     LSD radix sort of (key, body) by 8-bit digits: per-block
+//            histograms, prefix by the last block to finish, stable scatter
+//   cells    start index of each key run in a direct-mapped table
+//   pairs    overlap tests, emitted into per-block buffers
+//   merge    concatenate the block buffers in block order
+// All work is partitioned into fixed blocks of the body array, independent
+// of the thread count, so the pair list and its order are deterministic.
+// Hash collisions only merge runs; candidates are matched on exact cell
+// coordinates, so no pair is reported twice.
+class BroadPhase {
+public:
+    struct Pair {
+        std::uint32_t a, b;    // body indices, a < b
+        bool operator==(const Pair& o) const { return a == o.a && b == o.b; }
+    };
+
+    struct Config {
+        double      cellSize  = 0.0;    // <= 0: largest box extent, per frame
+        std::size_t blockSize = 1024;   // bodies per work item
+    };
+
+    BroadPhase(std::size_t bodies, const Config& cfg)
+        : minX(bodies), minY(bodies), minZ(bodies), maxX(bodies), maxY(bodies), maxZ(bodies),
+          cfg_(cfg), n_(bodies) {
+        cfg_.blockSize = std::max<std::size_t>(1, cfg_.blockSize);
+        blocks_ = std::max<std::size_t>(1, (n_ + cfg_.blockSize - 1) / cfg_.blockSize);
+        unsigned bits = 1;
+        while ((std::size_t(1) << bits) < 2 * std::max<std::size_t>(n_, 1)) ++bits;
+        bits = std::max(bits, 8u);
+        mask_   = bits >= 32 ? 0xFFFFFFFFu : ((1u << bits) - 1u);
+        passes_ = (bits + kDigitBits - 1) / kDigitBits;
+        keys_[0].resize(n_); keys_[1].resize(n_);
+        ids_[0].resize(n_);  ids_[1].resize(n_);
+        cx_.resize(n_); cy_.resize(n_); cz_.resize(n_);
+        sx_.resize(n_); sy_.resize(n_); sz_.resize(n_);
+        table_.resize(std::size_t(mask_) + 1);
+        hist_.resize(blocks_ * kBuckets);
+        buffers_.resize(blocks_);
+        pending_ = std::make_unique<std::atomic<std::size_t>[]>(passes_);
+    }
+    explicit BroadPhase(std::size_t bodies) : BroadPhase(bodies, Config{}) {}
+
+    // Box inputs, written before the broad-phase phase runs.
+    std::vector<double> minX, minY, minZ, maxX, maxY, maxZ;
+
+    void setBox(std::size_t i, double x, double y, double z, double hx, double hy, double hz) {
+        minX[i] = x - hx; minY[i] = y - hy; minZ[i] = z - hz;
+        maxX[i] = x + hx; maxY[i] = y + hy; maxZ[i] = z + hz;
+    }
+
+    std::size_t size() const { return n_; }
+    std::size_t blocks() const { return blocks_; }
+    unsigned passes() const { return passes_; }
+    double cellSize() const { return cell_; }
+    const std::vector<Pair>& pairs() const { return pairs_; }
+
+    // Registers the broad phase as one phase of waves; returns its index.
+    std::size_t install(SimCore& sim, const std::string& name = "BroadPhase") {
+        const std::size_t ph = sim.addPhase(name, blocks_);
+        sim.setPhaseChunkSize(ph, 1);
+        sim.addSerialSubsystem(ph, [this](std::int64_t, SimCore::Seconds){ begin(); });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) keysAndHistogram(k);
+        });
+        for (unsigned p = 0; p < passes_; ++p) {
+            if (p > 0)
+                sim.addParallelRangeTask(ph, [this, p](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+                    for (std::size_t k = b; k < e; ++k) histogram(k, p);
+                });
+            sim.addParallelRangeTask(ph, [this, p](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+                for (std::size_t k = b; k < e; ++k) scatter(k, p);
+            });
+        }
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) cellStarts(k);
+        });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) emitPairs(k);
+        });
+        sim.addReductionTask(ph, [this](std::int64_t, SimCore::Seconds){ merge(); });
+        return ph;
+    }
+
+    // The same waves run inline, for use outside SimCore and in tests.
+    void update() {
+        begin();
+        for (std::size_t k = 0; k < blocks_; ++k) keysAndHistogram(k);
+        for (unsigned p = 0; p < passes_; ++p) {
+            if (p > 0) for (std::size_t k = 0; k < blocks_; ++k) histogram(k, p);
+            for (std::size_t k = 0; k < blocks_; ++k) scatter(k, p);
+        }
+        for (std::size_t k = 0; k < blocks_; ++k) cellStarts(k);
+        for (std::size_t k = 0; k < blocks_; ++k) emitPairs(k);
+        merge();
+    }
+
+private:
+    static constexpr unsigned      kDigitBits = 8;
+    static constexpr std::size_t   kBuckets   = std::size_t(1) << kDigitBits;
+    static constexpr std::uint32_t kEmpty     = 0xFFFFFFFFu;
+
+    std::size_t blockBegin(std::size_t k) const { return k * cfg_.blockSize; }
+    std::size_t blockEnd(std::size_t k) const { return std::min(n_, (k + 1) * cfg_.blockSize); }
+
+    std::uint32_t hashCell(std::int32_t x, std::int32_t y, std::int32_t z) const {
+        const std::uint32_t h = (std::uint32_t(x) * 73856093u) ^ (std::uint32_t(y) * 19349663u)
+                              ^ (std::uint32_t(z) * 83492791u);
+        return (h ^ (h >> 16)) & mask_;
+    }
+
+    void begin() {
+        double cell = cfg_.cellSize;
+        if (cell <= 0.0) {
+            cell = 0.0;
+            for (std::size_t i = 0; i < n_; ++i)
+                cell = std::max({cell, maxX[i] - minX[i], maxY[i] - minY[i], maxZ[i] - minZ[i]});
+        }
+        cell_ = cell > 0.0 ? cell : 1.0;
+        for (unsigned p = 0; p < passes_; ++p) pending_[p].store(blocks_, std::memory_order_relaxed);
+    }
+
+    void keysAndHistogram(std::size_t k) {
+        const double inv = 1.0 / cell_;
+        for (std::size_t i = blockBegin(k); i < blockEnd(k); ++i) {
+            cx_[i] = static_cast<std::int32_t>(std::floor(0.5 * (minX[i] + maxX[i]) * inv));
+            cy_[i] = static_cast<std::int32_t>(std::floor(0.5 * (minY[i] + maxY[i]) * inv));
+            cz_[i] = static_cast<std::int32_t>(std::floor(0.5 * (minZ[i] + maxZ[i]) * inv));
+            keys_[0][i] = hashCell(cx_[i], cy_[i], cz_[i]);
+            ids_[0][i]  = static_cast<std::uint32_t>(i);
+        }
+        // This block's slice of the cell table; filled after the sort.
+        const std::size_t t = table_.size();
+        std::fill(table_.begin() + std::ptrdiff_t(k * t / blocks_),
+                  table_.begin() + std::ptrdiff_t((k + 1) * t / blocks_), kEmpty);
+        histogram(k, 0);
+    }
+
+    void histogram(std::size_t k, unsigned p) {
+        std::uint32_t* h = &hist_[k * kBuckets];
+        std::fill(h, h + kBuckets, 0u);
+        const std::uint32_t* key = keys_[p & 1].data();
+        const unsigned shift = p * kDigitBits;
+        for (std::size_t i = blockBegin(k); i < blockEnd(k); ++i) ++h[(key[i] >> shift) & (kBuckets - 1)];
+        // The last block to finish turns counts into scatter offsets
+        // (digit-major, block-minor: a stable sort).
+        if (pending_[p].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::uint32_t run = 0;
+            for (std::size_t d = 0; d < kBuckets; ++d)
+                for (std::size_t b = 0; b < blocks_; ++b) {
+                    const std::uint32_t c = hist_[b * kBuckets + d];
+                    hist_[b * kBuckets + d] = run;
+                    run += c;
+                }
+        }
+    }
+
+    void scatter(std::size_t k, unsigned p) {
+        std::uint32_t off[kBuckets];
+        std::copy_n(&hist_[k * kBuckets], kBuckets, off);
+        const std::uint32_t* key = keys_[p & 1].data();
+        const std::uint32_t* id  = ids_[p & 1].data();
+        std::uint32_t* okey = keys_[(p + 1) & 1].data();
+        std::uint32_t* oid  = ids_[(p + 1) & 1].data();
+        const unsigned shift = p * kDigitBits;
+        for (std::size_t i = blockBegin(k); i < blockEnd(k); ++i) {
+            const std::uint32_t o = off[(key[i] >> shift) & (kBuckets - 1)]++;
+            okey[o] = key[i];
+            oid[o]  = id[i];
+        }
+    }
+
+    const std::vector<std::uint32_t>& sortedKeys() const { return keys_[passes_ & 1]; }
+    const std::vector<std::uint32_t>& sortedIds() const { return ids_[passes_ & 1]; }
+
+    // Also gathers cell coordinates into sorted order, so the pair scan
+    // below reads them sequentially instead of through body indices.
+    void cellStarts(std::size_t k) {
+        const auto& key = sortedKeys();
+        const auto& id  = sortedIds();
+        for (std::size_t i = blockBegin(k); i < blockEnd(k); ++i) {
+            if (i == 0 || key[i] != key[i - 1]) table_[key[i]] = static_cast<std::uint32_t>(i);
+            sx_[i] = cx_[id[i]]; sy_[i] = cy_[id[i]]; sz_[i] = cz_[id[i]];
+        }
+    }
+
+    bool overlap(std::uint32_t a, std::uint32_t b) const {
+        return minX[a] <= maxX[b] && minX[b] <= maxX[a] &&
+               minY[a] <= maxY[b] && minY[b] <= maxY[a] &&
+               minZ[a] <= maxZ[b] && minZ[b] <= maxZ[a];
+    }
+
+    void emitPairs(std::size_t k) {
+        // The 13 neighbours with (dx, dy, dz) lexicographically after (0, 0, 0).
+        static constexpr std::int32_t kFwd[13][3] = {
+            {0,0,1}, {0,1,-1}, {0,1,0}, {0,1,1},
+            {1,-1,-1}, {1,-1,0}, {1,-1,1}, {1,0,-1}, {1,0,0}, {1,0,1}, {1,1,-1}, {1,1,0}, {1,1,1}};
+        auto& out = buffers_[k];
+        out.clear();
+        const auto& key = sortedKeys();
+        const auto& id  = sortedIds();
+        auto emit = [&](std::uint32_t a, std::uint32_t b) {
+            if (overlap(a, b)) out.push_back(a < b ? Pair{a, b} : Pair{b, a});
+        };
+        for (std::size_t i = blockBegin(k); i < blockEnd(k); ++i) {
+            const std::uint32_t a = id[i];
+            const std::int32_t x = sx_[i], y = sy_[i], z = sz_[i];
+            for (std::size_t j = i + 1; j < n_ && key[j] == key[i]; ++j)
+                if (sx_[j] == x && sy_[j] == y && sz_[j] == z) emit(a, id[j]);
+            for (const auto& d : kFwd) {
+                const std::int32_t nx = x + d[0], ny = y + d[1], nz = z + d[2];
+                const std::uint32_t nk = hashCell(nx, ny, nz);
+                std::uint32_t s = table_[nk];
+                if (s == kEmpty) continue;
+                for (std::size_t j = s; j < n_ && key[j] == nk; ++j)
+                    if (sx_[j] == nx && sy_[j] == ny && sz_[j] == nz) emit(a, id[j]);
+            }
+        }
+    }
+
+    void merge() {
+        std::size_t total = 0;
+        for (const auto& b : buffers_) total += b.size();
+        pairs_.resize(total);
+        auto it = pairs_.begin();
+        for (const auto& b : buffers_) it = std::copy(b.begin(), b.end(), it);
+    }
+
+    Config        cfg_;
+    std::size_t   n_       = 0;
+    std::size_t   blocks_  = 1;
+    std::uint32_t mask_    = 0;
+    unsigned      passes_  = 1;
+    double        cell_    = 1.0;
+
+    std::vector<std::uint32_t> keys_[2], ids_[2];
+    std::vector<std::int32_t>  cx_, cy_, cz_;   // cell of each body
+    std::vector<std::int32_t>  sx_, sy_, sz_;   // same, in sorted order
+    std::vector<std::uint32_t> table_;
+    std::vector<std::uint32_t> hist_;
+    std::unique_ptr<std::atomic<std::size_t>[]> pending_;
+    std::vector<std::vector<Pair>> buffers_;   // per block, reused every frame
+    std::vector<Pair>          pairs_;
+};
@@ -0,0 +1,435 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "SimCore.hpp"
+#include "narrowphase.hpp"
+#include "rigid_body.hpp"
+
+// Sequential-impulse velocity solver for contacts and distance joints,
+// parallelized by graph coloring. Constraints are greedily colored so that
+// no two in a color share a dynamic body; a color is then a set of
+// independent Gauss-Seidel updates that can run on any number of threads.
+//
+// Per frame, as waves of one SimCore phase:
+//   begin    gather joints and contact manifolds (consecutive contacts of
+//            one pair), color them, sort color-major (serial)
+//   load     body velocities and inverse inertia into world frame
+//   prepare  Jacobians, effective masses and bias per row
+//   solve    iterations x colors waves; the barrier between waves orders
+//            the colors
+//   store    velocities back into the body columns
+// Coloring and ordering depend only on the constraint list, so the result
+// is bitwise identical for any thread count. Constraints that do not fit in
+// maxColors - 1 colors go into a last, overflow color solved serially.
+//
+// Run it between force accumulation and the integrator; it changes
+// velocities only.
+class ConstraintSolver {
+public:
+    static constexpr std::uint32_t kWorld = NarrowPhase::kGround;
+
+    // Soft distance constraint between two anchor points (body frame; for
+    // b == kWorld anchorB is a world point). frequency <= 0 makes it rigid.
+    struct Joint {
+        std::uint32_t a = 0, b = kWorld;
+        double anchorA[3] = {0.0, 0.0, 0.0};
+        double anchorB[3] = {0.0, 0.0, 0.0};
+        double rest          = 0.0;     // m
+        double frequency     = 0.0;     // Hz
+        double dampingRatio  = 1.0;
+    };
+
+    struct Config {
+        int         iterations = 8;
+        std::size_t maxColors  = 12;     // including the overflow color, <= 64
+        std::size_t blockSize  = 64;     // constraints (or bodies) per work item
+        double      friction   = 0.8;
+        double      baumgarte  = 0.2;    // fraction of penetration removed per step
+        double      slop       = 0.005;  // m of penetration left alone
+    };
+
+    ConstraintSolver(RigidBodySet& bodies, const Config& cfg) : bodies_(bodies), cfg_(cfg) {
+        cfg_.iterations = std::max(cfg_.iterations, 0);
+        cfg_.maxColors  = std::clamp<std::size_t>(cfg_.maxColors, 1, 64);
+        cfg_.blockSize  = std::max<std::size_t>(1, cfg_.blockSize);
+        vel_.resize(bodies.size());
+        mask_.resize(bodies.size());
+    }
+    explicit ConstraintSolver(RigidBodySet& bodies) : ConstraintSolver(bodies, Config{}) {}
+
+    const Config& config() const { return cfg_; }
+
+    // Contacts are re-read every frame; null disables them.
+    void setContactSource(const NarrowPhase* np) { contacts_ = np; }
+
+    // Per-body 0/1 (IslandBuilder::awakeMask()), re-read every frame: a
+    // constraint with no awake dynamic body is left out of the frame, so
+    // sleeping islands cost nothing to color or solve. Null solves all.
+    void setAwakeMask(const std::vector<std::uint8_t>* mask) { awake_ = mask; }
+
+    std::size_t addJoint(const Joint& j) { joints_.push_back(j); return joints_.size() - 1; }
+    Joint& joint(std::size_t i) { return joints_[i]; }
+    const Joint& joint(std::size_t i) const { return joints_[i]; }
+    std::size_t jointCount() const { return joints_.size(); }
+
+    // Last frame's constraints in solve order, grouped by color.
+    std::size_t constraintCount() const { return cons_.size(); }
+    std::size_t colorBegin(std::size_t c) const { return colorStart_[c]; }
+    std::size_t colorEnd(std::size_t c) const { return colorStart_[c + 1]; }
+    std::size_t overflowCount() const { return colorEnd(cfg_.maxColors - 1) - colorBegin(cfg_.maxColors - 1); }
+    std::uint32_t bodyA(std::size_t i) const { return cons_[i].a; }
+    std::uint32_t bodyB(std::size_t i) const { return cons_[i].b; }
+    bool isDynamic(std::uint32_t i) const { return i != kWorld && bodies_.invMass[i] > 0.0; }
+    bool isAwake(std::uint32_t i) const { return isDynamic(i) && (!awake_ || (*awake_)[i]); }
+
+    // Registers the solver as one phase of waves; returns its index. The
+    // iteration count is fixed here.
+    std::size_t install(SimCore& sim, const std::string& name = "Constraints") {
+        const std::size_t ph = sim.addPhase(name);
+        sim.setPhaseChunkSize(ph, 1);
+        sim.addSerialSubsystem(ph, [this, &sim, ph](std::int64_t, SimCore::Seconds dt){
+            begin(dt.count());
+            sim.setPhaseElementCount(ph, items_);
+        });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) loadBodies(k);
+        });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) prepare(k);
+        });
+        for (int it = 0; it < cfg_.iterations; ++it)
+            for (std::size_t c = 0; c < cfg_.maxColors; ++c)
+                sim.addParallelRangeTask(ph, [this, c](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+                    for (std::size_t k = b; k < e; ++k) solveColor(c, k);
+                });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) storeBodies(k);
+        });
+        return ph;
+    }
+
+    // The same waves run inline, for use outside SimCore and in tests.
+    void solve(double dt) {
+        begin(dt);
+        for (std::size_t k = 0; k < items_; ++k) loadBodies(k);
+        for (std::size_t k = 0; k < items_; ++k) prepare(k);
+        for (int it = 0; it < cfg_.iterations; ++it)
+            for (std::size_t c = 0; c < cfg_.maxColors; ++c)
+                for (std::size_t k = 0; k < items_; ++k) solveColor(c, k);
+        for (std::size_t k = 0; k < items_; ++k) storeBodies(k);
+    }
+
+private:
+    enum class Kind : std::uint8_t { Joint, Contact };
+
+    // A constraint before coloring: one joint, or up to 4 contact points
+    // of one body pair.
+    struct Source {
+        Kind          kind;
+        std::uint32_t a, b;
+        std::uint32_t first, count;   // joint index, or contact range
+    };
+    struct Constraint {
+        Kind          kind;
+        std::uint32_t a, b;
+        std::uint32_t first, count;
+        std::uint32_t rowBegin, rowCount;
+        bool          dynA, dynB;
+    };
+    // One scalar row: impulse along n at the two anchors.
+    struct Row {
+        double n[3];
+        double ja[3], jb[3];       // ra x n, rb x n
+        double ma[3], mb[3];       // world inverse inertia times ja, jb
+        double mass   = 0.0;       // (soft) effective mass
+        double target = 0.0;       // desired relative velocity along n
+        double gamma  = 0.0;       // softness
+        double lambda = 0.0;       // accumulated impulse
+        double lo = 0.0, hi = 0.0;
+        double mu = 0.0;           // > 0: friction row, bounded by the row 1 or 2 back
+    };
+    // World-frame velocity state of a body for the solve.
+    struct Vel {
+        double v[3], w[3];
+        double invM;
+        double invI[6];            // xx yy zz xy xz yz
+    };
+
+    static double dot(const double* a, const double* b) { return a[0]*b[0] + a[1]*b[1] + a[2]*b[2]; }
+    static void cross(const double* a, const double* b, double* r) {
+        r[0] = a[1]*b[2] - a[2]*b[1]; r[1] = a[2]*b[0] - a[0]*b[2]; r[2] = a[0]*b[1] - a[1]*b[0];
+    }
+    static void mulInvI(const double* I, const double* x, double* r) {
+        r[0] = I[0]*x[0] + I[3]*x[1] + I[4]*x[2];
+        r[1] = I[3]*x[0] + I[1]*x[1] + I[5]*x[2];
+        r[2] = I[4]*x[0] + I[5]*x[1] + I[2]*x[2];
+    }
+    // Rotation matrix (body -> world) of body i, row-major.
+    void rotation(std::uint32_t i, double* R) const {
+        const double w = bodies_.qw[i], x = bodies_.qx[i], y = bodies_.qy[i], z = bodies_.qz[i];
+        R[0] = 1.0 - 2.0*(y*y + z*z); R[1] = 2.0*(x*y - w*z);       R[2] = 2.0*(x*z + w*y);
+        R[3] = 2.0*(x*y + w*z);       R[4] = 1.0 - 2.0*(x*x + z*z); R[5] = 2.0*(y*z - w*x);
+        R[6] = 2.0*(x*z - w*y);       R[7] = 2.0*(y*z + w*x);       R[8] = 1.0 - 2.0*(x*x + y*y);
+    }
+
+    std::size_t blocks(std::size_t n) const { return (n + cfg_.blockSize - 1) / cfg_.blockSize; }
+
+    void begin(double dt) {
+        dt_ = dt;
+        src_.clear();
+        for (std::size_t j = 0; j < joints_.size(); ++j)
+            if (isAwake(joints_[j].a) || isAwake(joints_[j].b))
+                src_.push_back(Source{Kind::Joint, joints_[j].a, joints_[j].b, std::uint32_t(j), 1});
+        if (contacts_) {
+            const auto& c = contacts_->contacts();
+            for (std::size_t i = 0; i < c.size();) {
+                std::size_t e = i + 1;
+                while (e < c.size() && e - i < 4 && c[e].a == c[i].a && c[e].b == c[i].b) ++e;
+                if (isAwake(c[i].a) || isAwake(c[i].b))
+                    src_.push_back(Source{Kind::Contact, c[i].a, c[i].b, std::uint32_t(i), std::uint32_t(e - i)});
+                i = e;
+            }
+        }
+
+        // Greedy coloring over per-body masks of colors already used.
+        const std::size_t last = cfg_.maxColors - 1;
+        std::fill(mask_.begin(), mask_.end(), 0);
+        color_.resize(src_.size());
+        colorStart_.assign(cfg_.maxColors + 1, 0);
+        for (std::size_t s = 0; s < src_.size(); ++s) {
+            const bool da = isDynamic(src_[s].a), db = isDynamic(src_[s].b);
+            const std::uint64_t used = (da ? mask_[src_[s].a] : 0) | (db ? mask_[src_[s].b] : 0);
+            std::size_t c = 0;
+            while (c < last && (used >> c) & 1u) ++c;
+            if (c < last) {
+                if (da) mask_[src_[s].a] |= std::uint64_t(1) << c;
+                if (db) mask_[src_[s].b] |= std::uint64_t(1) << c;
+            }
+            color_[s] = static_cast<std::uint8_t>(c);
+            ++colorStart_[c + 1];
+        }
+        for (std::size_t c = 0; c < cfg_.maxColors; ++c) colorStart_[c + 1] += colorStart_[c];
+
+        // Color-major, stable within a color; rows laid out in that order.
+        cons_.resize(src_.size());
+        next_.assign(colorStart_.begin(), colorStart_.end() - 1);
+        for (std::size_t s = 0; s < src_.size(); ++s) {
+            const Source& x = src_[s];
+            cons_[next_[color_[s]]++] = Constraint{x.kind, x.a, x.b, x.first, x.count, 0, 0,
+                                                  isDynamic(x.a), isDynamic(x.b)};
+        }
+        std::uint32_t rows = 0;
+        for (auto& c : cons_) {
+            c.rowBegin = rows;
+            c.rowCount = c.kind == Kind::Joint ? 1 : 3 * c.count;
+            rows += c.rowCount;
+        }
+        rows_.resize(rows);
+
+        std::size_t widest = 0;
+        for (std::size_t c = 0; c < last; ++c) widest = std::max(widest, colorEnd(c) - colorBegin(c));
+        items_ = std::max({blocks(bodies_.size()), blocks(cons_.size()), blocks(widest),
+                           overflowCount() ? std::size_t(1) : std::size_t(0)});
+    }
+
+    void loadBodies(std::size_t k) {
+        const std::size_t b = k * cfg_.blockSize, e = std::min(bodies_.size(), b + cfg_.blockSize);
+        const RigidBodySet& r = bodies_;
+        for (std::size_t i = b; i < e; ++i) {
+            double R[9];
+            rotation(std::uint32_t(i), R);
+            Vel& s = vel_[i];
+            s.v[0] = r.vx[i]; s.v[1] = r.vy[i]; s.v[2] = r.vz[i];
+            const double wb[3] = {r.wx[i], r.wy[i], r.wz[i]};
+            for (int m = 0; m < 3; ++m) s.w[m] = R[3*m]*wb[0] + R[3*m+1]*wb[1] + R[3*m+2]*wb[2];
+            s.invM = r.invMass[i];
+            // R diag(invI) R^T
+            const double d[3] = {r.invIx[i], r.invIy[i], r.invIz[i]};
+            auto elem = [&](int p, int q) {
+                return R[3*p]*d[0]*R[3*q] + R[3*p+1]*d[1]*R[3*q+1] + R[3*p+2]*d[2]*R[3*q+2];
+            };
+            s.invI[0] = elem(0, 0); s.invI[1] = elem(1, 1); s.invI[2] = elem(2, 2);
+            s.invI[3] = elem(0, 1); s.invI[4] = elem(0, 2); s.invI[5] = elem(1, 2);
+        }
+    }
+
+    void storeBodies(std::size_t k) {
+        const std::size_t b = k * cfg_.blockSize, e = std::min(bodies_.size(), b + cfg_.blockSize);
+        RigidBodySet& r = bodies_;
+        for (std::size_t i = b; i < e; ++i) {
+            if (!(r.invMass[i] > 0.0)) continue;
+            double R[9];
+            rotation(std::uint32_t(i), R);
+            const Vel& s = vel_[i];
+            r.vx[i] = s.v[0]; r.vy[i] = s.v[1]; r.vz[i] = s.v[2];
+            r.wx[i] = R[0]*s.w[0] + R[3]*s.w[1] + R[6]*s.w[2];
+            r.wy[i] = R[1]*s.w[0] + R[4]*s.w[1] + R[7]*s.w[2];
+            r.wz[i] = R[2]*s.w[0] + R[5]*s.w[1] + R[8]*s.w[2];
+        }
+    }
+
+    // Fills one row for direction n at offsets ra, rb; returns 1/k.
+    double setRow(Row& row, const Constraint& c, const double* n, const double* ra, const double* rb) const {
+        std::copy(n, n + 3, row.n);
+        cross(ra, n, row.ja);
+        cross(rb, n, row.jb);
+        double k = 0.0;
+        if (c.dynA) {
+            const Vel& s = vel_[c.a];
+            mulInvI(s.invI, row.ja, row.ma);
+            k += s.invM + dot(row.ja, row.ma);
+        } else std::fill(row.ma, row.ma + 3, 0.0);
+        if (c.dynB) {
+            const Vel& s = vel_[c.b];
+            mulInvI(s.invI, row.jb, row.mb);
+            k += s.invM + dot(row.jb, row.mb);
+        } else std::fill(row.mb, row.mb + 3, 0.0);
+        row.lambda = 0.0;
+        row.gamma  = 0.0;
+        row.mu     = 0.0;
+        return k > 0.0 ? 1.0 / k : 0.0;
+    }
+
+    void position(std::uint32_t i, double* p) const {
+        p[0] = bodies_.px[i]; p[1] = bodies_.py[i]; p[2] = bodies_.pz[i];
+    }
+
+    void prepare(std::size_t k) {
+        constexpr double kInf = std::numeric_limits<double>::infinity();
+        const std::size_t b = k * cfg_.blockSize, e = std::min(cons_.size(), b + cfg_.blockSize);
+        for (std::size_t ci = b; ci < e; ++ci) {
+            const Constraint& c = cons_[ci];
+            Row* row = &rows_[c.rowBegin];
+            double xa[3] = {0.0, 0.0, 0.0}, xb[3] = {0.0, 0.0, 0.0};
+            if (c.a != kWorld) position(c.a, xa);
+            if (c.b != kWorld) position(c.b, xb);
+            if (c.kind == Kind::Joint) {
+                const Joint& j = joints_[c.first];
+                double ra[3], rb[3], pa[3], pb[3], R[9];
+                rotation(c.a, R);
+                for (int m = 0; m < 3; ++m) ra[m] = dot(&R[3*m], j.anchorA);
+                if (c.b != kWorld) {
+                    rotation(c.b, R);
+                    for (int m = 0; m < 3; ++m) rb[m] = dot(&R[3*m], j.anchorB);
+                } else {
+                    for (int m = 0; m < 3; ++m) rb[m] = 0.0;
+                    std::copy(j.anchorB, j.anchorB + 3, xb);
+                }
+                double d[3], n[3] = {0.0, 0.0, 1.0};
+                for (int m = 0; m < 3; ++m) { pa[m] = xa[m] + ra[m]; pb[m] = xb[m] + rb[m]; d[m] = pb[m] - pa[m]; }
+                const double len = std::sqrt(dot(d, d));
+                if (len > 1e-9) for (int m = 0; m < 3; ++m) n[m] = d[m] / len;
+                const double meff = setRow(*row, c, n, ra, rb);
+                const double C = len - j.rest;
+                if (j.frequency > 0.0 && meff > 0.0) {
+                    // Spring-damper as a soft constraint (implicit, stable
+                    // for any stiffness at this dt).
+                    const double omega = 2.0 * 3.14159265358979323846 * j.frequency;
+                    const double ks = meff * omega * omega;
+                    const double cd = 2.0 * meff * j.dampingRatio * omega;
+                    const double g  = dt_ * (cd + dt_ * ks);
+                    row->gamma  = g > 0.0 ? 1.0 / g : 0.0;
+                    row->target = -C * dt_ * ks * row->gamma;
+                    row->mass   = 1.0 / (1.0 / meff + row->gamma);
+                } else {
+                    row->target = dt_ > 0.0 ? -cfg_.baumgarte / dt_ * C : 0.0;
+                    row->mass   = meff;
+                }
+                row->lo = -kInf; row->hi = kInf;
+                continue;
+            }
+            const auto& contacts = contacts_->contacts();
+            for (std::uint32_t p = 0; p < c.count; ++p) {
+                const auto& ct = contacts[c.first + p];
+                const double n[3] = {ct.nx, ct.ny, ct.nz};
+                const double ra[3] = {ct.px - xa[0], ct.py - xa[1], ct.pz - xa[2]};
+                const double rb[3] = {ct.px - xb[0], ct.py - xb[1], ct.pz - xb[2]};
+                double t1[3], t2[3];
+                if (std::fabs(n[0]) >= 0.57735) {
+                    const double s = 1.0 / std::sqrt(n[0]*n[0] + n[1]*n[1]);
+                    t1[0] = n[1]*s; t1[1] = -n[0]*s; t1[2] = 0.0;
+                } else {
+                    const double s = 1.0 / std::sqrt(n[1]*n[1] + n[2]*n[2]);
+                    t1[0] = 0.0; t1[1] = n[2]*s; t1[2] = -n[1]*s;
+                }
+                cross(n, t1, t2);
+                Row* r3 = row + 3 * p;
+                r3[0].mass   = setRow(r3[0], c, n, ra, rb);
+                r3[0].target = dt_ > 0.0 ? cfg_.baumgarte / dt_ * std::max(ct.depth - cfg_.slop, 0.0) : 0.0;
+                r3[0].lo = 0.0; r3[0].hi = kInf;
+                for (int f = 1; f <= 2; ++f) {
+                    r3[f].mass   = setRow(r3[f], c, f == 1 ? t1 : t2, ra, rb);
+                    r3[f].target = 0.0;
+                    r3[f].mu     = cfg_.friction;
+                }
+            }
+        }
+    }
+
+    void solveColor(std::size_t color, std::size_t k) {
+        std::size_t b = colorBegin(color) + k * cfg_.blockSize;
+        std::size_t e = std::min(colorEnd(color), b + cfg_.blockSize);
+        if (color == cfg_.maxColors - 1) {          // overflow: one item, in order
+            if (k != 0) return;
+            b = colorBegin(color);
+            e = colorEnd(color);
+        }
+        for (std::size_t ci = b; ci < e; ++ci) {
+            const Constraint& c = cons_[ci];
+            // Only dynamic bodies are written; kinematic ones (static but
+            // moving) still contribute their velocity.
+            double va[3], wa[3], vb[3], wb[3];
+            loadVel(c.a, va, wa);
+            loadVel(c.b, vb, wb);
+            const double ima = c.dynA ? vel_[c.a].invM : 0.0;
+            const double imb = c.dynB ? vel_[c.b].invM : 0.0;
+            Row* rows = &rows_[c.rowBegin];
+            for (std::uint32_t r = 0; r < c.rowCount; ++r) {
+                Row& row = rows[r];
+                if (row.mu > 0.0) {
+                    const double lim = row.mu * rows[r - (r % 3)].lambda;
+                    row.lo = -lim; row.hi = lim;
+                }
+                const double vrel = dot(row.n, vb) - dot(row.n, va) + dot(row.jb, wb) - dot(row.ja, wa);
+                double dl = row.mass * (row.target - vrel - row.gamma * row.lambda);
+                const double old = row.lambda;
+                row.lambda = std::clamp(old + dl, row.lo, row.hi);
+                dl = row.lambda - old;
+                for (int m = 0; m < 3; ++m) {
+                    va[m] -= dl * ima * row.n[m]; wa[m] -= dl * row.ma[m];
+                    vb[m] += dl * imb * row.n[m]; wb[m] += dl * row.mb[m];
+                }
+            }
+            if (c.dynA) { std::copy(va, va + 3, vel_[c.a].v); std::copy(wa, wa + 3, vel_[c.a].w); }
+            if (c.dynB) { std::copy(vb, vb + 3, vel_[c.b].v); std::copy(wb, wb + 3, vel_[c.b].w); }
+        }
+    }
+
+    void loadVel(std::uint32_t i, double* v, double* w) const {
+        if (i == kWorld) { std::fill(v, v + 3, 0.0); std::fill(w, w + 3, 0.0); return; }
+        std::copy(vel_[i].v, vel_[i].v + 3, v);
+        std::copy(vel_[i].w, vel_[i].w + 3, w);
+    }
+
+    RigidBodySet&      bodies_;
+    Config             cfg_;
+    const NarrowPhase* contacts_ = nullptr;
+    const std::vector<std::uint8_t>* awake_ = nullptr;
+    std::vector<Joint> joints_;
+    double             dt_ = 0.0;
+    std::size_t        items_ = 0;
+
+    // Rebuilt every frame; capacity kept.
+    std::vector<Source>        src_;
+    std::vector<std::uint8_t>  color_;
+    std::vector<std::uint64_t> mask_;
+    std::vector<std::size_t>   colorStart_{std::vector<std::size_t>(65, 0)};
+    std::vector<std::size_t>   next_;
+    std::vector<Constraint>    cons_;
+    std::vector<Row>           rows_;
+    std::vector<Vel>           vel_;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+
+// Log-linear histogram for non-negative integer samples (typically ns).
+// 32 linear sub-buckets per power of two: <= ~3% relative error, fixed
+// memory, O(1) record, no allocation. Not thread-safe; callers lock.
+class LogHistogram {
+public:
+    static constexpr unsigned    kSubBits   = 5;
+    static constexpr std::size_t kSub       = std::size_t(1) << kSubBits;
+    static constexpr unsigned    kMaxExp    = 47;   // ~39 h in ns; larger values clamp
+    static constexpr std::size_t kBuckets   = (kMaxExp - kSubBits + 2) * kSub;
+
+    void record(std::uint64_t v) {
+        ++counts_[bucketOf(v)];
+        ++total_;
+        if (v > max_) max_ = v;
+    }
+
+    void merge(const LogHistogram& o) {
+        for (std::size_t i = 0; i < kBuckets; ++i) counts_[i] += o.counts_[i];
+        total_ += o.total_;
+        if (o.max_ > max_) max_ = o.max_;
+    }
+
+    void clear() { counts_.fill(0); total_ = 0; max_ = 0; }
+
+    std::uint64_t count() const { return total_; }
+    std::uint64_t max() const { return max_; }
+
+    // Value at quantile q in [0,1] (bucket midpoint, clamped to max seen).
+    std::uint64_t percentile(double q) const {
+        if (total_ == 0) return 0;
+        if (q <= 0.0) q = 0.0;
+        if (q >= 1.0) return max_;
+        auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total_ - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                std::uint64_t mid = lowerBound(i) + width(i) / 2;
+                return mid < max_ ? mid : max_;
+            }
+        }
+        return max_;
+    }
+
+    std::uint64_t bucketCount(std::size_t i) const { return counts_[i]; }
+
+    static std::size_t bucketOf(std::uint64_t v) {
+        if (v < kSub) return static_cast<std::size_t>(v);
+        unsigned e = 63u - static_cast<unsigned>(std::countl_zero(v));
+        if (e > kMaxExp) return kBuckets - 1;
+        return (e - kSubBits + 1) * kSub + ((v >> (e - kSubBits)) & (kSub - 1));
+    }
+    static std::uint64_t lowerBound(std::size_t i) {
+        if (i < kSub) return i;
+        unsigned e = static_cast<unsigned>(i / kSub) + kSubBits - 1;
+        return (kSub + i % kSub) << (e - kSubBits);
+    }
+    static std::uint64_t width(std::size_t i) {
+        if (i < kSub) return 1;
+        unsigned e = static_cast<unsigned>(i / kSub) + kSubBits - 1;
+        return std::uint64_t(1) << (e - kSubBits);
+    }
+
+private:
+    std::array<std::uint64_t, kBuckets> counts_{};
+    std::uint64_t total_ = 0;
+    std::uint64_t max_   = 0;
+};
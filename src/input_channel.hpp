@@ -0,0 +1,185 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "histogram.hpp"
+
+// Lock-free multi-producer / single-consumer channel for timestamped device
+// input (wheel, pedals, network peers). Producers push from any thread;
+// the sim main thread drains at the start of each frame and consumes only
+// the samples due for that frame, keeping later ones for later frames.
+// Bounded (Vyukov cell sequence queue): a full queue drops and counts.
+class InputChannel {
+public:
+    struct Sample {
+        std::uint32_t channel = 0;
+        double        value   = 0.0;
+        std::int64_t  tNs     = 0;     // steady_clock ns
+    };
+
+    explicit InputChannel(std::size_t capacity = 4096, std::size_t channels = 16)
+        : mask_(roundUp(capacity) - 1), cells_(new Cell[mask_ + 1]), state_(channels) {
+        for (std::size_t i = 0; i <= mask_; ++i) cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    static std::int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /* ---- Producer side (any thread) ---- */
+    bool push(std::uint32_t channel, double value, std::int64_t tNs = nowNs()) {
+        if (channel >= state_.size()) return false;
+        std::size_t pos = enqueue_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& c = cells_[pos & mask_];
+            std::size_t seq = c.seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.sample = Sample{channel, value, tNs};
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                pos = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /* ---- Consumer side (sim main thread) ---- */
+    void setInterpolate(bool on) { interpolate_ = on; }
+
+    // Move everything queued into the pending set, then consume samples
+    // with tNs <= dueNs in timestamp order. Values hold the last consumed
+    // sample, or are interpolated toward the next pending one.
+    void drain(std::int64_t dueNs) {
+        for (;;) {
+            Cell& c = cells_[dequeue_ & mask_];
+            if (c.seq.load(std::memory_order_acquire) != dequeue_ + 1) break;
+            pending_.push_back(c.sample);
+            c.seq.store(dequeue_ + mask_ + 1, std::memory_order_release);
+            ++dequeue_;
+        }
+        frame_.clear();
+        dueNs_ = dueNs;
+        if (pending_.empty()) return;
+
+        std::stable_sort(pending_.begin(), pending_.end(),
+                         [](const Sample& a, const Sample& b){ return a.tNs < b.tNs; });
+        auto split = std::upper_bound(pending_.begin(), pending_.end(), dueNs,
+                                      [](std::int64_t t, const Sample& s){ return t < s.tNs; });
+        const std::int64_t now = nowNs();
+        for (auto it = pending_.begin(); it != split; ++it) {
+            auto& st = state_[it->channel];
+            st.value = it->value;
+            st.tNs   = it->tNs;
+            st.valid = true;
+            if (it->tNs > newestNs_) newestNs_ = it->tNs;
+            latency_.record(now > it->tNs ? static_cast<std::uint64_t>(now - it->tNs) : 0);
+            frame_.push_back(*it);
+        }
+        pending_.erase(pending_.begin(), split);
+    }
+
+    // Samples consumed by the current frame, oldest first.
+    const std::vector<Sample>& frameSamples() const { return frame_; }
+
+    // Channel value at the current frame's due time.
+    double value(std::uint32_t channel) const {
+        if (channel >= state_.size()) return 0.0;
+        const auto& st = state_[channel];
+        if (!interpolate_ || !st.valid) return st.value;
+        for (const auto& s : pending_) {
+            if (s.channel != channel) continue;
+            if (s.tNs <= st.tNs) break;
+            double a = double(dueNs_ - st.tNs) / double(s.tNs - st.tNs);
+            return st.value + (s.value - st.value) * std::clamp(a, 0.0, 1.0);
+        }
+        return st.value;
+    }
+    bool hasValue(std::uint32_t channel) const {
+        return channel < state_.size() && state_[channel].valid;
+    }
+    // Timestamp tags: the newest consumed sample of one channel, or of any
+    // channel. 0 until something was consumed.
+    std::int64_t stampNs(std::uint32_t channel) const {
+        return channel < state_.size() ? state_[channel].tNs : 0;
+    }
+    std::int64_t newestNs() const { return newestNs_; }
+
+    std::size_t channelCount() const { return state_.size(); }
+    std::size_t pendingCount() const { return pending_.size(); }
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    // Sample timestamp -> drain time, for every consumed sample.
+    const LogHistogram& latency() const { return latency_; }
+    void resetStats() { latency_.clear(); }
+
+private:
+    struct alignas(64) Cell {
+        std::atomic<std::size_t> seq{0};
+        Sample                   sample{};
+    };
+    struct ChannelState {
+        double       value = 0.0;
+        std::int64_t tNs   = 0;
+        bool         valid = false;
+    };
+
+    static std::size_t roundUp(std::size_t n) {
+        std::size_t p = 2;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    const std::size_t        mask_;
+    std::unique_ptr<Cell[]>  cells_;
+    alignas(64) std::atomic<std::size_t> enqueue_{0};
+    alignas(64) std::atomic<std::uint64_t> dropped_{0};
+    alignas(64) std::size_t  dequeue_ = 0;
+
+    std::vector<Sample>       pending_;
+    std::vector<Sample>       frame_;
+    std::vector<ChannelState> state_;
+    std::int64_t              dueNs_ = 0;
+    std::int64_t              newestNs_ = 0;
+    bool                      interpolate_ = false;
+    LogHistogram              latency_;
+};
+
+// End-to-end latency at an output point (force feedback, network send):
+// the age of the newest input that influenced the output, taken when the
+// output is emitted. emit() may be called from any thread.
+class OutputLatency {
+public:
+    explicit OutputLatency(std::string name) : name_(std::move(name)) {}
+
+    void emit(std::int64_t inputNs, std::int64_t nowNs = InputChannel::nowNs()) {
+        if (inputNs <= 0) return;   // nothing consumed yet: no latency to report
+        std::lock_guard<std::mutex> lk(m_);
+        hist_.record(nowNs > inputNs ? static_cast<std::uint64_t>(nowNs - inputNs) : 0);
+    }
+
+    const std::string& name() const { return name_; }
+    LogHistogram histogram() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return hist_;
+    }
+    void reset() {
+        std::lock_guard<std::mutex> lk(m_);
+        hist_.clear();
+    }
+
+private:
+    std::string        name_;
+    mutable std::mutex m_;
+    LogHistogram       hist_;
+};
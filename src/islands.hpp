@@ -0,0 +1,321 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "SimCore.hpp"
+#include "constraint_solver.hpp"
+#include "narrowphase.hpp"
+#include "rigid_body.hpp"
+
+// Islands: connected groups of dynamic bodies over the contact and joint
+// graph, rebuilt every frame. Static bodies and the ground do not connect
+// anything. Islands never interact within a frame, so each is a job that
+// can be solved without synchronizing with the others.
+//
+// Per frame, as waves of one SimCore phase over fixed blocks:
+//   reset    parent[i] = i; per-body rest counters for sleeping
+//   unite    lock-free union-find over the edges; a root is always linked
+//            under the smaller root, so each island's root ends up being
+//            its lowest body index whatever the interleaving
+//   label    root of every body
+//   build    (reduction, linear) islands ordered by root, bodies and edges
+//            grouped per island, sleep state, cost-sized jobs
+// An island sleeps once all its bodies have been slower than the sleep
+// thresholds, with no force or torque applied, for sleepFrames frames. A
+// force or torque on any of its bodies wakes it on the next pass (the
+// masked integrator leaves the accumulators of sleeping bodies alone), and
+// touching an awake body merges it into an awake island again. Sleeping islands get no job, and awakeMask() lets
+// the solver and integrator skip them (setAwakeMask on each); the narrow
+// phase still tests them, since their contacts are what wakes them.
+class IslandBuilder {
+public:
+    static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+    enum class EdgeKind : std::uint8_t { Contact, Joint };
+    struct Edge {
+        std::uint32_t a, b;
+        EdgeKind      kind;
+        std::uint32_t source;   // first contact of the pair, or joint index
+    };
+    struct Island {
+        std::uint32_t bodyBegin, bodyCount;   // into bodies()
+        std::uint32_t edgeBegin, edgeCount;   // into edges()
+        double        cost;
+        bool          asleep;
+    };
+
+    struct Config {
+        std::size_t blockSize     = 1024;   // bodies (or edges) per work item
+        double      sleepLinear   = 0.05;   // m/s
+        double      sleepAngular  = 0.05;   // rad/s
+        int         sleepFrames   = 60;     // <= 0: never sleep
+        bool        zeroSleeping  = true;   // clear velocities of sleeping bodies
+        double      bodyCost      = 1.0;
+        double      edgeCost      = 4.0;
+        std::size_t jobsPerWorker = 4;
+    };
+
+    using IslandTask = std::function<void(const Island&, std::int64_t frame, SimCore::Seconds dt)>;
+
+    IslandBuilder(RigidBodySet& bodies, const Config& cfg)
+        : bodies_(bodies), cfg_(cfg), n_(bodies.size()) {
+        cfg_.blockSize     = std::max<std::size_t>(1, cfg_.blockSize);
+        cfg_.jobsPerWorker = std::max<std::size_t>(1, cfg_.jobsPerWorker);
+        parent_ = std::make_unique<std::atomic<std::uint32_t>[]>(std::max<std::size_t>(n_, 1));
+        root_.resize(n_);
+        rest_.assign(n_, 0);
+        islandOf_.assign(n_, kNone);
+        awakeMask_.assign(n_, 1);
+    }
+    explicit IslandBuilder(RigidBodySet& bodies) : IslandBuilder(bodies, Config{}) {}
+
+    // Edge sources, re-read every frame; null disables one.
+    void setContactSource(const NarrowPhase* np) { contacts_ = np; }
+    void setJointSource(const ConstraintSolver* s) { joints_ = s; }
+
+    const Config& config() const { return cfg_; }
+    const std::vector<Island>& islands() const { return islands_; }
+    const std::vector<std::uint32_t>& bodies() const { return members_; }
+    const std::vector<Edge>& edges() const { return islandEdges_; }
+    std::uint32_t islandOf(std::size_t body) const { return islandOf_[body]; }
+    bool asleep(std::size_t body) const {
+        return islandOf_[body] != kNone && islands_[islandOf_[body]].asleep;
+    }
+    std::size_t awakeCount() const { return awake_; }
+    // Per body: 0 in a sleeping island, else 1. Rebuilt every frame, same
+    // address for the builder's lifetime.
+    const std::vector<std::uint8_t>& awakeMask() const { return awakeMask_; }
+
+    // Jobs: ranges of jobIslands(); islands big enough for a job of their
+    // own come first, by descending cost.
+    std::size_t jobCount() const { return jobStart_.size() - 1; }
+    std::size_t jobBegin(std::size_t j) const { return jobStart_[j]; }
+    std::size_t jobEnd(std::size_t j) const { return jobStart_[j + 1]; }
+    const std::vector<std::uint32_t>& jobIslands() const { return jobIslands_; }
+
+    // Registers island building as one phase; returns its index.
+    std::size_t install(SimCore& sim, const std::string& name = "Islands") {
+        workers_ = std::max<std::size_t>(1, sim.workerCount());
+        const std::size_t ph = sim.addPhase(name);
+        sim.setPhaseChunkSize(ph, 1);
+        sim.addSerialSubsystem(ph, [this, &sim, ph](std::int64_t, SimCore::Seconds){
+            begin();
+            sim.setPhaseElementCount(ph, items_);
+        });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) reset(k);
+        });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) unite(k);
+        });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) label(k);
+        });
+        sim.addReductionTask(ph, [this](std::int64_t, SimCore::Seconds){ build(); });
+        return ph;
+    }
+
+    // A phase running `fn` once per awake island, one job per work item.
+    // Install after install().
+    std::size_t installJobs(SimCore& sim, IslandTask fn, const std::string& name = "IslandJobs") {
+        const std::size_t ph = sim.addPhase(name);
+        sim.setPhaseChunkSize(ph, 1);
+        sim.addSerialSubsystem(ph, [this, &sim, ph](std::int64_t, SimCore::Seconds){
+            sim.setPhaseElementCount(ph, jobCount());
+        });
+        sim.addParallelRangeTask(ph, [this, fn = std::move(fn)](std::size_t b, std::size_t e,
+                                                                std::int64_t frame, SimCore::Seconds dt){
+            for (std::size_t j = b; j < e; ++j)
+                for (std::size_t k = jobBegin(j); k < jobEnd(j); ++k) fn(islands_[jobIslands_[k]], frame, dt);
+        });
+        return ph;
+    }
+
+    // The same waves run inline, for use outside SimCore and in tests.
+    void update() {
+        begin();
+        for (std::size_t k = 0; k < items_; ++k) reset(k);
+        for (std::size_t k = 0; k < items_; ++k) unite(k);
+        for (std::size_t k = 0; k < items_; ++k) label(k);
+        build();
+    }
+
+private:
+    bool dynamic(std::uint32_t i) const { return i != kNone && bodies_.invMass[i] > 0.0; }
+    std::size_t blocks(std::size_t n) const { return (n + cfg_.blockSize - 1) / cfg_.blockSize; }
+
+    void begin() {
+        edges_.clear();
+        if (contacts_) {
+            const auto& c = contacts_->contacts();
+            for (std::size_t i = 0; i < c.size(); ++i) {
+                if (i > 0 && c[i].a == c[i - 1].a && c[i].b == c[i - 1].b) continue;
+                if (dynamic(c[i].a) && dynamic(c[i].b))
+                    edges_.push_back(Edge{c[i].a, c[i].b, EdgeKind::Contact, std::uint32_t(i)});
+            }
+        }
+        if (joints_) {
+            for (std::size_t j = 0; j < joints_->jointCount(); ++j) {
+                const auto& jt = joints_->joint(j);
+                if (dynamic(jt.a) && dynamic(jt.b))
+                    edges_.push_back(Edge{jt.a, jt.b, EdgeKind::Joint, std::uint32_t(j)});
+            }
+        }
+        items_ = std::max(blocks(n_), blocks(edges_.size()));
+    }
+
+    void reset(std::size_t k) {
+        const std::size_t b = k * cfg_.blockSize, e = std::min(n_, b + cfg_.blockSize);
+        const RigidBodySet& r = bodies_;
+        const double l2 = cfg_.sleepLinear * cfg_.sleepLinear, a2 = cfg_.sleepAngular * cfg_.sleepAngular;
+        for (std::size_t i = b; i < e; ++i) {
+            parent_[i].store(std::uint32_t(i), std::memory_order_relaxed);
+            const double v2 = r.vx[i]*r.vx[i] + r.vy[i]*r.vy[i] + r.vz[i]*r.vz[i];
+            const double w2 = r.wx[i]*r.wx[i] + r.wy[i]*r.wy[i] + r.wz[i]*r.wz[i];
+            const bool loaded = r.fx[i] != 0.0 || r.fy[i] != 0.0 || r.fz[i] != 0.0 ||
+                                r.tx[i] != 0.0 || r.ty[i] != 0.0 || r.tz[i] != 0.0;
+            rest_[i] = (v2 <= l2 && w2 <= a2 && !loaded) ? std::min(rest_[i] + 1, 1 << 30) : 0;
+        }
+    }
+
+    // Path halving; concurrent unions only ever move a parent closer to
+    // the root, so a stale read is still on the path.
+    std::uint32_t find(std::uint32_t x) {
+        for (;;) {
+            std::uint32_t p = parent_[x].load(std::memory_order_relaxed);
+            if (p == x) return x;
+            const std::uint32_t g = parent_[p].load(std::memory_order_relaxed);
+            if (g != p) parent_[x].compare_exchange_weak(p, g, std::memory_order_relaxed);
+            x = g;
+        }
+    }
+
+    void unite(std::size_t k) {
+        const std::size_t b = k * cfg_.blockSize, e = std::min(edges_.size(), b + cfg_.blockSize);
+        for (std::size_t i = b; i < e; ++i) {
+            std::uint32_t x = edges_[i].a, y = edges_[i].b;
+            for (;;) {
+                x = find(x);
+                y = find(y);
+                if (x == y) break;
+                if (x < y) std::swap(x, y);
+                std::uint32_t expect = x;   // x still a root: link it under y
+                if (parent_[x].compare_exchange_strong(expect, y, std::memory_order_acq_rel)) break;
+            }
+        }
+    }
+
+    void label(std::size_t k) {
+        const std::size_t b = k * cfg_.blockSize, e = std::min(n_, b + cfg_.blockSize);
+        for (std::size_t i = b; i < e; ++i)
+            root_[i] = dynamic(std::uint32_t(i)) ? find(std::uint32_t(i)) : kNone;
+    }
+
+    void build() {
+        // Islands numbered in root order; a root is its island's lowest body.
+        islands_.clear();
+        for (std::size_t i = 0; i < n_; ++i) {
+            if (root_[i] == i) {
+                islandOf_[i] = std::uint32_t(islands_.size());
+                islands_.push_back(Island{0, 0, 0, 0, 0.0, cfg_.sleepFrames > 0});
+            }
+        }
+        for (std::size_t i = 0; i < n_; ++i) {
+            if (root_[i] == kNone) { islandOf_[i] = kNone; continue; }
+            Island& is = islands_[islandOf_[root_[i]]];
+            islandOf_[i] = islandOf_[root_[i]];
+            ++is.bodyCount;
+            if (rest_[i] < cfg_.sleepFrames) is.asleep = false;
+        }
+        for (const Edge& e : edges_) ++islands_[islandOf_[e.a]].edgeCount;
+
+        std::uint32_t bodyRun = 0, edgeRun = 0;
+        for (Island& is : islands_) {
+            is.bodyBegin = bodyRun; bodyRun += is.bodyCount;
+            is.edgeBegin = edgeRun; edgeRun += is.edgeCount;
+            is.cost = cfg_.bodyCost * is.bodyCount + cfg_.edgeCost * is.edgeCount;
+            is.bodyCount = 0; is.edgeCount = 0;     // refilled as cursors below
+        }
+        members_.resize(bodyRun);
+        islandEdges_.resize(edgeRun);
+        for (std::size_t i = 0; i < n_; ++i) {
+            if (islandOf_[i] == kNone) continue;
+            Island& is = islands_[islandOf_[i]];
+            members_[is.bodyBegin + is.bodyCount++] = std::uint32_t(i);
+        }
+        for (const Edge& e : edges_) {
+            Island& is = islands_[islandOf_[e.a]];
+            islandEdges_[is.edgeBegin + is.edgeCount++] = e;
+        }
+
+        std::fill(awakeMask_.begin(), awakeMask_.end(), std::uint8_t(1));
+        RigidBodySet& r = bodies_;
+        for (const Island& is : islands_) {
+            if (!is.asleep) continue;
+            for (std::uint32_t m = is.bodyBegin; m < is.bodyBegin + is.bodyCount; ++m) {
+                const std::uint32_t i = members_[m];
+                awakeMask_[i] = 0;
+                if (!cfg_.zeroSleeping) continue;
+                r.vx[i] = r.vy[i] = r.vz[i] = 0.0;
+                r.wx[i] = r.wy[i] = r.wz[i] = 0.0;
+            }
+        }
+        buildJobs();
+    }
+
+    // Islands at or above the target cost are jobs of their own, largest
+    // first (ties by index); the rest are packed in index order until a
+    // job reaches the target. Only the large ones need sorting.
+    void buildJobs() {
+        double total = 0.0;
+        awake_ = 0;
+        for (const Island& is : islands_) {
+            if (is.asleep) continue;
+            total += is.cost;
+            ++awake_;
+        }
+        const double target = total / double(workers_ * cfg_.jobsPerWorker);
+        jobIslands_.clear();
+        for (std::size_t i = 0; i < islands_.size(); ++i)
+            if (!islands_[i].asleep && islands_[i].cost >= target) jobIslands_.push_back(std::uint32_t(i));
+        std::stable_sort(jobIslands_.begin(), jobIslands_.end(), [this](std::uint32_t x, std::uint32_t y) {
+            return islands_[x].cost > islands_[y].cost;
+        });
+        jobStart_.resize(jobIslands_.size() + 1);
+        std::iota(jobStart_.begin(), jobStart_.end(), std::size_t(0));
+        double cost = 0.0;
+        for (std::size_t i = 0; i < islands_.size(); ++i) {
+            if (islands_[i].asleep || islands_[i].cost >= target) continue;
+            jobIslands_.push_back(std::uint32_t(i));
+            cost += islands_[i].cost;
+            if (cost >= target) { jobStart_.push_back(jobIslands_.size()); cost = 0.0; }
+        }
+        if (jobStart_.back() != jobIslands_.size()) jobStart_.push_back(jobIslands_.size());
+    }
+
+    RigidBodySet&           bodies_;
+    Config                  cfg_;
+    std::size_t             n_;
+    std::size_t             workers_ = 1;
+    std::size_t             items_   = 0;
+    std::size_t             awake_   = 0;
+    const NarrowPhase*      contacts_ = nullptr;
+    const ConstraintSolver* joints_   = nullptr;
+
+    std::vector<Edge>                             edges_;
+    std::unique_ptr<std::atomic<std::uint32_t>[]> parent_;
+    std::vector<std::uint32_t>                    root_;
+    std::vector<int>                              rest_;   // frames below the sleep thresholds
+    std::vector<std::uint32_t>                    islandOf_;
+    std::vector<std::uint8_t>                     awakeMask_;
+    std::vector<Island>                           islands_;
+    std::vector<std::uint32_t>                    members_;
+    std::vector<Edge>                             islandEdges_;
+    std::vector<std::uint32_t>                    jobIslands_;
+    std::vector<std::size_t>                      jobStart_{0};
+};
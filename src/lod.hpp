@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "SimCore.hpp"
+
+// Level-of-detail scheduling: elements (cars) are bucketed by LOD level from
+// a per-element distance every frame, and each level runs its own phases at
+// its own rate, over only the elements it holds. Per-frame work then scales
+// with the near elements; far ones cost a classification and 1/rate of
+// their level's tasks.
+//
+// Per frame, in the LOD phase (serial, element order, so independent of
+// the thread count):
+//   classify  level from distance, with hysteresis around each boundary
+//   transfer  hooks for every element that changed level, before any level
+//             phase runs, so they can move state between the two models
+//   schedule  per level, the elements due this frame: at rate N, element i
+//             is due when (i + frame) % N == 0, which spreads a level's
+//             work evenly over frames
+// Each due element carries the time since it was last updated by any
+// level, so switching levels never loses or repeats simulated time.
+//
+// install() must come before addLevelPhase(), so that classification runs
+// ahead of the level phases each frame.
+class LodScheduler {
+public:
+    struct Level {
+        std::string name;
+        double      maxDistance = 0.0;   // upper bound of this level; ignored for the last
+        int         rate        = 1;     // update every N frames
+    };
+
+    struct Config {
+        std::vector<Level> levels{{"near", 100.0, 1}, {"mid", 400.0, 2}, {"far", 0.0, 8}};
+        double hysteresis = 10.0;   // m either side of a boundary before switching
+    };
+
+    // Elements [b, e) of `ids`, with each one's elapsed time in dt (seconds,
+    // parallel to ids).
+    using LevelTask = std::function<void(const std::uint32_t* ids, const double* dt,
+                                         std::size_t b, std::size_t e, std::int64_t frame)>;
+    // Called once per element changing level: (element, from, to). `from`
+    // is -1 on the first classification.
+    using Transfer = std::function<void(std::uint32_t element, int from, int to)>;
+
+    LodScheduler(std::size_t elements, const Config& cfg)
+        : distance(elements, 0.0), cfg_(cfg), level_(elements, -1), last_(elements, 0) {
+        if (cfg_.levels.empty()) cfg_.levels.push_back(Level{"all", 0.0, 1});
+        for (auto& l : cfg_.levels) l.rate = std::max(l.rate, 1);
+        members_.resize(cfg_.levels.size());
+        due_.resize(cfg_.levels.size());
+        dueDt_.resize(cfg_.levels.size());
+    }
+    explicit LodScheduler(std::size_t elements) : LodScheduler(elements, Config{}) {}
+
+    // Input: distance of each element to whatever sets the detail (player,
+    // camera), written before the LOD phase runs.
+    std::vector<double> distance;
+
+    std::size_t size() const { return distance.size(); }
+    int levelCount() const { return static_cast<int>(cfg_.levels.size()); }
+    const Level& level(int l) const { return cfg_.levels[std::size_t(l)]; }
+    int levelOf(std::uint32_t i) const { return level_[i]; }
+    // All elements in a level, ascending, as of this frame's classification.
+    const std::vector<std::uint32_t>& members(int l) const { return members_[std::size_t(l)]; }
+    // The level's elements updated this frame and their elapsed times.
+    const std::vector<std::uint32_t>& due(int l) const { return due_[std::size_t(l)]; }
+    const std::vector<double>& dueDt(int l) const { return dueDt_[std::size_t(l)]; }
+    std::size_t transfers() const { return transfers_; }   // level changes in the last frame
+
+    void setTransfer(Transfer fn) { transfer_ = std::move(fn); }
+
+    // Registers the classification phase; returns its index.
+    std::size_t install(SimCore& sim, const std::string& name = "LOD") {
+        const std::size_t ph = sim.addPhase(name, 0);
+        sim.addSerialSubsystem(ph, [this, &sim](std::int64_t frame, SimCore::Seconds dt){
+            update(frame, dt.count());
+            for (const auto& p : phases_) sim.setPhaseElementCount(p.phase, due_[std::size_t(p.level)].size());
+        });
+        return ph;
+    }
+
+    // Adds a phase that runs over the due elements of `level`; tasks are
+    // added to it with addLevelTask(). Returns the SimCore phase index.
+    std::size_t addLevelPhase(SimCore& sim, int lvl, const std::string& name) {
+        const std::size_t ph = sim.addPhase(name, 0);
+        phases_.push_back({ph, lvl});
+        return ph;
+    }
+
+    void addLevelTask(SimCore& sim, std::size_t phase, LevelTask task) {
+        int lvl = -1;
+        for (const auto& p : phases_) if (p.phase == phase) lvl = p.level;
+        if (lvl < 0) return;
+        sim.addParallelRangeTask(phase, [this, lvl, task = std::move(task)](std::size_t b, std::size_t e,
+                                                                            std::int64_t frame, SimCore::Seconds){
+            task(due_[std::size_t(lvl)].data(), dueDt_[std::size_t(lvl)].data(), b, e, frame);
+        });
+    }
+
+    // Classification, transfers and scheduling for one frame; what the LOD
+    // phase runs. Public for driving the scheduler without SimCore.
+    void update(std::int64_t frame, double dt) {
+        for (auto& m : members_) m.clear();
+        for (auto& d : due_) d.clear();
+        for (auto& d : dueDt_) d.clear();
+        transfers_ = 0;
+        for (std::size_t i = 0; i < size(); ++i) {
+            const auto id = static_cast<std::uint32_t>(i);
+            const int cur = level_[i];
+            int next = cur;
+            if (cur < 0) {
+                next = classify(distance[i]);
+                last_[i] = frame - 1;   // first frame: one step of elapsed time
+            } else {
+                // Coarser only past the boundary plus the margin, finer only
+                // inside it minus the margin.
+                const int up   = classify(distance[i] - cfg_.hysteresis);
+                const int down = classify(distance[i] + cfg_.hysteresis);
+                next = up > cur ? up : (down < cur ? down : cur);
+            }
+            if (next != cur) {
+                if (transfer_) transfer_(id, cur, next);
+                level_[i] = next;
+                ++transfers_;
+            }
+            const auto l = std::size_t(next);
+            members_[l].push_back(id);
+            if ((static_cast<std::int64_t>(i) + frame) % cfg_.levels[l].rate == 0) {
+                due_[l].push_back(id);
+                dueDt_[l].push_back(double(frame - last_[i]) * dt);
+                last_[i] = frame;
+            }
+        }
+    }
+
+private:
+    struct LevelPhase { std::size_t phase; int level; };
+
+    int classify(double d) const {
+        int l = 0;
+        while (l + 1 < levelCount() && d >= cfg_.levels[std::size_t(l)].maxDistance) ++l;
+        return l;
+    }
+
+    Config cfg_;
+    std::vector<int>          level_;
+    std::vector<std::int64_t> last_;   // frame of the last update
+    std::vector<std::vector<std::uint32_t>> members_, due_;
+    std::vector<std::vector<double>>        dueDt_;
+    std::vector<LevelPhase>   phases_;
+    Transfer                  transfer_;
+    std::size_t               transfers_ = 0;
+};
@@ -7,9 +7,9 @@
 #include <chrono>
 #include <thread>
 #include <cstdio>
-#include <fstream>
 #include <sstream>
 #include <atomic>
+#include "async_io.hpp"
 
 #ifndef LOG_DEFAULT_LEVEL
 #define LOG_DEFAULT_LEVEL 2   // Info
@@ -42,17 +42,29 @@ public:
     private: std::mutex m_;
     };
 
+    // Appends through an AsyncIO service, so logging threads never block
+    // on disk; a line that does not fit the free pool is dropped and counted
+    // there. The file is opened here: construct sinks in setup code.
     class FileSink : public Sink {
     public:
-        explicit FileSink(const std::string& path) : f_(path, std::ios::app) {}
+        // Through the process-wide AsyncIO::shared().
+        explicit FileSink(const std::string& path) : FileSink(path, AsyncIO::shared()) {}
+        // Through `io`, which must outlive the sink.
+        FileSink(const std::string& path, AsyncIO* io) : io_(io), fd_(io ? io->open(path) : -1) {}
+        FileSink(const std::string& path, std::shared_ptr<AsyncIO> io) : FileSink(path, io.get()) {
+            keep_ = std::move(io);
+        }
+        ~FileSink() override { if (fd_ >= 0) io_->close(fd_); }
         void write(const Record& r) override {
-            if (!f_) return;
-            std::lock_guard<std::mutex> lk(m_);
-            f_ << r.msg << '\n';
+            if (fd_ < 0) return;
+            thread_local std::string line;
+            line.assign(r.msg).push_back('\n');
+            io_->write(fd_, line);
         }
     private:
-        std::ofstream f_;
-        std::mutex m_;
+        std::shared_ptr<AsyncIO> keep_;
+        AsyncIO* io_ = nullptr;
+        AsyncIO::FileId fd_ = -1;
     };
 
     class RingBufferSink : public Sink {
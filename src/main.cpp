@@ -1,6 +1,7 @@
 #include "simcore.hpp"
 #include "logger.hpp"
 #include "profiler.hpp"
+#include "scenario.hpp"
 #include <vector>
 #include <cmath>
 #include <iostream>
@@ -29,6 +30,7 @@ int main(int argc, char* argv[]) {
     bool stress = false;
 
     std::size_t elements = 5000;
+    std::string scenarioPath;
 
     for (int i=1;i<argc;++i){
         if (std::strcmp(argv[i],"--stress")==0) stress = true;
@@ -41,6 +43,7 @@ int main(int argc, char* argv[]) {
         else if (std::strcmp(argv[i],"--elements")==0 && i+1<argc) elements = parseSize(argv[++i], elements);
         else if (std::strcmp(argv[i],"--adaptive")==0 && i+1<argc) cfg.adaptive = (std::atoi(argv[++i])!=0);
         else if (std::strcmp(argv[i],"--spinMicros")==0 && i+1<argc) cfg.spinMicros = (int)parseLong(argv[++i], cfg.spinMicros);
+        else if (std::strcmp(argv[i],"--scenario")==0 && i+1<argc) scenarioPath = argv[++i];
     }
 
     Logger logger;
@@ -57,8 +60,32 @@ int main(int argc, char* argv[]) {
     auto input   = sim.addPhase("Input");
     auto physics = sim.addPhase("Physics");
 
+    // Binary scenario (tools/scenario_convert): element count and initial
+    // state come straight from the mapped columns, sized by vehicles.vel or,
+    // without it, vehicles.pos. A scenario that was asked for but cannot be
+    // used is an error rather than a silent fallback to the defaults.
+    Scenario scenario;
+    if (!scenarioPath.empty()) {
+        if (!scenario.open(scenarioPath)) {
+            std::cerr << "scenario " << scenarioPath << ": " << scenario.error() << "\n";
+            return 1;
+        }
+        elements = scenario.rows("vehicles.vel");
+        if (elements == 0) elements = scenario.rows("vehicles.pos");
+        if (elements == 0) {
+            std::cerr << "scenario " << scenarioPath << ": no vehicles.vel or vehicles.pos column\n";
+            return 1;
+        }
+    }
+
     std::vector<double> pos(elements,0.0), vel(elements,10.0),
                         thr(elements,0.5), force(elements,0.0);
+    if (scenario.valid()) {
+        scenario.load("vehicles.pos", pos);
+        scenario.load("vehicles.vel", vel);
+        pos.resize(elements, 0.0);
+        vel.resize(elements, 10.0);
+    }
     sim.setPhaseElementCount(physics, elements);
 
     // Serial input phase (control/throttle modulation + optional stalls)
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <string>
+#include <cstddef>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define MMAP_SUPPORTED 1
+#endif
+
+// Read-only memory mapping of a whole file (telemetry, scenarios, terrain).
+// Failures leave the mapping invalid; callers check valid() and degrade.
+class MappedFile {
+public:
+    enum class Access { Sequential, Random };
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& o) noexcept { swap(o); }
+    MappedFile& operator=(MappedFile&& o) noexcept {
+        if (this != &o) { reset(); swap(o); }
+        return *this;
+    }
+    ~MappedFile() { reset(); }
+
+    static MappedFile open(const std::string& path, Access access = Access::Sequential) {
+        MappedFile m;
+#ifdef MMAP_SUPPORTED
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return m;
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return m; }
+        std::size_t size = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return m;
+        ::madvise(p, size, access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        m.path_ = path;
+        m.data_ = p;
+        m.size_ = size;
+#else
+        (void)path; (void)access;
+#endif
+        return m;
+    }
+
+    bool valid() const { return data_ != nullptr; }
+    const void* data() const { return data_; }
+    const unsigned char* bytes() const { return static_cast<const unsigned char*>(data_); }
+    std::size_t size() const { return size_; }
+    const std::string& path() const { return path_; }
+
+    // Asks the kernel to start reading [offset, offset + length) in the
+    // background (streaming ahead of use); a hint, so failures are ignored.
+    void willNeed(std::size_t offset, std::size_t length) const {
+#ifdef MMAP_SUPPORTED
+        if (!data_ || offset >= size_) return;
+        const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        const std::size_t b = offset / page * page;
+        const std::size_t e = std::min(size_, offset + length);
+        ::madvise(static_cast<char*>(data_) + b, e - b, MADV_WILLNEED);
+#else
+        (void)offset; (void)length;
+#endif
+    }
+
+    void reset() {
+#ifdef MMAP_SUPPORTED
+        if (data_) ::munmap(data_, size_);
+#endif
+        data_ = nullptr; size_ = 0; path_.clear();
+    }
+
+private:
+    void swap(MappedFile& o) noexcept {
+        std::swap(path_, o.path_);
+        std::swap(data_, o.data_);
+        std::swap(size_, o.size_);
+    }
+
+    std::string path_;
+    void*       data_ = nullptr;
+    std::size_t size_ = 0;
+};
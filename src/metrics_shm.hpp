@@ -0,0 +1,112 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <algorithm>
+#include <new>
+#include "shm_region.hpp"
+
+// Fixed-layout metrics block shared with an external monitor process.
+// One writer (the sim main thread), any number of readers; readers never
+// block the writer and retry while `seq` is odd or changes under them.
+struct MetricsBlock {
+    static constexpr std::uint32_t kMagic     = 0x534D4554; // "SMET"
+    static constexpr std::uint32_t kVersion   = 1;
+    static constexpr std::size_t   kMaxPhases  = 32;
+    static constexpr std::size_t   kMaxWorkers = 256;
+    static constexpr std::size_t   kNameLen    = 32;
+
+    struct Payload {
+        std::int64_t  frame        = 0;
+        std::int64_t  frameNs      = 0;   // compute time of the last frame
+        std::int64_t  latenessNs   = 0;   // completion vs deadline (>0 == late)
+        double        driftMs      = 0.0;
+        std::uint32_t catchUpSteps = 0;
+        std::uint32_t phaseCount   = 0;
+        std::uint32_t workerCount  = 0;
+        std::uint32_t namesVersion = 0;   // bumps when phaseNames change
+        std::uint64_t wallNs       = 0;   // monotonic ns since run() start
+        std::int64_t  phaseNs[kMaxPhases]{};
+        std::uint64_t workerBusyNs[kMaxWorkers]{}; // cumulative
+        char          phaseNames[kMaxPhases][kNameLen]{};
+    };
+
+    std::uint32_t              magic   = kMagic;
+    std::uint32_t              version = kVersion;
+    double                     hz      = 0.0;
+    std::atomic<std::uint32_t> seq{0};
+    Payload                    data{};
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "seqlock counter must be lock-free to live in shared memory");
+
+class MetricsPublisher {
+public:
+    explicit MetricsPublisher(const std::string& shmName = "/simcore_metrics")
+        : region_(ShmRegion::create(shmName, sizeof(MetricsBlock))) {
+        if (region_.valid()) block_ = new (region_.data()) MetricsBlock{};
+    }
+
+    bool ok() const { return block_ != nullptr; }
+    const std::string& name() const { return region_.name(); }
+
+    // Writer side: begin() returns the payload to fill, commit() publishes it.
+    MetricsBlock::Payload& begin() {
+        std::uint32_t s = block_->seq.load(std::memory_order_relaxed);
+        block_->seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return block_->data;
+    }
+    void commit() {
+        std::uint32_t s = block_->seq.load(std::memory_order_relaxed);
+        block_->seq.store(s + 1, std::memory_order_release);
+    }
+
+    void setHz(double hz) { if (block_) block_->hz = hz; }
+
+    static void setName(MetricsBlock::Payload& p, std::size_t idx, const std::string& n) {
+        if (idx >= MetricsBlock::kMaxPhases) return;
+        std::size_t len = std::min(n.size(), MetricsBlock::kNameLen - 1);
+        std::memcpy(p.phaseNames[idx], n.data(), len);
+        p.phaseNames[idx][len] = '\0';
+    }
+
+private:
+    ShmRegion     region_;
+    MetricsBlock* block_ = nullptr;
+};
+
+class MetricsReader {
+public:
+    explicit MetricsReader(const std::string& shmName = "/simcore_metrics")
+        : region_(ShmRegion::open(shmName)) {
+        if (region_.valid() && region_.size() >= sizeof(MetricsBlock)) {
+            auto* b = static_cast<const MetricsBlock*>(region_.data());
+            if (b->magic == MetricsBlock::kMagic && b->version == MetricsBlock::kVersion)
+                block_ = b;
+        }
+    }
+
+    bool ok() const { return block_ != nullptr; }
+    double hz() const { return block_ ? block_->hz : 0.0; }
+
+    // Copy a consistent snapshot; false if the writer kept it busy.
+    bool read(MetricsBlock::Payload& out, int maxRetries = 1000) const {
+        if (!block_) return false;
+        for (int i = 0; i < maxRetries; ++i) {
+            std::uint32_t s1 = block_->seq.load(std::memory_order_acquire);
+            if (s1 & 1u) continue;
+            std::memcpy(static_cast<void*>(&out), &block_->data, sizeof(out));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            std::uint32_t s2 = block_->seq.load(std::memory_order_relaxed);
+            if (s1 == s2) return true;
+        }
+        return false;
+    }
+
+private:
+    ShmRegion           region_;
+    const MetricsBlock* block_ = nullptr;
+};
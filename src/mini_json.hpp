@@ -0,0 +1,200 @@
+#pragma once
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Minimal JSON DOM for tool-side file formats (profiles, benchmark
+// results). Not for hot paths: parse once, walk, discard.
+class Json {
+public:
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Json() = default;
+
+    Type type() const { return type_; }
+    bool isNull()   const { return type_ == Type::Null; }
+    bool isNumber() const { return type_ == Type::Number; }
+    bool isString() const { return type_ == Type::String; }
+    bool isArray()  const { return type_ == Type::Array; }
+    bool isObject() const { return type_ == Type::Object; }
+
+    double number(double def = 0.0) const { return type_ == Type::Number ? num_ : def; }
+    bool boolean(bool def = false) const { return type_ == Type::Bool ? bool_ : def; }
+    const std::string& str() const { return str_; }
+    std::size_t size() const { return type_ == Type::Array ? arr_.size() : obj_.size(); }
+
+    const Json& operator[](std::size_t i) const {
+        return (type_ == Type::Array && i < arr_.size()) ? arr_[i] : nullValue();
+    }
+    const Json& operator[](const std::string& key) const {
+        if (type_ != Type::Object) return nullValue();
+        auto it = obj_.find(key);
+        return it == obj_.end() ? nullValue() : it->second;
+    }
+    bool has(const std::string& key) const { return type_ == Type::Object && obj_.count(key); }
+    const std::vector<Json>& array() const { return arr_; }
+    const std::map<std::string, Json>& object() const { return obj_; }
+
+    static bool parse(std::string_view text, Json& out, std::string* err = nullptr) {
+        Parser p{text, 0};
+        p.ws();
+        if (!p.value(out) || (p.ws(), p.pos != text.size())) {
+            if (err) *err = "JSON parse error at offset " + std::to_string(p.pos);
+            return false;
+        }
+        return true;
+    }
+
+    static bool parseFile(const std::string& path, Json& out, std::string* err = nullptr) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) { if (err) *err = "cannot open " + path; return false; }
+        std::string text;
+        char buf[8192];
+        std::size_t n;
+        while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0) text.append(buf, n);
+        std::fclose(f);
+        return parse(text, out, err);
+    }
+
+    static std::string escape(std::string_view s) {
+        std::string o;
+        o.reserve(s.size() + 2);
+        for (char c : s) {
+            switch (c) {
+                case '"':  o += "\\\""; break;
+                case '\\': o += "\\\\"; break;
+                case '\n': o += "\\n";  break;
+                case '\t': o += "\\t";  break;
+                case '\r': o += "\\r";  break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char b[8];
+                        std::snprintf(b, sizeof(b), "\\u%04x", c);
+                        o += b;
+                    } else o += c;
+            }
+        }
+        return o;
+    }
+
+private:
+    static const Json& nullValue() { static const Json n; return n; }
+
+    struct Parser {
+        std::string_view s;
+        std::size_t      pos;
+
+        void ws() { while (pos < s.size() && (s[pos]==' '||s[pos]=='\n'||s[pos]=='\r'||s[pos]=='\t')) ++pos; }
+        bool lit(std::string_view l) {
+            if (s.substr(pos, l.size()) != l) return false;
+            pos += l.size();
+            return true;
+        }
+        bool value(Json& v) {
+            if (pos >= s.size()) return false;
+            char c = s[pos];
+            if (c == '{') return object(v);
+            if (c == '[') return array(v);
+            if (c == '"') { v.type_ = Type::String; return string(v.str_); }
+            if (lit("true"))  { v.type_ = Type::Bool; v.bool_ = true;  return true; }
+            if (lit("false")) { v.type_ = Type::Bool; v.bool_ = false; return true; }
+            if (lit("null"))  { v.type_ = Type::Null; return true; }
+            return number(v);
+        }
+        bool number(Json& v) {
+            std::string tmp(s.substr(pos, std::min<std::size_t>(64, s.size() - pos)));
+            char* end = nullptr;
+            double d = std::strtod(tmp.c_str(), &end);
+            if (end == tmp.c_str()) return false;
+            pos += static_cast<std::size_t>(end - tmp.c_str());
+            v.type_ = Type::Number;
+            v.num_ = d;
+            return true;
+        }
+        bool string(std::string& out) {
+            ++pos; // opening quote
+            while (pos < s.size() && s[pos] != '"') {
+                char c = s[pos++];
+                if (c != '\\') { out += c; continue; }
+                if (pos >= s.size()) return false;
+                char e = s[pos++];
+                switch (e) {
+                    case 'n': out += '\n'; break;
+                    case 't': out += '\t'; break;
+                    case 'r': out += '\r'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'u': {
+                        if (pos + 4 > s.size()) return false;
+                        unsigned cp = static_cast<unsigned>(
+                            std::strtoul(std::string(s.substr(pos, 4)).c_str(), nullptr, 16));
+                        pos += 4;
+                        if (cp < 0x80) out += static_cast<char>(cp);
+                        else if (cp < 0x800) {
+                            out += static_cast<char>(0xC0 | (cp >> 6));
+                            out += static_cast<char>(0x80 | (cp & 0x3F));
+                        } else {
+                            out += static_cast<char>(0xE0 | (cp >> 12));
+                            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                            out += static_cast<char>(0x80 | (cp & 0x3F));
+                        }
+                        break;
+                    }
+                    default: out += e;
+                }
+            }
+            if (pos >= s.size()) return false;
+            ++pos; // closing quote
+            return true;
+        }
+        bool array(Json& v) {
+            v.type_ = Type::Array;
+            ++pos; ws();
+            if (pos < s.size() && s[pos] == ']') { ++pos; return true; }
+            for (;;) {
+                Json item;
+                ws();
+                if (!value(item)) return false;
+                v.arr_.push_back(std::move(item));
+                ws();
+                if (pos >= s.size()) return false;
+                if (s[pos] == ',') { ++pos; continue; }
+                if (s[pos] == ']') { ++pos; return true; }
+                return false;
+            }
+        }
+        bool object(Json& v) {
+            v.type_ = Type::Object;
+            ++pos; ws();
+            if (pos < s.size() && s[pos] == '}') { ++pos; return true; }
+            for (;;) {
+                ws();
+                if (pos >= s.size() || s[pos] != '"') return false;
+                std::string key;
+                if (!string(key)) return false;
+                ws();
+                if (pos >= s.size() || s[pos] != ':') return false;
+                ++pos; ws();
+                Json item;
+                if (!value(item)) return false;
+                v.obj_[std::move(key)] = std::move(item);
+                ws();
+                if (pos >= s.size()) return false;
+                if (s[pos] == ',') { ++pos; continue; }
+                if (s[pos] == '}') { ++pos; return true; }
+                return false;
+            }
+        }
+    };
+
+    Type                        type_ = Type::Null;
+    bool                        bool_ = false;
+    double                      num_  = 0.0;
+    std::string                 str_;
+    std::vector<Json>           arr_;
+    std::map<std::string, Json> obj_;
+};
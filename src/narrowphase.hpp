@@ -0,0 +1,451 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "SimCore.hpp"
+#include "broadphase.hpp"
+#include "rigid_body.hpp"
+#include "simd.hpp"
+
+// Contact generation for oriented boxes: box/box over the broad-phase pair
+// list and box/ground-plane over all dynamic bodies.
+//
+// Per work item (a fixed block of pairs or of bodies):
+//   SAT      one SIMD loop over the block: gather both poses, test the 15
+//            separating axes, keep the axis of least penetration (faces
+//            preferred over edges within a tolerance)
+//   manifold scalar, only for overlapping pairs: clip the incident face
+//            against the reference face (up to 4 points kept) or take the
+//            closest points of the two edges
+// Contacts go into per-block buffers that keep their capacity from frame to
+// frame and are concatenated in block order, so the list is deterministic.
+// contacts() is valid until the next frame's narrow phase.
+//
+// The SAT loop gathers poses through the pair list; GCC vectorizes that
+// from SSE4.1 up (ENABLE_NATIVE_ARCH), on baseline x86-64 it stays scalar.
+class NarrowPhase {
+public:
+    static constexpr std::uint32_t kGround = 0xFFFFFFFFu;
+
+    struct Contact {
+        std::uint32_t a, b;    // bodies; b == kGround for the ground plane
+        double nx, ny, nz;     // unit normal, from a towards b
+        double px, py, pz;     // world point, midway between the surfaces
+        double depth;          // penetration, > 0
+    };
+
+    struct Config {
+        std::size_t blockSize = 256;     // pairs (or bodies) per work item
+        bool   ground         = true;    // plane n . x = groundOffset
+        double groundNormal[3] = {0.0, 0.0, 1.0};
+        double groundOffset   = 0.0;
+    };
+
+    NarrowPhase(const RigidBodySet& bodies, const BroadPhase& broad, const Config& cfg)
+        : hx(bodies.size(), 0.5), hy(bodies.size(), 0.5), hz(bodies.size(), 0.5),
+          bodies_(bodies), broad_(broad), cfg_(cfg) {
+        cfg_.blockSize = std::max<std::size_t>(1, cfg_.blockSize);
+        const double* n = cfg_.groundNormal;
+        const double len = std::sqrt(n[0]*n[0] + n[1]*n[1] + n[2]*n[2]);
+        for (double& c : cfg_.groundNormal) c = len > 0.0 ? c / len : 0.0;
+        bodyBlocks_ = cfg_.ground ? (bodies.size() + cfg_.blockSize - 1) / cfg_.blockSize : 0;
+        planeSep_.resize(bodies.size());
+    }
+    NarrowPhase(const RigidBodySet& bodies, const BroadPhase& broad)
+        : NarrowPhase(bodies, broad, Config{}) {}
+
+    // Box half extents along body x, y, z.
+    std::vector<double> hx, hy, hz;
+
+    const Config& config() const { return cfg_; }
+    std::size_t workItems() const { return pairBlocks_ + bodyBlocks_; }
+    const std::vector<Contact>& contacts() const { return contacts_; }
+
+    // World AABBs of bodies [b, e) into the broad phase's box columns.
+    void writeBounds(BroadPhase& bp, std::size_t b, std::size_t e) const {
+        const double* px = bodies_.px.data(); const double* py = bodies_.py.data();
+        const double* pz = bodies_.pz.data();
+        const double* qw = bodies_.qw.data(); const double* qx = bodies_.qx.data();
+        const double* qy = bodies_.qy.data(); const double* qz = bodies_.qz.data();
+        const double* ex = hx.data(); const double* ey = hy.data(); const double* ez = hz.data();
+        double* lx = bp.minX.data(); double* ly = bp.minY.data(); double* lz = bp.minZ.data();
+        double* ux = bp.maxX.data(); double* uy = bp.maxY.data(); double* uz = bp.maxZ.data();
+        SIMCORE_SIMD_LOOP
+        for (std::size_t i = b; i < e; ++i) {
+            const Frame f = frameOf(qw[i], qx[i], qy[i], qz[i]);
+            const double e3[3] = {ex[i], ey[i], ez[i]};
+            double r[3];
+            SIMCORE_UNROLL
+            for (int c = 0; c < 3; ++c)
+                r[c] = std::fabs(f.ax[0][c]) * e3[0] + std::fabs(f.ax[1][c]) * e3[1]
+                     + std::fabs(f.ax[2][c]) * e3[2];
+            lx[i] = px[i] - r[0]; ly[i] = py[i] - r[1]; lz[i] = pz[i] - r[2];
+            ux[i] = px[i] + r[0]; uy[i] = py[i] + r[1]; uz[i] = pz[i] + r[2];
+        }
+    }
+
+    // Registers the narrow phase as one phase after the broad phase; the
+    // work-item count follows the pair count every frame. Returns its index.
+    std::size_t install(SimCore& sim, const std::string& name = "NarrowPhase") {
+        const std::size_t ph = sim.addPhase(name);
+        sim.setPhaseChunkSize(ph, 1);
+        sim.addSerialSubsystem(ph, [this, &sim, ph](std::int64_t, SimCore::Seconds){
+            begin();
+            sim.setPhaseElementCount(ph, workItems());
+        });
+        sim.addParallelRangeTask(ph, [this](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            for (std::size_t k = b; k < e; ++k) process(k);
+        });
+        sim.addReductionTask(ph, [this](std::int64_t, SimCore::Seconds){ merge(); });
+        return ph;
+    }
+
+    // The same steps inline, for use outside SimCore and in tests.
+    void update() {
+        begin();
+        for (std::size_t k = 0; k < workItems(); ++k) process(k);
+        merge();
+    }
+
+private:
+    // Body axes in world (rows of the rotation's transpose).
+    struct Frame { double ax[3][3]; };
+    struct Box   { double p[3]; Frame f; double e[3]; };
+
+    // Within this much (relative, then absolute) a face axis is kept over a
+    // deeper B face or edge axis; stops manifolds flickering between them.
+    static constexpr double kRelTol = 0.95;
+    static constexpr double kAbsTol = 1e-3;
+
+    SIMCORE_SIMD_INLINE static Frame frameOf(double w, double x, double y, double z) {
+        Frame f;
+        f.ax[0][0] = 1.0 - 2.0*(y*y + z*z); f.ax[0][1] = 2.0*(x*y + w*z); f.ax[0][2] = 2.0*(x*z - w*y);
+        f.ax[1][0] = 2.0*(x*y - w*z); f.ax[1][1] = 1.0 - 2.0*(x*x + z*z); f.ax[1][2] = 2.0*(y*z + w*x);
+        f.ax[2][0] = 2.0*(x*z + w*y); f.ax[2][1] = 2.0*(y*z - w*x); f.ax[2][2] = 1.0 - 2.0*(x*x + y*y);
+        return f;
+    }
+
+    static double dot(const double* a, const double* b) { return a[0]*b[0] + a[1]*b[1] + a[2]*b[2]; }
+
+    Box box(std::uint32_t i) const {
+        const RigidBodySet& r = bodies_;
+        return Box{{r.px[i], r.py[i], r.pz[i]}, frameOf(r.qw[i], r.qx[i], r.qy[i], r.qz[i]),
+                   {hx[i], hy[i], hz[i]}};
+    }
+
+    void begin() {
+        const std::size_t n = broad_.pairs().size();
+        pairBlocks_ = (n + cfg_.blockSize - 1) / cfg_.blockSize;
+        axis_.resize(n);
+        depth_.resize(n);
+        buffers_.resize(std::max(buffers_.size(), workItems()));
+    }
+
+    void process(std::size_t k) {
+        auto& out = buffers_[k];
+        out.clear();
+        if (k < pairBlocks_) {
+            const std::size_t b = k * cfg_.blockSize;
+            const std::size_t e = std::min(broad_.pairs().size(), b + cfg_.blockSize);
+            separatingAxes(b, e);
+            const BroadPhase::Pair* pr = broad_.pairs().data();
+            for (std::size_t i = b; i < e; ++i)
+                if (axis_[i] >= 0) manifold(pr[i].a, pr[i].b, axis_[i], depth_[i], out);
+        } else {
+            const std::size_t b = (k - pairBlocks_) * cfg_.blockSize;
+            const std::size_t e = std::min(bodies_.size(), b + cfg_.blockSize);
+            planeSeparation(b, e);
+            for (std::size_t i = b; i < e; ++i)
+                if (planeSep_[i] < 0.0) groundContacts(static_cast<std::uint32_t>(i), out);
+        }
+    }
+
+    // SAT for pairs [b, e). axis_: 0..2 faces of a, 3..5 faces of b,
+    // 6 + 3i + j the edge pair (a_i x b_j), -1 separated or both static.
+    // depth_: penetration along that axis.
+    void separatingAxes(std::size_t b, std::size_t e) {
+        const BroadPhase::Pair* pr = broad_.pairs().data();
+        const RigidBodySet& r = bodies_;
+        const double* px = r.px.data(); const double* py = r.py.data(); const double* pz = r.pz.data();
+        const double* qw = r.qw.data(); const double* qx = r.qx.data();
+        const double* qy = r.qy.data(); const double* qz = r.qz.data();
+        const double* im = r.invMass.data();
+        const double* ex = hx.data(); const double* ey = hy.data(); const double* ez = hz.data();
+        int* axis = axis_.data();
+        double* depth = depth_.data();
+        SIMCORE_SIMD_LOOP
+        for (std::size_t i = b; i < e; ++i) {
+            const std::uint32_t ia = pr[i].a, ib = pr[i].b;
+            const Frame A = frameOf(qw[ia], qx[ia], qy[ia], qz[ia]);
+            const Frame B = frameOf(qw[ib], qx[ib], qy[ib], qz[ib]);
+            const double ea[3] = {ex[ia], ey[ia], ez[ia]};
+            const double eb[3] = {ex[ib], ey[ib], ez[ib]};
+            const double d[3]  = {px[ib] - px[ia], py[ib] - py[ia], pz[ib] - pz[ia]};
+            // R = A^T B; the epsilon keeps near-parallel edges from
+            // producing a false separation.
+            double R[3][3], AR[3][3], t[3];
+            SIMCORE_UNROLL
+            for (int m = 0; m < 3; ++m) {
+                t[m] = d[0]*A.ax[m][0] + d[1]*A.ax[m][1] + d[2]*A.ax[m][2];
+                SIMCORE_UNROLL
+                for (int n = 0; n < 3; ++n) {
+                    R[m][n]  = A.ax[m][0]*B.ax[n][0] + A.ax[m][1]*B.ax[n][1] + A.ax[m][2]*B.ax[n][2];
+                    AR[m][n] = std::fabs(R[m][n]) + 1e-12;
+                }
+            }
+            double best = -1e300, sepMax = -1e300;
+            int code = 0;
+            SIMCORE_UNROLL
+            for (int m = 0; m < 3; ++m) {
+                const double s = std::fabs(t[m]) - (ea[m] + eb[0]*AR[m][0] + eb[1]*AR[m][1] + eb[2]*AR[m][2]);
+                code = s > best ? m : code;
+                best = simd::max(best, s);
+            }
+            SIMCORE_UNROLL
+            for (int n = 0; n < 3; ++n) {
+                const double tb = t[0]*R[0][n] + t[1]*R[1][n] + t[2]*R[2][n];
+                const double s  = std::fabs(tb) - (ea[0]*AR[0][n] + ea[1]*AR[1][n] + ea[2]*AR[2][n] + eb[n]);
+                const bool take = s > kRelTol * best + kAbsTol;
+                code = take ? 3 + n : code;
+                best = take ? s : best;
+                sepMax = simd::max(sepMax, s);
+            }
+            sepMax = simd::max(sepMax, best);
+            const double face = best;
+            SIMCORE_UNROLL
+            for (int m = 0; m < 3; ++m) {
+                SIMCORE_UNROLL
+                for (int n = 0; n < 3; ++n) {
+                    const int m1 = (m + 1) % 3, m2 = (m + 2) % 3;
+                    const int n1 = (n + 1) % 3, n2 = (n + 2) % 3;
+                    const double len  = std::sqrt(simd::max(1.0 - R[m][n]*R[m][n], 0.0));
+                    const double dist = std::fabs(t[m2]*R[m1][n] - t[m1]*R[m2][n]);
+                    const double rad  = ea[m1]*AR[m2][n] + ea[m2]*AR[m1][n]
+                                      + eb[n1]*AR[m][n2] + eb[n2]*AR[m][n1];
+                    const bool valid  = len > 1e-6;
+                    const double s    = valid ? (dist - rad) / simd::max(len, 1e-6) : -1e300;
+                    const bool take   = (s > kRelTol * face + kAbsTol) & (s > best);
+                    code = take ? 6 + 3*m + n : code;
+                    best = take ? s : best;
+                    sepMax = simd::max(sepMax, s);
+                }
+            }
+            // Bitwise ops: short-circuit would be control flow in the loop.
+            const bool skip = (sepMax > 0.0) | ((im[ia] <= 0.0) & (im[ib] <= 0.0));
+            axis[i]  = skip ? -1 : code;
+            depth[i] = -best;
+        }
+    }
+
+    // Lowest point of each box relative to the ground; >= 0 means no contact.
+    void planeSeparation(std::size_t b, std::size_t e) {
+        const RigidBodySet& r = bodies_;
+        const double* px = r.px.data(); const double* py = r.py.data(); const double* pz = r.pz.data();
+        const double* qw = r.qw.data(); const double* qx = r.qx.data();
+        const double* qy = r.qy.data(); const double* qz = r.qz.data();
+        const double* im = r.invMass.data();
+        const double* ex = hx.data(); const double* ey = hy.data(); const double* ez = hz.data();
+        const double n0 = cfg_.groundNormal[0], n1 = cfg_.groundNormal[1], n2 = cfg_.groundNormal[2];
+        const double off = cfg_.groundOffset;
+        double* sep = planeSep_.data();
+        SIMCORE_SIMD_LOOP
+        for (std::size_t i = b; i < e; ++i) {
+            const Frame f = frameOf(qw[i], qx[i], qy[i], qz[i]);
+            const double reach = ex[i] * std::fabs(n0*f.ax[0][0] + n1*f.ax[0][1] + n2*f.ax[0][2])
+                               + ey[i] * std::fabs(n0*f.ax[1][0] + n1*f.ax[1][1] + n2*f.ax[1][2])
+                               + ez[i] * std::fabs(n0*f.ax[2][0] + n1*f.ax[2][1] + n2*f.ax[2][2]);
+            const double s = n0*px[i] + n1*py[i] + n2*pz[i] - off - reach;
+            sep[i] = im[i] > 0.0 ? s : 1.0;
+        }
+    }
+
+    // Every corner below the plane, projected half-way up to the surface.
+    void groundContacts(std::uint32_t i, std::vector<Contact>& out) const {
+        const Box x = box(i);
+        const double* n = cfg_.groundNormal;
+        const double base = dot(n, x.p) - cfg_.groundOffset;
+        const double h[3] = {x.e[0] * dot(n, x.f.ax[0]), x.e[1] * dot(n, x.f.ax[1]),
+                             x.e[2] * dot(n, x.f.ax[2])};
+        for (int c = 0; c < 8; ++c) {
+            const double sg[3] = {(c & 1) ? 1.0 : -1.0, (c & 2) ? 1.0 : -1.0, (c & 4) ? 1.0 : -1.0};
+            const double s = base + sg[0] * h[0] + sg[1] * h[1] + sg[2] * h[2];
+            if (s >= 0.0) continue;
+            double p[3];
+            for (int k = 0; k < 3; ++k)
+                p[k] = x.p[k] + sg[0] * x.e[0] * x.f.ax[0][k] + sg[1] * x.e[1] * x.f.ax[1][k]
+                              + sg[2] * x.e[2] * x.f.ax[2][k];
+            out.push_back(Contact{i, kGround, -n[0], -n[1], -n[2],
+                                  p[0] - 0.5*s*n[0], p[1] - 0.5*s*n[1], p[2] - 0.5*s*n[2], -s});
+        }
+    }
+
+    void manifold(std::uint32_t a, std::uint32_t b, int code, double depth,
+                  std::vector<Contact>& out) const {
+        const Box A = box(a), B = box(b);
+        if (code < 3)      faceContacts(A, B, code, a, b, false, out);
+        else if (code < 6) faceContacts(B, A, code - 3, a, b, true, out);
+        else               edgeContact(A, B, (code - 6) / 3, (code - 6) % 3, depth, a, b, out);
+    }
+
+    // Reference face `f` of box R against the most anti-parallel face of I.
+    // `flip`: R is pair member b, so the stored normal is reversed.
+    void faceContacts(const Box& R, const Box& I, int f, std::uint32_t a, std::uint32_t b,
+                      bool flip, std::vector<Contact>& out) const {
+        double d[3], n[3];
+        for (int k = 0; k < 3; ++k) d[k] = I.p[k] - R.p[k];
+        const double sgn = dot(d, R.f.ax[f]) >= 0.0 ? 1.0 : -1.0;
+        for (int k = 0; k < 3; ++k) n[k] = sgn * R.f.ax[f][k];   // R -> I
+
+        int inc = 0;
+        double bestDot = -1.0;
+        for (int k = 0; k < 3; ++k) {
+            const double c = std::fabs(dot(I.f.ax[k], n));
+            if (c > bestDot) { bestDot = c; inc = k; }
+        }
+        const double is = dot(I.f.ax[inc], n) > 0.0 ? -1.0 : 1.0;
+        const int u = (inc + 1) % 3, v = (inc + 2) % 3;
+        double poly[8][3], tmp[8][3];
+        int count = 4;
+        for (int c = 0; c < 4; ++c) {
+            const double su = (c == 0 || c == 3) ? 1.0 : -1.0;   // counter-clockwise
+            const double sv = (c < 2) ? 1.0 : -1.0;
+            for (int k = 0; k < 3; ++k)
+                poly[c][k] = I.p[k] + is * I.e[inc] * I.f.ax[inc][k]
+                           + su * I.e[u] * I.f.ax[u][k] + sv * I.e[v] * I.f.ax[v][k];
+        }
+        // Clip against the four side planes of the reference face.
+        for (int side = 0; side < 4 && count > 0; ++side) {
+            const int ax = (f + 1 + side / 2) % 3;
+            const double s = (side & 1) ? -1.0 : 1.0;
+            const double off = s * dot(R.p, R.f.ax[ax]) + R.e[ax];
+            auto dist = [&](const double* p) { return s * dot(p, R.f.ax[ax]) - off; };
+            int m = 0;
+            for (int c = 0; c < count; ++c) {
+                const double* p = poly[c];
+                const double* q = poly[(c + 1) % count];
+                const double dp = dist(p), dq = dist(q);
+                // One predicate for both tests: a convex polygon then crosses
+                // each plane at most twice and stays within 8 points.
+                const bool inP = dp <= 0.0, inQ = dq <= 0.0;
+                if (inP && m < 8) { std::copy(p, p + 3, tmp[m]); ++m; }
+                if (inP != inQ && m < 8) {
+                    const double t = dp / (dp - dq);
+                    for (int k = 0; k < 3; ++k) tmp[m][k] = p[k] + t * (q[k] - p[k]);
+                    ++m;
+                }
+            }
+            count = m;
+            std::copy(&tmp[0][0], &tmp[0][0] + 3 * count, &poly[0][0]);
+        }
+
+        Contact pts[8];
+        int kept = 0;
+        const double fn = flip ? -1.0 : 1.0;
+        const double refD = dot(R.p, n) + R.e[f];
+        for (int c = 0; c < count; ++c) {
+            const double s = dot(poly[c], n) - refD;
+            if (s > 0.0) continue;
+            pts[kept++] = Contact{a, b, fn * n[0], fn * n[1], fn * n[2],
+                                  poly[c][0] - 0.5*s*n[0], poly[c][1] - 0.5*s*n[1],
+                                  poly[c][2] - 0.5*s*n[2], -s};
+        }
+        if (kept > 4) kept = reduce(pts, kept, n);
+        out.insert(out.end(), pts, pts + kept);
+    }
+
+    // Keeps 4 of `count` coplanar points: the deepest, the farthest from it,
+    // then the two spanning the largest triangles on either side.
+    static int reduce(Contact* pts, int count, const double* n) {
+        auto pos = [](const Contact& c, double* p) { p[0] = c.px; p[1] = c.py; p[2] = c.pz; };
+        auto sub = [](const double* x, const double* y, double* r) {
+            r[0] = x[0] - y[0]; r[1] = x[1] - y[1]; r[2] = x[2] - y[2];
+        };
+        int i0 = 0;
+        for (int c = 1; c < count; ++c) if (pts[c].depth > pts[i0].depth) i0 = c;
+        double p0[3], p1[3], pc[3], r[3];
+        pos(pts[i0], p0);
+        int i1 = i0;
+        double far = -1.0;
+        for (int c = 0; c < count; ++c) {
+            pos(pts[c], pc); sub(pc, p0, r);
+            const double d2 = dot(r, r);
+            if (d2 > far) { far = d2; i1 = c; }
+        }
+        pos(pts[i1], p1);
+        double e[3];
+        sub(p1, p0, e);
+        int i2 = i0, i3 = i0;
+        double hi = 0.0, lo = 0.0;
+        for (int c = 0; c < count; ++c) {
+            pos(pts[c], pc); sub(pc, p0, r);
+            const double cr[3] = {e[1]*r[2] - e[2]*r[1], e[2]*r[0] - e[0]*r[2], e[0]*r[1] - e[1]*r[0]};
+            const double area = dot(cr, n);
+            if (area > hi) { hi = area; i2 = c; }
+            if (area < lo) { lo = area; i3 = c; }
+        }
+        const int idx[4] = {i0, i1, i2, i3};
+        Contact keep[4];
+        int m = 0;
+        for (int q = 0; q < 4; ++q) {
+            bool dup = false;
+            for (int j = 0; j < q; ++j) dup = dup || idx[j] == idx[q];
+            if (!dup) keep[m++] = pts[idx[q]];
+        }
+        std::copy(keep, keep + m, pts);
+        return m;
+    }
+
+    // Closest points of the supporting edges along A axis i and B axis j.
+    void edgeContact(const Box& A, const Box& B, int i, int j, double depth,
+                     std::uint32_t a, std::uint32_t b, std::vector<Contact>& out) const {
+        const double* u = A.f.ax[i];
+        const double* v = B.f.ax[j];
+        double n[3] = {u[1]*v[2] - u[2]*v[1], u[2]*v[0] - u[0]*v[2], u[0]*v[1] - u[1]*v[0]};
+        const double len = std::sqrt(dot(n, n));
+        double d[3];
+        for (int k = 0; k < 3; ++k) d[k] = B.p[k] - A.p[k];
+        const double sgn = dot(n, d) >= 0.0 ? 1.0 / len : -1.0 / len;
+        for (double& c : n) c *= sgn;                             // A -> B
+        double pa[3], pb[3];
+        for (int k = 0; k < 3; ++k) { pa[k] = A.p[k]; pb[k] = B.p[k]; }
+        for (int m = 0; m < 3; ++m) {
+            const double sa = (m == i) ? 0.0 : (dot(n, A.f.ax[m]) > 0.0 ? A.e[m] : -A.e[m]);
+            const double sb = (m == j) ? 0.0 : (dot(n, B.f.ax[m]) > 0.0 ? -B.e[m] : B.e[m]);
+            for (int k = 0; k < 3; ++k) { pa[k] += sa * A.f.ax[m][k]; pb[k] += sb * B.f.ax[m][k]; }
+        }
+        double w[3];
+        for (int k = 0; k < 3; ++k) w[k] = pa[k] - pb[k];
+        const double uv = dot(u, v), uw = dot(u, w), vw = dot(v, w);
+        const double den = std::max(1.0 - uv * uv, 1e-12);
+        const double s = std::clamp((uv * vw - uw) / den, -A.e[i], A.e[i]);
+        const double t = std::clamp(s * uv + vw, -B.e[j], B.e[j]);
+        out.push_back(Contact{a, b, n[0], n[1], n[2],
+                              0.5 * (pa[0] + s*u[0] + pb[0] + t*v[0]),
+                              0.5 * (pa[1] + s*u[1] + pb[1] + t*v[1]),
+                              0.5 * (pa[2] + s*u[2] + pb[2] + t*v[2]), depth});
+    }
+
+    void merge() {
+        std::size_t total = 0;
+        for (std::size_t k = 0; k < workItems(); ++k) total += buffers_[k].size();
+        contacts_.resize(total);
+        auto it = contacts_.begin();
+        for (std::size_t k = 0; k < workItems(); ++k)
+            it = std::copy(buffers_[k].begin(), buffers_[k].end(), it);
+    }
+
+    const RigidBodySet& bodies_;
+    const BroadPhase&   broad_;
+    Config              cfg_;
+    std::size_t         pairBlocks_ = 0;
+    std::size_t         bodyBlocks_ = 0;
+
+    // Frame-transient: sized on demand, never shrunk.
+    std::vector<int>    axis_;
+    std::vector<double> depth_;
+    std::vector<double> planeSep_;
+    std::vector<std::vector<Contact>> buffers_;   // per work item
+    std::vector<Contact> contacts_;
+};
@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SimCore.hpp"
+#include "simd.hpp"
+
+// Engine torque over rpm on a uniform grid: full load and closed throttle
+// (engine braking, usually negative). Throttle blends linearly between the
+// two; outside [rpmMin, rpmMax] the end values hold.
+struct TorqueCurve {
+    double              rpmMin = 1000.0;
+    double              rpmMax = 8000.0;
+    std::vector<double> fullLoad{180.0, 240.0, 290.0, 320.0, 330.0, 320.0, 295.0, 250.0};   // N m
+    std::vector<double> closed{-15.0, -20.0, -26.0, -32.0, -38.0, -45.0, -52.0, -60.0};
+
+    bool valid() const {
+        return rpmMax > rpmMin && fullLoad.size() >= 2 && closed.size() == fullLoad.size();
+    }
+};
+
+// Batched drivetrain: engine, clutch, gearbox, final drive and a viscous
+// limited-slip differential for every car, as SoA columns.
+//
+// Two speed states per car: the engine and the driveline (gearbox input
+// side). The locked clutch is a stiff regularization (torque = stiffness *
+// engagement * slip) and the driven wheels pull on the driveline through a
+// stiff damper, both far too stiff for explicit steps at frame rate. Each
+// sub-step is therefore linearly implicit (backward Euler on the coupled
+// 2x2 system, solved in closed form). When the implied clutch torque
+// exceeds its capacity the clutch slips: the capacity torque is applied
+// explicitly and the driveline solved on its own. Both are computed and
+// selected, so the loop has no branches.
+//
+// Wheel speeds are inputs and are held over the frame's sub-steps; the
+// wheel torques written back are sub-step averages, so the chassis sees
+// the impulse the powertrain actually delivered.
+class PowertrainBatch {
+public:
+    struct Config {
+        TorqueCurve         curve;
+        std::vector<double> gearRatios{0.0, 3.2, 2.2, 1.6, 1.25, 1.0, 0.84};   // [0] neutral; < 0 reverse
+        double finalDrive       = 3.7;
+        double efficiency       = 0.95;
+        double engineInertia    = 0.20;     // kg m^2
+        double drivelineInertia = 0.05;     // at the gearbox input
+        double clutchCapacity   = 550.0;    // N m at full engagement
+        double clutchStiffness  = 5000.0;   // N m s/rad, locked-clutch regularization
+        double shaftDamping     = 2000.0;   // N m s/rad, at the gearbox input
+        double diffLocking      = 40.0;     // N m s/rad between the driven wheels
+        int    substeps         = 4;
+    };
+
+    PowertrainBatch(std::size_t cars, const Config& cfg)
+        : throttle(cars, 0.0), clutch(cars, 1.0), gear(cars, 0), wheelSpeedLeft(cars, 0.0),
+          wheelSpeedRight(cars, 0.0), engineSpeed(cars, 0.0), drivelineSpeed(cars, 0.0),
+          torqueLeft(cars, 0.0), torqueRight(cars, 0.0), clutchTorque(cars, 0.0), cfg_(cfg) {
+        cfg_.substeps = std::max(cfg_.substeps, 1);
+        if (cfg_.gearRatios.empty()) cfg_.gearRatios.push_back(0.0);
+        ratio_.resize(cfg_.gearRatios.size());
+        for (std::size_t g = 0; g < ratio_.size(); ++g) ratio_[g] = cfg_.gearRatios[g] * cfg_.finalDrive;
+        valid_ = cfg_.curve.valid() && cfg_.engineInertia > 0.0 && cfg_.drivelineInertia > 0.0;
+    }
+    explicit PowertrainBatch(std::size_t cars) : PowertrainBatch(cars, Config{}) {}
+
+    const Config& config() const { return cfg_; }
+    bool valid() const { return valid_; }
+    std::size_t size() const { return throttle.size(); }
+
+    // Inputs
+    std::vector<double>       throttle;        // [0, 1]
+    std::vector<double>       clutch;          // engagement, [0, 1]
+    std::vector<std::int32_t> gear;            // index into gearRatios, clamped
+    std::vector<double>       wheelSpeedLeft;  // driven wheels, rad/s
+    std::vector<double>       wheelSpeedRight;
+    // State
+    std::vector<double> engineSpeed;     // rad/s
+    std::vector<double> drivelineSpeed;  // rad/s at the gearbox input
+    // Outputs, averaged over the frame's sub-steps
+    std::vector<double> torqueLeft, torqueRight;   // N m at the wheels
+    std::vector<double> clutchTorque;              // N m
+
+    static double rpm(double w) { return w * (30.0 / simd::kPi); }
+
+    // Integrates cars [b, e) over dt in cfg.substeps linearly implicit steps.
+    // An invalid config (see valid()) leaves the state alone and zeroes the
+    // outputs rather than reading outside the curve.
+    void integrate(std::size_t b, std::size_t e, double dt) {
+        if (!valid_) {
+            std::fill(torqueLeft.begin() + std::ptrdiff_t(b), torqueLeft.begin() + std::ptrdiff_t(e), 0.0);
+            std::fill(torqueRight.begin() + std::ptrdiff_t(b), torqueRight.begin() + std::ptrdiff_t(e), 0.0);
+            std::fill(clutchTorque.begin() + std::ptrdiff_t(b), clutchTorque.begin() + std::ptrdiff_t(e), 0.0);
+            return;
+        }
+        const Config& c = cfg_;
+        const std::size_t pts = c.curve.fullLoad.size();
+        const double* full   = c.curve.fullLoad.data();
+        const double* closed = c.curve.closed.data();
+        const double* ratio  = ratio_.data();
+        const double rpmMin = c.curve.rpmMin;
+        const double toCell = double(pts - 1) / (c.curve.rpmMax - c.curve.rpmMin);
+        const double last   = double(pts - 1);
+        const std::int32_t topGear = static_cast<std::int32_t>(ratio_.size()) - 1;
+        const double h   = dt / c.substeps;
+        const double jeH = c.engineInertia / h, jdH = c.drivelineInertia / h;
+        const double w   = 1.0 / c.substeps;
+        // Config copied to locals: the stores below could alias members.
+        const double shaft = c.shaftDamping, stiff = c.clutchStiffness, capacity = c.clutchCapacity;
+        const double eff = c.efficiency, locking = c.diffLocking;
+        const int    substeps = c.substeps;
+
+        const double* th = throttle.data();
+        const double* cl = clutch.data();
+        const std::int32_t* gr = gear.data();
+        const double* wl = wheelSpeedLeft.data();
+        const double* wr = wheelSpeedRight.data();
+        double* we = engineSpeed.data();
+        double* wd = drivelineSpeed.data();
+        double* tl = torqueLeft.data();
+        double* tr = torqueRight.data();
+        double* tc = clutchTorque.data();
+
+        SIMCORE_SIMD_LOOP
+        for (std::size_t i = b; i < e; ++i) { tl[i] = 0.0; tr[i] = 0.0; tc[i] = 0.0; }
+
+        for (int s = 0; s < substeps; ++s) {
+            SIMCORE_SIMD_LOOP
+            for (std::size_t i = b; i < e; ++i) {
+                // Engine torque: rpm cell of the curve, blended by throttle.
+                const double f    = simd::min(simd::max((we[i] * (30.0 / simd::kPi) - rpmMin) * toCell, 0.0), last);
+                const double cell = simd::min(std::floor(f), last - 1.0);
+                const double t    = f - cell;
+                const std::int32_t k = static_cast<std::int32_t>(cell);
+                const double tFull   = full[k] + (full[k + 1] - full[k]) * t;
+                const double tClosed = closed[k] + (closed[k + 1] - closed[k]) * t;
+                const double thr = simd::min(simd::max(th[i], 0.0), 1.0);
+                const double te  = tClosed + (tFull - tClosed) * thr;
+
+                const std::int32_t g0 = gr[i] > 0 ? gr[i] : 0;
+                const double r   = ratio[g0 < topGear ? g0 : topGear];
+                const double cin = r != 0.0 ? shaft : 0.0;
+                const double ww  = 0.5 * (wl[i] + wr[i]);
+                const double eng = simd::min(simd::max(cl[i], 0.0), 1.0);
+                const double cc  = stiff * eng;
+                const double cap = capacity * eng;
+
+                // Locked: both speeds implicit through the clutch.
+                const double a11 = jeH + cc, a22 = jdH + cc + cin;
+                const double b1  = jeH * we[i] + te;
+                const double b2  = jdH * wd[i] + cin * r * ww;
+                const double det = a11 * a22 - cc * cc;
+                const double weL = (b1 * a22 + cc * b2) / det;
+                const double wdL = (a11 * b2 + cc * b1) / det;
+                const double tcL = cc * (weL - wdL);
+                // Slipping: capacity torque, driveline implicit on its own.
+                const double tcS = simd::min(simd::max(tcL, -cap), cap);
+                const double weS = we[i] + (te - tcS) / jeH;
+                const double wdS = (jdH * wd[i] + tcS + cin * r * ww) / (jdH + cin);
+                const bool   slip = std::fabs(tcL) > cap;
+
+                const double weN = simd::max(slip ? weS : weL, 0.0);   // no running backwards
+                const double wdN = slip ? wdS : wdL;
+                we[i] = weN;
+                wd[i] = wdN;
+                const double tw   = cin * (wdN - r * ww) * r * eff;
+                const double lock = locking * (wl[i] - wr[i]);
+                tl[i] += w * 0.5 * (tw - lock);
+                tr[i] += w * 0.5 * (tw + lock);
+                tc[i] += w * (slip ? tcS : tcL);
+            }
+        }
+    }
+
+    // One range task over all cars in `phase`; inputs are expected to be
+    // written by an earlier phase (or serial subsystem) of the same frame.
+    void install(SimCore& sim, std::size_t phase) {
+        sim.setPhaseElementCount(phase, size());
+        sim.addParallelRangeTask(phase, [this](std::size_t b, std::size_t e,
+                                               std::int64_t, SimCore::Seconds dt){
+            integrate(b, e, dt.count());
+        });
+    }
+
+private:
+    Config              cfg_;
+    std::vector<double> ratio_;   // gear ratio * final drive
+    bool                valid_ = false;
+};
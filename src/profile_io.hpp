@@ -0,0 +1,239 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <map>
+#include "profiler.hpp"
+#include "mini_json.hpp"
+
+// Persist Profiler::summary() as JSON and compare two runs section by
+// section (Welch's t interval on the mean, percentiles side by side).
+
+// One section of a saved profile. Independent of Profiler::Entry, whose
+// statistics are stubbed out when the profiler is compiled out (tools that
+// only read and compare files must work either way).
+struct ProfileSection {
+    std::string   name;
+    std::uint64_t count   = 0;
+    long double   totalNs = 0;
+    long double   sumSqNs = 0;
+    long double   minNs   = 0, maxNs  = 0;
+    long double   p50Ns   = 0, p90Ns  = 0, p99Ns = 0, p999Ns = 0;
+
+    long double meanNs() const { return count ? totalNs / count : 0; }
+    long double stddevNs() const {
+        if (count < 2) return 0;
+        long double n = count;
+        long double var = (sumSqNs - totalNs * totalNs / n) / (n - 1);
+        return var > 0 ? std::sqrt(var) : 0;
+    }
+};
+
+struct ProfileRun {
+    static constexpr int kVersion = 1;
+    int                         version = kVersion;
+    std::string                 label;
+    std::vector<ProfileSection> sections;
+
+    const ProfileSection* find(const std::string& name) const {
+        for (auto& e : sections) if (e.name == name) return &e;
+        return nullptr;
+    }
+};
+
+struct SectionDelta {
+    std::string   name;
+    std::uint64_t countA = 0, countB = 0;
+    double        meanA  = 0, meanB  = 0;   // ns
+    double        p99A   = 0, p99B   = 0;   // ns
+    double        deltaPct  = 0;            // (B - A) / A
+    double        ciLowPct  = 0;            // CI on deltaPct
+    double        ciHighPct = 0;
+    bool          significant = false;      // CI excludes 0 and |delta| >= minEffect
+    bool          onlyInA = false, onlyInB = false;
+};
+
+class ProfileFile {
+public:
+    // Profiler::summary() rows as saved sections.
+    static std::vector<ProfileSection> sections(const std::vector<Profiler::Entry>& rows) {
+        std::vector<ProfileSection> out;
+        out.reserve(rows.size());
+        for (const auto& e : rows)
+            out.push_back(ProfileSection{e.name, e.count, e.totalNs, e.sumSqNs, e.minNs, e.maxNs,
+                                         e.p50Ns, e.p90Ns, e.p99Ns, e.p999Ns});
+        return out;
+    }
+
+    static bool save(const std::string& path, const std::vector<Profiler::Entry>& rows,
+                     const std::string& label = {}) {
+        return save(path, sections(rows), label);
+    }
+
+    static bool save(const std::string& path, const std::vector<ProfileSection>& rows,
+                     const std::string& label = {}) {
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        std::fprintf(f, "{\n  \"format\": \"simcore-profile\",\n  \"version\": %d,\n"
+                        "  \"label\": \"%s\",\n  \"sections\": [",
+                     ProfileRun::kVersion, Json::escape(label).c_str());
+        for (std::size_t i = 0; i < rows.size(); ++i) {
+            const auto& e = rows[i];
+            std::fprintf(f, "%s\n    {\"name\": \"%s\", \"count\": %llu, \"total_ns\": %.1Lf, "
+                            "\"stddev_ns\": %.3Lf, \"min_ns\": %.1Lf, \"max_ns\": %.1Lf, "
+                            "\"p50_ns\": %.1Lf, \"p90_ns\": %.1Lf, \"p99_ns\": %.1Lf, \"p999_ns\": %.1Lf}",
+                         i ? "," : "", Json::escape(e.name).c_str(),
+                         static_cast<unsigned long long>(e.count), e.totalNs, e.stddevNs(),
+                         e.minNs, e.maxNs, e.p50Ns, e.p90Ns, e.p99Ns, e.p999Ns);
+        }
+        std::fprintf(f, "\n  ]\n}\n");
+        return std::fclose(f) == 0;
+    }
+
+    static bool load(const std::string& path, ProfileRun& out, std::string* err = nullptr) {
+        Json doc;
+        if (!Json::parseFile(path, doc, err)) return false;
+        if (doc["format"].str() != "simcore-profile") {
+            if (err) *err = path + ": not a simcore-profile file";
+            return false;
+        }
+        out.version = static_cast<int>(doc["version"].number());
+        if (out.version > ProfileRun::kVersion) {
+            if (err) *err = path + ": unsupported version " + std::to_string(out.version);
+            return false;
+        }
+        out.label = doc["label"].str();
+        out.sections.clear();
+        for (const auto& s : doc["sections"].array()) {
+            ProfileSection e;
+            e.name    = s["name"].str();
+            e.count   = static_cast<std::uint64_t>(s["count"].number());
+            e.totalNs = s["total_ns"].number();
+            // Rebuild the sum of squares from stddev; storing it raw loses
+            // the variance to cancellation once printed.
+            long double sd = s["stddev_ns"].number();
+            long double n  = static_cast<long double>(e.count);
+            if (e.count > 0)
+                e.sumSqNs = sd * sd * (n > 1 ? n - 1 : 0) + e.totalNs * e.totalNs / n;
+            e.minNs   = s["min_ns"].number();
+            e.maxNs   = s["max_ns"].number();
+            e.p50Ns   = s["p50_ns"].number();
+            e.p90Ns   = s["p90_ns"].number();
+            e.p99Ns   = s["p99_ns"].number();
+            e.p999Ns  = s["p999_ns"].number();
+            out.sections.push_back(std::move(e));
+        }
+        return true;
+    }
+
+    // Google Benchmark JSON (--benchmark_format=json) -> one section per
+    // benchmark, one sample per repetition. Aggregate rows (mean, stddev)
+    // are skipped; the raw repetitions carry the noise we need.
+    static bool fromBenchmarkJson(const Json& doc, ProfileRun& out, bool cpuTime = false,
+                                  std::string* err = nullptr) {
+        if (!doc["benchmarks"].isArray()) {
+            if (err) *err = "no \"benchmarks\" array";
+            return false;
+        }
+        std::vector<std::string> order;
+        std::map<std::string, std::vector<long double>> samples;
+        for (const auto& b : doc["benchmarks"].array()) {
+            if (b.has("run_type") && b["run_type"].str() != "iteration") continue;
+            if (b.has("error_occurred") && b["error_occurred"].boolean()) continue;
+            const std::string& name = b.has("run_name") ? b["run_name"].str() : b["name"].str();
+            const std::string& unit = b["time_unit"].str();
+            long double scale = unit == "us" ? 1e3L : unit == "ms" ? 1e6L : unit == "s" ? 1e9L : 1.0L;
+            auto& v = samples[name];
+            if (v.empty()) order.push_back(name);
+            v.push_back(static_cast<long double>(b[cpuTime ? "cpu_time" : "real_time"].number()) * scale);
+        }
+        out.version = ProfileRun::kVersion;
+        out.sections.clear();
+        for (auto& name : order) {
+            auto& v = samples[name];
+            std::sort(v.begin(), v.end());
+            auto rank = [&](double q) { return v[static_cast<std::size_t>(q * double(v.size() - 1) + 0.5)]; };
+            ProfileSection e;
+            e.name  = name;
+            e.count = v.size();
+            for (auto x : v) { e.totalNs += x; e.sumSqNs += x * x; }
+            e.minNs  = v.front();
+            e.maxNs  = v.back();
+            e.p50Ns  = rank(0.50);
+            e.p90Ns  = rank(0.90);
+            e.p99Ns  = rank(0.99);
+            e.p999Ns = rank(0.999);
+            out.sections.push_back(std::move(e));
+        }
+        return true;
+    }
+
+    // Two-sided Student t quantile (Cornish-Fisher expansion around z).
+    static double tQuantile(double confidence, double df) {
+        double p = 1.0 - (1.0 - confidence) / 2.0;
+        // Acklam-style rational approximation of the normal quantile
+        double q = p - 0.5, z;
+        if (std::fabs(q) <= 0.425) {
+            double r = 0.180625 - q * q;
+            z = q * (((((((2509.0809287301226727 * r + 33430.575583588128105) * r + 67265.770927008700853) * r
+                 + 45921.953931549871457) * r + 13731.693765509461125) * r + 1971.5909503065514427) * r
+                 + 133.14166789178437745) * r + 3.387132872796366608)
+              / (((((((5226.495278852545925 * r + 28729.085735721942674) * r + 39307.89580009271061) * r
+                 + 21213.794301586595867) * r + 5394.1960214247511077) * r + 687.1870074920579083) * r
+                 + 42.313330701600911252) * r + 1.0);
+        } else {
+            double r = std::sqrt(-std::log(1.0 - p));
+            r -= 1.6;
+            z = (((((((7.7454501427834140764e-4 * r + 0.0227238449892691845833) * r + 0.24178072517745061177) * r
+                 + 1.27045825245236838258) * r + 3.64784832476320460504) * r + 5.7694972214606914055) * r
+                 + 4.6303378461565452959) * r + 1.42343711074968357734)
+              / (((((((1.05075007164441684324e-9 * r + 5.475938084995344946e-4) * r + 0.0151986665636164571966) * r
+                 + 0.14810397642748007459) * r + 0.68976733498510000455) * r + 1.6763848301838038494) * r
+                 + 2.05319162663775882187) * r + 1.0);
+        }
+        if (!(df > 0) || df > 1e6) return z;
+        double z3 = z * z * z, z5 = z3 * z * z;
+        return z + (z3 + z) / (4 * df) + (5 * z5 + 16 * z3 + 3 * z) / (96 * df * df);
+    }
+
+    static std::vector<SectionDelta> compare(const ProfileRun& a, const ProfileRun& b,
+                                             double confidence = 0.95, double minEffectPct = 1.0) {
+        std::vector<std::string> names;
+        for (auto& e : a.sections) names.push_back(e.name);
+        for (auto& e : b.sections) names.push_back(e.name);
+        std::sort(names.begin(), names.end());
+        names.erase(std::unique(names.begin(), names.end()), names.end());
+
+        std::vector<SectionDelta> out;
+        for (auto& n : names) {
+            SectionDelta d;
+            d.name = n;
+            const auto* ea = a.find(n);
+            const auto* eb = b.find(n);
+            d.onlyInA = ea && !eb;
+            d.onlyInB = eb && !ea;
+            if (ea) { d.countA = ea->count; d.meanA = double(ea->meanNs()); d.p99A = double(ea->p99Ns); }
+            if (eb) { d.countB = eb->count; d.meanB = double(eb->meanNs()); d.p99B = double(eb->p99Ns); }
+            if (ea && eb && d.meanA > 0) {
+                double va = double(ea->stddevNs()); va *= va;
+                double vb = double(eb->stddevNs()); vb *= vb;
+                double na = double(d.countA), nb = double(d.countB);
+                double se2 = (na > 0 ? va / na : 0) + (nb > 0 ? vb / nb : 0);
+                double df = 0;
+                if (se2 > 0 && na > 1 && nb > 1)
+                    df = se2 * se2 / ((va / na) * (va / na) / (na - 1) + (vb / nb) * (vb / nb) / (nb - 1));
+                double half = tQuantile(confidence, df) * std::sqrt(se2);
+                double diff = d.meanB - d.meanA;
+                d.deltaPct  = 100.0 * diff / d.meanA;
+                d.ciLowPct  = 100.0 * (diff - half) / d.meanA;
+                d.ciHighPct = 100.0 * (diff + half) / d.meanA;
+                d.significant = (d.ciLowPct > 0 || d.ciHighPct < 0) &&
+                                std::fabs(d.deltaPct) >= minEffectPct;
+            }
+            out.push_back(std::move(d));
+        }
+        return out;
+    }
+};
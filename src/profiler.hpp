@@ -8,6 +8,11 @@
 #include <algorithm>
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <cstdint>
+#include <cmath>
+#include "histogram.hpp"
+#include "async_io.hpp"
 
 #ifdef PROF_ENABLED
 
@@ -19,6 +24,19 @@ public:
         long double totalNs = 0;
         long double minNs = 0;
         long double maxNs = 0;
+        long double sumSqNs = 0;   // for stddev / confidence intervals
+        long double p50Ns = 0;
+        long double p90Ns = 0;
+        long double p99Ns = 0;
+        long double p999Ns = 0;
+
+        long double meanNs() const { return count ? totalNs / count : 0; }
+        long double stddevNs() const {
+            if (count < 2) return 0;
+            long double n = count;
+            long double var = (sumSqNs - totalNs * totalNs / n) / (n - 1);
+            return var > 0 ? std::sqrt(var) : 0;
+        }
     };
 
     class ScopeGuard {
@@ -40,7 +58,9 @@ public:
 
     void record(const std::string& n, long double ns) {
         std::lock_guard<std::mutex> lk(m_);
-        auto &e = map_[n];
+        auto &slot = map_[n];
+        auto &e = slot.entry;
+        slot.hist.record(ns > 0 ? static_cast<std::uint64_t>(ns) : 0);
         if (e.count == 0) {
             e.name = n;
             e.minNs = e.maxNs = ns;
@@ -49,6 +69,7 @@ public:
             if (ns > e.maxNs) e.maxNs = ns;
         }
         e.totalNs += ns;
+        e.sumSqNs += ns * ns;
         ++e.count;
     }
 
@@ -56,41 +77,65 @@ public:
         std::lock_guard<std::mutex> lk(m_);
         std::vector<Entry> out;
         out.reserve(map_.size());
-        for (auto &kv : map_) out.push_back(kv.second);
+        for (auto &kv : map_) {
+            Entry e = kv.second.entry;
+            e.p50Ns  = static_cast<long double>(kv.second.hist.percentile(0.50));
+            e.p90Ns  = static_cast<long double>(kv.second.hist.percentile(0.90));
+            e.p99Ns  = static_cast<long double>(kv.second.hist.percentile(0.99));
+            e.p999Ns = static_cast<long double>(kv.second.hist.percentile(0.999));
+            out.push_back(std::move(e));
+        }
         std::sort(out.begin(), out.end(),
                   [](auto& a, auto& b){ return a.name < b.name; });
         return out;
     }
 
-    void dump() {
+    // End-of-run report: a blocking stream write, by design, since it runs
+    // after the loop on the main thread. To dump during a run, use the
+    // AsyncIO overload, which keeps the sim thread off the disk.
+    void dump(std::ostream& os = std::cout) {
         auto rows = summary();
         if (rows.empty()) return;
-        std::cout << "\n==== Profiler Summary (ns / µs / ms) ====\n";
-        std::cout << std::left << std::setw(40) << "Section"
-                  << std::right << std::setw(12) << "Count"
-                  << std::setw(14) << "Avg (µs)"
-                  << std::setw(15) << "Total (ms)"
-                  << std::setw(14) << "Min (µs)"
-                  << std::setw(14) << "Max (µs)\""
-                  << "\n";
+        os << "\n==== Profiler Summary (ns / µs / ms) ====\n";
+        os << std::left << std::setw(40) << "Section"
+           << std::right << std::setw(12) << "Count"
+           << std::setw(14) << "Avg (µs)"
+           << std::setw(15) << "Total (ms)"
+           << std::setw(14) << "Min (µs)"
+           << std::setw(14) << "Max (µs)\""
+           << std::setw(14) << "P99 (µs)"
+           << "\n";
         for (auto &e : rows) {
             long double avg = e.totalNs / (e.count ? e.count : 1);
             auto toUs = [](long double ns){ return ns / 1000.0L; };
             auto toMs = [](long double ns){ return ns / 1'000'000.0L; };
-            std::cout << std::left << std::setw(40) << e.name
-                      << std::right << std::setw(12) << e.count
-                      << std::setw(14) << std::fixed << std::setprecision(3) << toUs(avg)
-                      << std::setw(15) << std::fixed << std::setprecision(3) << toMs(e.totalNs)
-                      << std::setw(14) << std::fixed << std::setprecision(3) << toUs(e.minNs)
-                      << std::setw(14) << std::fixed << std::setprecision(3) << toUs(e.maxNs)
-                      << "\n";
+            os << std::left << std::setw(40) << e.name
+               << std::right << std::setw(12) << e.count
+               << std::setw(14) << std::fixed << std::setprecision(3) << toUs(avg)
+               << std::setw(15) << std::fixed << std::setprecision(3) << toMs(e.totalNs)
+               << std::setw(14) << std::fixed << std::setprecision(3) << toUs(e.minNs)
+               << std::setw(14) << std::fixed << std::setprecision(3) << toUs(e.maxNs)
+               << std::setw(14) << std::fixed << std::setprecision(3) << toUs(e.p99Ns)
+               << "\n";
         }
-        std::cout << "=========================================\n";
+        os << "=========================================\n";
+    }
+
+    // Same table, handed to the AsyncIO service instead of a blocking stream.
+    void dump(AsyncIO& io, AsyncIO::FileId fd) {
+        std::ostringstream os;
+        dump(os);
+        io.write(fd, os.str());
     }
 
 private:
+    struct Slot {
+        Entry        entry;
+        LogHistogram hist;
+    };
+
     mutable std::mutex m_;
-    std::unordered_map<std::string, Entry> map_;
+    std::unordered_map<std::string, Slot> map_;
 };
 
 #define PROF_CONCAT_INNER(a,b) a##b
@@ -107,10 +152,16 @@ private:
 
 class Profiler {
 public:
-    struct Entry { std::string name; std::uint64_t count=0; long double totalNs=0,minNs=0,maxNs=0; };
+    struct Entry {
+        std::string name; std::uint64_t count=0; long double totalNs=0,minNs=0,maxNs=0;
+        long double sumSqNs=0,p50Ns=0,p90Ns=0,p99Ns=0,p999Ns=0;
+        long double meanNs() const { return 0; }
+        long double stddevNs() const { return 0; }
+    };
     class ScopeGuard { public: ScopeGuard(Profiler*, std::string) {} };
     std::vector<Entry> summary() const { return {}; }
-    void dump() {}
+    void dump(std::ostream& = std::cout) {}
+    void dump(AsyncIO&, AsyncIO::FileId) {}
 };
 
 #define PROF_SCOPE(PTR, NAME) do{}while(0)
@@ -0,0 +1,304 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SimCore.hpp"
+#include "simd.hpp"
+
+// 6-DOF rigid bodies in SoA columns. Orientation is a unit quaternion
+// (body -> world); angular velocity and the principal inertia are in the
+// body frame, so the gyroscopic term is a cross product and no inertia
+// tensor is rotated. Force/torque accumulators are world-frame inputs,
+// held constant over a step and cleared after it.
+struct RigidBodySet {
+    explicit RigidBodySet(std::size_t n)
+        : px(n, 0.0), py(n, 0.0), pz(n, 0.0),
+          qw(n, 1.0), qx(n, 0.0), qy(n, 0.0), qz(n, 0.0),
+          vx(n, 0.0), vy(n, 0.0), vz(n, 0.0),
+          wx(n, 0.0), wy(n, 0.0), wz(n, 0.0),
+          fx(n, 0.0), fy(n, 0.0), fz(n, 0.0),
+          tx(n, 0.0), ty(n, 0.0), tz(n, 0.0),
+          invMass(n, 1.0), ix(n, 1.0), iy(n, 1.0), iz(n, 1.0),
+          invIx(n, 1.0), invIy(n, 1.0), invIz(n, 1.0) {}
+
+    std::size_t size() const { return px.size(); }
+
+    // mass <= 0 makes the body static (infinite mass and inertia).
+    void setMass(std::size_t i, double mass, double inertiaX, double inertiaY, double inertiaZ) {
+        const bool dyn = mass > 0.0;
+        invMass[i] = dyn ? 1.0 / mass : 0.0;
+        ix[i] = inertiaX; iy[i] = inertiaY; iz[i] = inertiaZ;
+        invIx[i] = dyn && inertiaX > 0.0 ? 1.0 / inertiaX : 0.0;
+        invIy[i] = dyn && inertiaY > 0.0 ? 1.0 / inertiaY : 0.0;
+        invIz[i] = dyn && inertiaZ > 0.0 ? 1.0 / inertiaZ : 0.0;
+    }
+    // Solid box with full extents (w, h, d) along body x, y, z.
+    void setBox(std::size_t i, double mass, double w, double h, double d) {
+        const double k = mass / 12.0;
+        setMass(i, mass, k * (h*h + d*d), k * (w*w + d*d), k * (w*w + h*h));
+    }
+
+    std::vector<double> px, py, pz;        // world position
+    std::vector<double> qw, qx, qy, qz;    // orientation, body -> world
+    std::vector<double> vx, vy, vz;        // world linear velocity
+    std::vector<double> wx, wy, wz;        // body-frame angular velocity
+    std::vector<double> fx, fy, fz;        // world force accumulator
+    std::vector<double> tx, ty, tz;        // world torque accumulator
+    std::vector<double> invMass;
+    std::vector<double> ix, iy, iz;        // principal inertia (body frame)
+    std::vector<double> invIx, invIy, invIz;
+};
+
+namespace integrators {
+
+// Everything a scheme needs for one body over one step.
+struct Body {
+    double p[3], v[3], q[4], w[3];
+};
+struct Deriv {
+    double dp[3], dv[3], dq[4], dw[3];
+};
+struct Env {
+    double acc[3];        // force/m + gravity, world
+    double torque[3];     // body frame
+    double I[3], invI[3];
+    double linDamp, angDamp;
+};
+
+SIMCORE_SIMD_INLINE Deriv derive(const Body s, const Env e) {
+    Deriv d;
+    SIMCORE_UNROLL
+    for (int k = 0; k < 3; ++k) {
+        d.dp[k] = s.v[k];
+        d.dv[k] = e.acc[k] - e.linDamp * s.v[k];
+    }
+    // q' = 1/2 q * (0, w)
+    d.dq[0] = 0.5 * (-s.q[1]*s.w[0] - s.q[2]*s.w[1] - s.q[3]*s.w[2]);
+    d.dq[1] = 0.5 * ( s.q[0]*s.w[0] + s.q[2]*s.w[2] - s.q[3]*s.w[1]);
+    d.dq[2] = 0.5 * ( s.q[0]*s.w[1] + s.q[3]*s.w[0] - s.q[1]*s.w[2]);
+    d.dq[3] = 0.5 * ( s.q[0]*s.w[2] + s.q[1]*s.w[1] - s.q[2]*s.w[0]);
+    // Euler's equations: I w' = tau - w x (I w)
+    const double lx = e.I[0]*s.w[0], ly = e.I[1]*s.w[1], lz = e.I[2]*s.w[2];
+    d.dw[0] = e.invI[0] * (e.torque[0] - (s.w[1]*lz - s.w[2]*ly)) - e.angDamp * s.w[0];
+    d.dw[1] = e.invI[1] * (e.torque[1] - (s.w[2]*lx - s.w[0]*lz)) - e.angDamp * s.w[1];
+    d.dw[2] = e.invI[2] * (e.torque[2] - (s.w[0]*ly - s.w[1]*lx)) - e.angDamp * s.w[2];
+    return d;
+}
+
+SIMCORE_SIMD_INLINE Body normalized(Body s) {
+    const double n2 = s.q[0]*s.q[0] + s.q[1]*s.q[1] + s.q[2]*s.q[2] + s.q[3]*s.q[3];
+    const double r  = 1.0 / std::sqrt(simd::max(n2, 1e-300));
+    s.q[0] *= r; s.q[1] *= r; s.q[2] *= r; s.q[3] *= r;
+    return s;
+}
+
+SIMCORE_SIMD_INLINE Body advance(const Body s, const Deriv d, double h) {
+    Body out;
+    SIMCORE_UNROLL
+    for (int k = 0; k < 3; ++k) {
+        out.p[k] = s.p[k] + h * d.dp[k];
+        out.v[k] = s.v[k] + h * d.dv[k];
+        out.w[k] = s.w[k] + h * d.dw[k];
+    }
+    SIMCORE_UNROLL
+    for (int k = 0; k < 4; ++k) out.q[k] = s.q[k] + h * d.dq[k];
+    return out;
+}
+
+// First order, symplectic for separable forces; velocity first.
+struct SemiImplicitEuler {
+    SIMCORE_SIMD_INLINE static Body step(Body s, const Env e, double dt) {
+        Deriv d = derive(s, e);
+        SIMCORE_UNROLL
+        for (int k = 0; k < 3; ++k) { s.v[k] += dt * d.dv[k]; s.w[k] += dt * d.dw[k]; }
+        d = derive(s, e);
+        SIMCORE_UNROLL
+        for (int k = 0; k < 3; ++k) s.p[k] += dt * s.v[k];
+        SIMCORE_UNROLL
+        for (int k = 0; k < 4; ++k) s.q[k] += dt * d.dq[k];
+        return normalized(s);
+    }
+};
+
+// Velocity Verlet (kick-drift-kick); second order.
+struct VelocityVerlet {
+    SIMCORE_SIMD_INLINE static Body step(Body s, const Env e, double dt) {
+        const double h = 0.5 * dt;
+        Deriv d = derive(s, e);
+        SIMCORE_UNROLL
+        for (int k = 0; k < 3; ++k) { s.v[k] += h * d.dv[k]; s.w[k] += h * d.dw[k]; }
+        d = derive(s, e);
+        SIMCORE_UNROLL
+        for (int k = 0; k < 3; ++k) s.p[k] += dt * s.v[k];
+        SIMCORE_UNROLL
+        for (int k = 0; k < 4; ++k) s.q[k] += dt * d.dq[k];
+        s = normalized(s);
+        d = derive(s, e);
+        SIMCORE_UNROLL
+        for (int k = 0; k < 3; ++k) { s.v[k] += h * d.dv[k]; s.w[k] += h * d.dw[k]; }
+        return s;
+    }
+};
+
+// Classic fourth-order Runge-Kutta on the full state.
+struct RK4 {
+    SIMCORE_SIMD_INLINE static Body step(Body s, const Env e, double dt) {
+        const Deriv k1 = derive(s, e);
+        const Deriv k2 = derive(advance(s, k1, 0.5 * dt), e);
+        const Deriv k3 = derive(advance(s, k2, 0.5 * dt), e);
+        const Deriv k4 = derive(advance(s, k3, dt), e);
+        const double c = dt / 6.0;
+        SIMCORE_UNROLL
+        for (int k = 0; k < 3; ++k) {
+            s.p[k] += c * (k1.dp[k] + 2.0*k2.dp[k] + 2.0*k3.dp[k] + k4.dp[k]);
+            s.v[k] += c * (k1.dv[k] + 2.0*k2.dv[k] + 2.0*k3.dv[k] + k4.dv[k]);
+            s.w[k] += c * (k1.dw[k] + 2.0*k2.dw[k] + 2.0*k3.dw[k] + k4.dw[k]);
+        }
+        SIMCORE_UNROLL
+        for (int k = 0; k < 4; ++k)
+            s.q[k] += c * (k1.dq[k] + 2.0*k2.dq[k] + 2.0*k3.dq[k] + k4.dq[k]);
+        return normalized(s);
+    }
+};
+
+struct Params {
+    double gravity[3]    = {0.0, 0.0, -9.81};
+    double linearDamping = 0.0;   // 1/s
+    double angularDamping = 0.0;  // 1/s
+    bool   clearForces   = true;
+};
+
+// Integrate bodies [b, e) by dt with Scheme; one SIMD loop, state gathered
+// from the columns into registers and scattered back. With an awake mask,
+// bodies whose entry is 0 (sleeping islands) step by 0 and stay put, and
+// keep their force/torque accumulators so the islands pass sees them next
+// frame and wakes the island. A per-lane step keeps the loop branch-free,
+// and the unmasked loop is a
+// separate instantiation so it does not pay for the load.
+template <class Scheme, bool kMasked>
+void integrateRange(RigidBodySet& r, const Params& prm, std::size_t b, std::size_t e, double dt,
+                    const std::uint8_t* awake) {
+    const double gx = prm.gravity[0], gy = prm.gravity[1], gz = prm.gravity[2];
+    const double ld = prm.linearDamping, ad = prm.angularDamping;
+    // Raw column pointers: through vector::operator[] the stores may alias
+    // the vectors' own data pointers and the loop no longer vectorizes.
+    double* px = r.px.data(); double* py = r.py.data(); double* pz = r.pz.data();
+    double* vx = r.vx.data(); double* vy = r.vy.data(); double* vz = r.vz.data();
+    double* qw = r.qw.data(); double* qx = r.qx.data(); double* qy = r.qy.data(); double* qz = r.qz.data();
+    double* wx = r.wx.data(); double* wy = r.wy.data(); double* wz = r.wz.data();
+    const double* fx = r.fx.data(); const double* fy = r.fy.data(); const double* fz = r.fz.data();
+    const double* tx = r.tx.data(); const double* ty = r.ty.data(); const double* tz = r.tz.data();
+    const double* im = r.invMass.data();
+    const double* ix = r.ix.data(); const double* iy = r.iy.data(); const double* iz = r.iz.data();
+    const double* jx = r.invIx.data(); const double* jy = r.invIy.data(); const double* jz = r.invIz.data();
+    SIMCORE_SIMD_LOOP
+    for (std::size_t i = b; i < e; ++i) {
+        Body s{{px[i], py[i], pz[i]}, {vx[i], vy[i], vz[i]},
+               {qw[i], qx[i], qy[i], qz[i]}, {wx[i], wy[i], wz[i]}};
+        // Static bodies (invMass 0) get no acceleration; kinematic velocities
+        // set by the caller are still integrated.
+        const double dyn = im[i] > 0.0 ? 1.0 : 0.0;
+        Env env;
+        env.acc[0] = dyn * (fx[i] * im[i] + gx);
+        env.acc[1] = dyn * (fy[i] * im[i] + gy);
+        env.acc[2] = dyn * (fz[i] * im[i] + gz);
+        // World torque into the body frame: t_b = conj(q) t q.
+        const double a = s.q[0], bx = s.q[1], by = s.q[2], bz = s.q[3];
+        const double t0 = tx[i], t1 = ty[i], t2 = tz[i];
+        const double cx = -by*t2 + bz*t1, cy = -bz*t0 + bx*t2, cz = -bx*t1 + by*t0;  // (-q_v) x t
+        env.torque[0] = t0 + 2.0*(a*cx + (-by*cz + bz*cy));
+        env.torque[1] = t1 + 2.0*(a*cy + (-bz*cx + bx*cz));
+        env.torque[2] = t2 + 2.0*(a*cz + (-bx*cy + by*cx));
+        env.I[0] = ix[i]; env.I[1] = iy[i]; env.I[2] = iz[i];
+        env.invI[0] = jx[i]; env.invI[1] = jy[i]; env.invI[2] = jz[i];
+        env.linDamp = ld * dyn;
+        env.angDamp = ad * dyn;
+        double h = dt;
+        if constexpr (kMasked) h *= double(awake[i]);
+        s = Scheme::step(s, env, h);
+        px[i] = s.p[0]; py[i] = s.p[1]; pz[i] = s.p[2];
+        vx[i] = s.v[0]; vy[i] = s.v[1]; vz[i] = s.v[2];
+        qw[i] = s.q[0]; qx[i] = s.q[1]; qy[i] = s.q[2]; qz[i] = s.q[3];
+        wx[i] = s.w[0]; wy[i] = s.w[1]; wz[i] = s.w[2];
+    }
+    if (prm.clearForces) {
+        for (auto* c : {&r.fx, &r.fy, &r.fz, &r.tx, &r.ty, &r.tz}) {
+            if constexpr (kMasked) {
+                double* f = c->data();
+                for (std::size_t i = b; i < e; ++i) f[i] = awake[i] ? 0.0 : f[i];
+            } else {
+                std::fill(c->begin() + std::ptrdiff_t(b), c->begin() + std::ptrdiff_t(e), 0.0);
+            }
+        }
+    }
+}
+
+template <class Scheme>
+void integrate(RigidBodySet& r, const Params& prm, std::size_t b, std::size_t e, double dt,
+               const std::uint8_t* awake = nullptr) {
+    if (awake) integrateRange<Scheme, true>(r, prm, b, e, dt, awake);
+    else       integrateRange<Scheme, false>(r, prm, b, e, dt, nullptr);
+}
+
+// Renormalize orientations in [b, e) (after external edits or constraint
+// solves that write quaternions directly).
+inline void normalizeQuaternions(RigidBodySet& r, std::size_t b, std::size_t e) {
+    double* w = r.qw.data(); double* x = r.qx.data();
+    double* y = r.qy.data(); double* z = r.qz.data();
+    SIMCORE_SIMD_LOOP
+    for (std::size_t i = b; i < e; ++i) {
+        const double n2 = w[i]*w[i] + x[i]*x[i] + y[i]*y[i] + z[i]*z[i];
+        const double s  = 1.0 / std::sqrt(simd::max(n2, 1e-300));
+        w[i] *= s; x[i] *= s; y[i] *= s; z[i] *= s;
+    }
+}
+
+} // namespace integrators
+
+// Runtime scheme selection over the templated kernels, installed as one
+// range task per frame.
+class RigidBodyIntegrator {
+public:
+    enum class Scheme { SemiImplicitEuler, VelocityVerlet, RK4 };
+
+    struct Config {
+        Scheme             scheme = Scheme::SemiImplicitEuler;
+        integrators::Params params{};
+    };
+
+    RigidBodyIntegrator(RigidBodySet& bodies, const Config& cfg) : bodies_(bodies), cfg_(cfg) {}
+    explicit RigidBodyIntegrator(RigidBodySet& bodies) : RigidBodyIntegrator(bodies, Config{}) {}
+
+    Config& config() { return cfg_; }
+
+    // Per-body 0/1, one entry per body (IslandBuilder::awakeMask()); bodies
+    // marked 0 are not moved. Null integrates everything.
+    void setAwakeMask(const std::vector<std::uint8_t>* mask) { awake_ = mask; }
+
+    void integrate(std::size_t b, std::size_t e, double dt) {
+        const std::uint8_t* aw = awake_ ? awake_->data() : nullptr;
+        switch (cfg_.scheme) {
+        case Scheme::SemiImplicitEuler:
+            integrators::integrate<integrators::SemiImplicitEuler>(bodies_, cfg_.params, b, e, dt, aw); break;
+        case Scheme::VelocityVerlet:
+            integrators::integrate<integrators::VelocityVerlet>(bodies_, cfg_.params, b, e, dt, aw); break;
+        case Scheme::RK4:
+            integrators::integrate<integrators::RK4>(bodies_, cfg_.params, b, e, dt, aw); break;
+        }
+    }
+
+    void install(SimCore& sim, std::size_t phase) {
+        sim.setPhaseElementCount(phase, bodies_.size());
+        sim.addParallelRangeTask(phase, [this](std::size_t b, std::size_t e,
+                                               std::int64_t, SimCore::Seconds dt){
+            integrate(b, e, dt.count());
+        });
+    }
+
+private:
+    RigidBodySet&                     bodies_;
+    Config                            cfg_;
+    const std::vector<std::uint8_t>*  awake_ = nullptr;
+};
@@ -0,0 +1,212 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "mapped_file.hpp"
+
+// Binary scenario file: ScenarioFileHeader, ScenarioColumnDesc[columnCount],
+// then each column's raw little-endian array at a 64-byte aligned offset.
+// Columns are named "<table>.<field>" (e.g. "vehicles.mass") and are laid
+// out exactly like the SoA vectors they initialise, so loading is an mmap,
+// a header/bounds check and either a zero-copy view or one memcpy per column.
+struct ScenarioFileHeader {
+    static constexpr std::uint32_t kMagic   = 0x4E454353; // "SCEN"
+    static constexpr std::uint32_t kVersion = 1;
+    std::uint32_t magic       = kMagic;
+    std::uint32_t version     = kVersion;
+    std::uint32_t columnCount = 0;
+    std::uint32_t reserved    = 0;
+    std::uint64_t fileBytes   = 0;
+    std::uint64_t checksum    = 0;    // FNV-1a over everything after the descriptors
+};
+
+struct ScenarioColumnDesc {
+    static constexpr std::size_t kNameLen = 48;
+    enum class Type : std::uint32_t { F64 = 1, F32 = 2, I64 = 3, I32 = 4, U8 = 5 };
+
+    template <class T> static constexpr Type typeOf() {
+        if constexpr (std::is_same_v<T, double>)            return Type::F64;
+        else if constexpr (std::is_same_v<T, float>)        return Type::F32;
+        else if constexpr (std::is_same_v<T, std::int64_t>) return Type::I64;
+        else if constexpr (std::is_same_v<T, std::int32_t>) return Type::I32;
+        else {
+            static_assert(std::is_same_v<T, std::uint8_t>, "unsupported scenario column type");
+            return Type::U8;
+        }
+    }
+    static std::uint32_t sizeOf(Type t) {
+        switch (t) {
+            case Type::F64: case Type::I64: return 8;
+            case Type::F32: case Type::I32: return 4;
+            case Type::U8:                  return 1;
+        }
+        return 0;
+    }
+
+    char          name[kNameLen]{};
+    Type          type     = Type::F64;
+    std::uint32_t elemSize = 0;
+    std::uint64_t count    = 0;
+    std::uint64_t offset   = 0;    // from file start, 64-byte aligned
+};
+
+inline std::uint64_t scenarioChecksum(const unsigned char* p, std::size_t n) {
+    std::uint64_t h = 1469598103934665603ull;
+    for (std::size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+class ScenarioWriter {
+public:
+    // The data is copied; the source may go away before write().
+    template <class T>
+    bool addColumn(const std::string& name, const T* data, std::size_t count) {
+        if (name.empty() || name.size() >= ScenarioColumnDesc::kNameLen || find(name)) return false;
+        Pending p;
+        p.desc.type     = ScenarioColumnDesc::typeOf<T>();
+        p.desc.elemSize = sizeof(T);
+        p.desc.count    = count;
+        std::memcpy(p.desc.name, name.data(), name.size());
+        p.bytes.resize(count * sizeof(T));
+        if (count) std::memcpy(p.bytes.data(), data, p.bytes.size());
+        cols_.push_back(std::move(p));
+        return true;
+    }
+    template <class T>
+    bool addColumn(const std::string& name, const std::vector<T>& v) { return addColumn(name, v.data(), v.size()); }
+
+    std::size_t columnCount() const { return cols_.size(); }
+
+    bool write(const std::string& path) {
+        ScenarioFileHeader h;
+        h.columnCount = static_cast<std::uint32_t>(cols_.size());
+        const std::size_t payloadStart =
+            align64(sizeof(ScenarioFileHeader) + cols_.size() * sizeof(ScenarioColumnDesc));
+        std::size_t off = payloadStart;
+        for (auto& c : cols_) {
+            c.desc.offset = off;
+            off = align64(off + c.bytes.size());
+        }
+        std::vector<unsigned char> payload(off - payloadStart, 0);
+        for (auto& c : cols_)
+            if (!c.bytes.empty())
+                std::memcpy(payload.data() + (c.desc.offset - payloadStart), c.bytes.data(), c.bytes.size());
+        h.fileBytes = off;
+        h.checksum  = scenarioChecksum(payload.data(), payload.size());
+
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        bool ok = std::fwrite(&h, sizeof(h), 1, f) == 1;
+        for (auto& c : cols_) ok = ok && std::fwrite(&c.desc, sizeof(c.desc), 1, f) == 1;
+        const std::size_t pad = payloadStart - sizeof(h) - cols_.size() * sizeof(ScenarioColumnDesc);
+        static const unsigned char zeros[64] = {};
+        ok = ok && (pad == 0 || std::fwrite(zeros, 1, pad, f) == pad);
+        ok = ok && (payload.empty() || std::fwrite(payload.data(), 1, payload.size(), f) == payload.size());
+        return std::fclose(f) == 0 && ok;
+    }
+
+private:
+    struct Pending {
+        ScenarioColumnDesc         desc;
+        std::vector<unsigned char> bytes;
+    };
+    static std::size_t align64(std::size_t n) { return (n + 63) & ~std::size_t(63); }
+    const Pending* find(const std::string& name) const {
+        for (auto& c : cols_) if (name == c.desc.name) return &c;
+        return nullptr;
+    }
+    std::vector<Pending> cols_;
+};
+
+// Read side. open() maps the file and validates the header and every column
+// descriptor; the payload checksum is only walked when asked for, since it
+// touches every page and defeats the point of mapping lazily.
+class Scenario {
+public:
+    using Column = ScenarioColumnDesc;
+
+    bool open(const std::string& path, bool verifyChecksum = false) {
+        cols_ = nullptr; count_ = 0; error_.clear();
+        file_ = MappedFile::open(path, MappedFile::Access::Random);
+        if (!file_.valid()) return fail("cannot map " + path);
+        const std::size_t size = file_.size();
+        if (size < sizeof(ScenarioFileHeader)) return fail("truncated header");
+        ScenarioFileHeader h;
+        std::memcpy(&h, file_.data(), sizeof(h));
+        if (h.magic != ScenarioFileHeader::kMagic) return fail("bad magic");
+        if (h.version != ScenarioFileHeader::kVersion) return fail("unsupported version " + std::to_string(h.version));
+        if (h.fileBytes != size) return fail("size mismatch");
+        const std::size_t descEnd = sizeof(h) + std::size_t(h.columnCount) * sizeof(Column);
+        if (h.columnCount > size / sizeof(Column) || descEnd > size) return fail("truncated column table");
+
+        cols_ = reinterpret_cast<const Column*>(file_.bytes() + sizeof(h));
+        std::size_t payloadStart = size;
+        for (std::uint32_t i = 0; i < h.columnCount; ++i) {
+            const Column& c = cols_[i];
+            if (std::memchr(c.name, 0, Column::kNameLen) == nullptr) return fail("unterminated column name");
+            const std::uint32_t es = Column::sizeOf(c.type);
+            if (es == 0 || es != c.elemSize) return fail(std::string("bad type for ") + c.name);
+            if (c.offset % 64 != 0 || c.offset < descEnd || c.offset > size) return fail(std::string("bad offset for ") + c.name);
+            if (c.count > (size - c.offset) / es) return fail(std::string("column out of bounds: ") + c.name);
+            if (c.offset < payloadStart) payloadStart = c.offset;
+        }
+        if (verifyChecksum) {
+            if (h.columnCount == 0) payloadStart = size;
+            if (scenarioChecksum(file_.bytes() + payloadStart, size - payloadStart) != h.checksum) return fail("checksum mismatch");
+        }
+        count_ = h.columnCount;
+        return true;
+    }
+
+    bool valid() const { return cols_ != nullptr; }
+    const std::string& error() const { return error_; }
+    std::size_t columnCount() const { return count_; }
+    const Column& column(std::size_t i) const { return cols_[i]; }
+
+    const Column* find(const std::string& name) const {
+        for (std::size_t i = 0; i < count_; ++i) if (name == cols_[i].name) return &cols_[i];
+        return nullptr;
+    }
+    // Element count of a column, 0 when absent; the usual way to size a phase.
+    std::size_t rows(const std::string& name) const {
+        const Column* c = find(name);
+        return c ? static_cast<std::size_t>(c->count) : 0;
+    }
+
+    // Zero-copy view into the mapping, for read-only parameters. Null when
+    // the column is missing or has a different element type.
+    template <class T>
+    const T* view(const std::string& name, std::size_t* count = nullptr) const {
+        const Column* c = find(name);
+        if (!c || c->type != Column::typeOf<T>()) return nullptr;
+        if (count) *count = static_cast<std::size_t>(c->count);
+        return reinterpret_cast<const T*>(file_.bytes() + c->offset);
+    }
+
+    // Copy into mutable simulation state (one memcpy, no per-element work).
+    template <class T>
+    bool load(const std::string& name, std::vector<T>& dst) const {
+        std::size_t n = 0;
+        const T* p = view<T>(name, &n);
+        if (!p) return false;
+        dst.resize(n);
+        if (n) std::memcpy(dst.data(), p, n * sizeof(T));
+        return true;
+    }
+
+private:
+    bool fail(std::string msg) {
+        error_ = std::move(msg);
+        cols_ = nullptr; count_ = 0;
+        file_.reset();
+        return false;
+    }
+
+    MappedFile          file_;
+    const Column*       cols_  = nullptr;
+    std::size_t         count_ = 0;
+    std::string         error_;
+};
@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define SHM_SUPPORTED 1
+#endif
+
+// RAII wrapper around a POSIX shared-memory segment (shm_open + mmap).
+// Failures leave the region invalid; callers check valid() and degrade.
+class ShmRegion {
+public:
+    ShmRegion() = default;
+    ShmRegion(const ShmRegion&) = delete;
+    ShmRegion& operator=(const ShmRegion&) = delete;
+    ShmRegion(ShmRegion&& o) noexcept { swap(o); }
+    ShmRegion& operator=(ShmRegion&& o) noexcept {
+        if (this != &o) { reset(); swap(o); }
+        return *this;
+    }
+    ~ShmRegion() { reset(); }
+
+    // Create (or truncate) a segment; the creator unlinks it on destruction.
+    static ShmRegion create(const std::string& name, std::size_t size) {
+        ShmRegion r;
+#ifdef SHM_SUPPORTED
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR, 0644);
+        if (fd < 0) return r;
+        if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return r;
+        }
+        void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) { ::shm_unlink(name.c_str()); return r; }
+        r.name_  = name;
+        r.data_  = p;
+        r.size_  = size;
+        r.owner_ = true;
+#else
+        (void)name; (void)size;
+#endif
+        return r;
+    }
+
+    // Attach to an existing segment; the mapping covers the whole object.
+    static ShmRegion open(const std::string& name, bool writable = false) {
+        ShmRegion r;
+#ifdef SHM_SUPPORTED
+        int fd = ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+        if (fd < 0) return r;
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return r; }
+        std::size_t size = static_cast<std::size_t>(st.st_size);
+        int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* p = ::mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return r;
+        r.name_ = name;
+        r.data_ = p;
+        r.size_ = size;
+#else
+        (void)name; (void)writable;
+#endif
+        return r;
+    }
+
+    bool valid() const { return data_ != nullptr; }
+    void* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    const std::string& name() const { return name_; }
+
+    void reset() {
+#ifdef SHM_SUPPORTED
+        if (data_) ::munmap(data_, size_);
+        if (owner_ && !name_.empty()) ::shm_unlink(name_.c_str());
+#endif
+        data_ = nullptr; size_ = 0; owner_ = false; name_.clear();
+    }
+
+private:
+    void swap(ShmRegion& o) noexcept {
+        std::swap(name_, o.name_);
+        std::swap(data_, o.data_);
+        std::swap(size_, o.size_);
+        std::swap(owner_, o.owner_);
+    }
+
+    std::string name_;
+    void*       data_  = nullptr;
+    std::size_t size_  = 0;
+    bool        owner_ = false;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <cmath>
+#include <cstdint>
+
+// Loop-level SIMD for SoA kernels. Kernels are written as plain loops over
+// columns marked SIMCORE_SIMD_LOOP; with -fopenmp-simd (set on the simcore
+// target) the compiler vectorizes them at the target's native width
+// regardless of its cost model. The math below is branch-free (selects
+// compile to blends) so it stays inside a vectorized loop, unlike the libm
+// calls it approximates.
+#if defined(_OPENMP) || defined(__clang__) || defined(__GNUC__)
+#define SIMCORE_SIMD_LOOP _Pragma("omp simd")
+#else
+#define SIMCORE_SIMD_LOOP
+#endif
+
+// Fixed-trip inner loops (xyz components) inside a SIMD loop body must be
+// fully unrolled before vectorization; -O2 does not do that on its own.
+#if defined(__clang__)
+#define SIMCORE_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+#define SIMCORE_UNROLL _Pragma("GCC unroll 4")
+#else
+#define SIMCORE_UNROLL
+#endif
+
+// Math helpers must inline into the loop or it stops vectorizing.
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMCORE_SIMD_INLINE inline __attribute__((always_inline))
+#else
+#define SIMCORE_SIMD_INLINE inline
+#endif
+
+namespace simd {
+
+constexpr double kPi     = 3.14159265358979323846;
+constexpr double kHalfPi = 1.57079632679489661923;
+
+// By value: std::max returns a reference, which can leave a select of
+// addresses in the loop body and block vectorization.
+SIMCORE_SIMD_INLINE double max(double a, double b) { return a > b ? a : b; }
+SIMCORE_SIMD_INLINE double min(double a, double b) { return a < b ? a : b; }
+
+// Round to nearest via the 1.5*2^52 trick (|x| < 2^51); vectorizes where
+// std::nearbyint may not. Not valid under -ffast-math (the pair folds away).
+SIMCORE_SIMD_INLINE double roundNearest(double x) {
+    constexpr double kMagic = 6755399441055744.0;
+    return (x + kMagic) - kMagic;
+}
+
+// atan on the whole real line: reduce to [0, 1] via atan(x) = pi/2 - atan(1/x),
+// then shift [tan(pi/8), 1] down by pi/4 and sum the odd series.
+// Max abs error ~5e-10 rad.
+SIMCORE_SIMD_INLINE double atan(double x) {
+    const double a   = std::fabs(x);
+    const bool   inv = a > 1.0;
+    // Divisions are taken unconditionally and selected, so the loop stays
+    // free of control flow.
+    const double ra  = 1.0 / max(a, 1.0);
+    double t = inv ? ra : a;
+    const bool   hi  = t > 0.41421356237309504880;          // tan(pi/8)
+    const double sh  = (t - 1.0) / (t + 1.0);
+    t = hi ? sh : t;
+    const double z = t * t;
+    // |t| <= tan(pi/8): series to t^19
+    double q = -1.0 / 19.0;
+    q = q * z + 1.0 / 17.0;
+    q = q * z - 1.0 / 15.0;
+    q = q * z + 1.0 / 13.0;
+    q = q * z - 1.0 / 11.0;
+    q = q * z + 1.0 / 9.0;
+    q = q * z - 1.0 / 7.0;
+    q = q * z + 1.0 / 5.0;
+    q = q * z - 1.0 / 3.0;
+    double r = t + t * z * q;
+    r = hi ? r + 0.78539816339744830962 : r;                // + pi/4
+    r = inv ? kHalfPi - r : r;
+    return std::copysign(r, x);
+}
+
+// sin with Cody-Waite reduction by pi and an odd polynomial on [-pi/2, pi/2].
+// Max abs error ~1e-12 for |x| < 1e4.
+SIMCORE_SIMD_INLINE double sin(double x) {
+    const double k  = roundNearest(x * (1.0 / kPi));
+    double y = x - k * 3.14159265160560607910;              // pi split in two parts
+    y = y - k * 1.98418714791870343106e-9;
+    const double z = y * y;
+    double p = -1.0 / 1307674368000.0;                      // -1/15!
+    p = p * z + 1.0 / 6227020800.0;
+    p = p * z - 1.0 / 39916800.0;
+    p = p * z + 1.0 / 362880.0;
+    p = p * z - 1.0 / 5040.0;
+    p = p * z + 1.0 / 120.0;
+    p = p * z - 1.0 / 6.0;
+    const double s = y + y * z * p;
+    const double half = k * 0.5;
+    const bool   odd  = half != roundNearest(half);
+    return odd ? -s : s;
+}
+
+} // namespace simd
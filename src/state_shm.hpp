@@ -0,0 +1,292 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include <new>
+#include "shm_region.hpp"
+
+// Shared-memory state output: registered SoA columns are copied into one of
+// three buffers at the end of every frame. The writer always fills the
+// buffer after `latest`, so the most recent complete frame is never
+// overwritten by the next one; each buffer has its own seqlock, so a reader
+// that falls two frames behind notices and retries. The sim never blocks.
+// Readers either work on the shared buffer in place (StateReader::view /
+// visit, no copy) or take a private copy (StateReader::read).
+struct StateBlock {
+    static constexpr std::uint32_t kMagic      = 0x53535441; // "SSTA"
+    static constexpr std::uint32_t kVersion    = 2;
+    static constexpr std::size_t   kMaxColumns = 64;
+    static constexpr std::size_t   kNameLen    = 32;
+    static constexpr std::uint32_t kBuffers    = 3;
+    static constexpr std::uint32_t kNone       = 0xFFFFFFFFu;
+
+    enum class Type : std::uint32_t { F64 = 1, F32 = 2, I64 = 3, I32 = 4, U8 = 5 };
+
+    template <class T> static constexpr Type typeOf() {
+        if constexpr (std::is_same_v<T, double>)            return Type::F64;
+        else if constexpr (std::is_same_v<T, float>)        return Type::F32;
+        else if constexpr (std::is_same_v<T, std::int64_t>) return Type::I64;
+        else if constexpr (std::is_same_v<T, std::int32_t>) return Type::I32;
+        else {
+            static_assert(std::is_same_v<T, std::uint8_t>, "unsupported state column type");
+            return Type::U8;
+        }
+    }
+
+    struct Column {
+        char          name[kNameLen]{};
+        Type          type     = Type::F64;
+        std::uint32_t elemSize = 0;
+        std::uint64_t count    = 0;
+        std::uint64_t offset   = 0;    // byte offset inside a buffer
+    };
+
+    struct alignas(64) Buffer {
+        std::atomic<std::uint32_t> seq{0};
+        std::int64_t               frame   = -1;
+        double                     simTime = 0.0;
+        std::int64_t               inputNs = 0;    // newest input consumed by the frame
+    };
+
+    std::uint32_t              magic       = kMagic;
+    std::uint32_t              version     = kVersion;
+    std::uint32_t              columnCount = 0;
+    std::uint32_t              reserved    = 0;
+    std::uint64_t              bufferBytes = 0;    // payload bytes per buffer
+    std::uint64_t              dataOffset  = 0;    // first payload, from block start
+    std::atomic<std::uint32_t> latest{kNone};
+    std::atomic<std::uint64_t> published{0};
+    Column                     columns[kMaxColumns]{};
+    Buffer                     buffers[kBuffers]{};
+
+    static std::size_t align64(std::size_t n) { return (n + 63) & ~std::size_t(63); }
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "state block counters must be lock-free to live in shared memory");
+
+class StatePublisher {
+public:
+    explicit StatePublisher(std::string shmName = "/simcore_state") : name_(std::move(shmName)) {}
+
+    // Register a column before the first publish(); its size at this point
+    // is the capacity. The vector must outlive the publisher.
+    template <class T>
+    bool addColumn(const std::string& name, const std::vector<T>& src) {
+        if (block_ || failed_ || sources_.size() >= StateBlock::kMaxColumns) return false;
+        Source s;
+        s.name     = name;
+        s.type     = StateBlock::typeOf<T>();
+        s.elemSize = sizeof(T);
+        s.count    = src.size();
+        s.data     = [&src]{ return static_cast<const void*>(src.data()); };
+        s.size     = [&src]{ return src.size(); };
+        sources_.push_back(std::move(s));
+        return true;
+    }
+
+    // Freeze the layout and create the segment (publish() does it lazily).
+    bool open() {
+        if (block_ || failed_) return block_ != nullptr;
+        std::size_t bytes = 0;
+        for (auto& s : sources_) bytes = StateBlock::align64(bytes) + s.elemSize * s.count;
+        bytes = StateBlock::align64(bytes);
+        const std::size_t dataOffset = StateBlock::align64(sizeof(StateBlock));
+        region_ = ShmRegion::create(name_, dataOffset + bytes * StateBlock::kBuffers);
+        if (!region_.valid()) { failed_ = true; return false; }
+
+        block_ = new (region_.data()) StateBlock{};
+        block_->bufferBytes = bytes;
+        block_->dataOffset  = dataOffset;
+        std::size_t off = 0;
+        for (std::size_t i = 0; i < sources_.size(); ++i) {
+            auto& c = block_->columns[i];
+            auto& s = sources_[i];
+            off = StateBlock::align64(off);
+            std::size_t len = std::min(s.name.size(), StateBlock::kNameLen - 1);
+            std::memcpy(c.name, s.name.data(), len);
+            c.type     = s.type;
+            c.elemSize = static_cast<std::uint32_t>(s.elemSize);
+            c.count    = s.count;
+            c.offset   = off;
+            off += s.elemSize * s.count;
+        }
+        block_->columnCount = static_cast<std::uint32_t>(sources_.size());
+        return true;
+    }
+
+    bool ok() const { return block_ != nullptr; }
+    const std::string& name() const { return name_; }
+
+    // Writer side, sim main thread only.
+    // inputNs tags the frame with its newest input so a downstream output
+    // stage can report end-to-end latency (see OutputLatency).
+    void publish(std::int64_t frame, double simTime, std::int64_t inputNs = 0) {
+        if (!block_ && !open()) return;
+        std::uint32_t last = block_->latest.load(std::memory_order_relaxed);
+        std::uint32_t w = (last == StateBlock::kNone) ? 0 : (last + 1) % StateBlock::kBuffers;
+        auto& b = block_->buffers[w];
+        std::uint32_t s = b.seq.load(std::memory_order_relaxed);
+        b.seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        auto* base = static_cast<unsigned char*>(region_.data()) + block_->dataOffset + w * block_->bufferBytes;
+        for (std::size_t i = 0; i < sources_.size(); ++i) {
+            const auto& c = block_->columns[i];
+            std::size_t n = std::min<std::size_t>(sources_[i].size(), c.count);
+            std::memcpy(base + c.offset, sources_[i].data(), n * c.elemSize);
+        }
+        b.frame   = frame;
+        b.simTime = simTime;
+        b.inputNs = inputNs;
+
+        b.seq.store(s + 2, std::memory_order_release);
+        block_->latest.store(w, std::memory_order_release);
+        block_->published.fetch_add(1, std::memory_order_relaxed);
+    }
+
+private:
+    struct Source {
+        std::string                   name;
+        StateBlock::Type              type     = StateBlock::Type::F64;
+        std::size_t                   elemSize = 0;
+        std::size_t                   count    = 0;
+        std::function<const void*()>  data;
+        std::function<std::size_t()>  size;
+    };
+
+    std::string         name_;
+    std::vector<Source> sources_;
+    ShmRegion           region_;
+    StateBlock*         block_  = nullptr;
+    bool                failed_ = false;
+};
+
+class StateReader {
+public:
+    // A frame in place in shared memory. Its contents are only meaningful
+    // once valid() confirms the writer did not reuse the buffer meanwhile,
+    // which takes two further frames.
+    struct View {
+        std::int64_t         frame   = -1;
+        double               simTime = 0.0;
+        std::int64_t         inputNs = 0;
+        const unsigned char* bytes   = nullptr;
+        std::size_t          size    = 0;
+        std::uint32_t        buffer  = StateBlock::kNone;
+        std::uint32_t        seq     = 0;
+
+        template <class T>
+        const T* column(const StateBlock::Column& c) const { return columnAt<T>(bytes, size, c); }
+    };
+
+    // A private copy of a frame.
+    struct Snapshot {
+        std::int64_t               frame   = -1;
+        double                     simTime = 0.0;
+        std::int64_t               inputNs = 0;
+        std::vector<unsigned char> bytes;
+
+        template <class T>
+        const T* column(const StateBlock::Column& c) const { return columnAt<T>(bytes.data(), bytes.size(), c); }
+    };
+
+    explicit StateReader(const std::string& shmName = "/simcore_state")
+        : region_(ShmRegion::open(shmName)) {
+        if (!region_.valid() || region_.size() < sizeof(StateBlock)) return;
+        auto* b = static_cast<const StateBlock*>(region_.data());
+        if (b->magic != StateBlock::kMagic || b->version != StateBlock::kVersion) return;
+        if (b->dataOffset + b->bufferBytes * StateBlock::kBuffers > region_.size()) return;
+        block_ = b;
+    }
+
+    bool ok() const { return block_ != nullptr; }
+    std::size_t columnCount() const { return block_ ? block_->columnCount : 0; }
+    const StateBlock::Column* column(std::size_t i) const {
+        return (block_ && i < block_->columnCount) ? &block_->columns[i] : nullptr;
+    }
+    const StateBlock::Column* column(const std::string& name) const {
+        for (std::size_t i = 0; i < columnCount(); ++i)
+            if (name == block_->columns[i].name) return &block_->columns[i];
+        return nullptr;
+    }
+    std::uint64_t published() const { return block_ ? block_->published.load(std::memory_order_relaxed) : 0; }
+
+    // Point `out` at the latest complete frame, without copying; false if
+    // nothing was published yet or the writer kept lapping us. Check
+    // valid(out) after using the data.
+    bool view(View& out, int maxRetries = 100) const {
+        if (!block_) return false;
+        for (int i = 0; i < maxRetries; ++i) {
+            std::uint32_t w = block_->latest.load(std::memory_order_acquire);
+            if (w >= StateBlock::kBuffers) return false;
+            const auto& b = block_->buffers[w];
+            std::uint32_t s = b.seq.load(std::memory_order_acquire);
+            if (s & 1u) continue;
+            out.bytes   = static_cast<const unsigned char*>(region_.data()) + block_->dataOffset + w * block_->bufferBytes;
+            out.size    = block_->bufferBytes;
+            out.frame   = b.frame;
+            out.simTime = b.simTime;
+            out.inputNs = b.inputNs;
+            out.buffer  = w;
+            out.seq     = s;
+            return true;
+        }
+        return false;
+    }
+
+    // True if everything read through `v` so far belongs to its frame.
+    bool valid(const View& v) const {
+        if (!block_ || v.buffer >= StateBlock::kBuffers) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return block_->buffers[v.buffer].seq.load(std::memory_order_relaxed) == v.seq;
+    }
+
+    // Run fn(const View&) on the latest frame in place, again on a newer
+    // frame if the writer reused the buffer under it. fn must only read
+    // the view and keep nothing it derived until visit() returns true.
+    template <class Fn>
+    bool visit(Fn&& fn, int maxRetries = 100) const {
+        View v;
+        for (int i = 0; i < maxRetries; ++i) {
+            if (!view(v, maxRetries)) return false;
+            fn(static_cast<const View&>(v));
+            if (valid(v)) return true;
+        }
+        return false;
+    }
+
+    // Copy the latest complete frame; false if nothing was published yet or
+    // the writer kept lapping us.
+    bool read(Snapshot& out, int maxRetries = 100) const {
+        if (!block_) return false;
+        out.bytes.resize(block_->bufferBytes);
+        View v;
+        for (int i = 0; i < maxRetries; ++i) {
+            if (!view(v, maxRetries)) return false;
+            std::memcpy(out.bytes.data(), v.bytes, out.bytes.size());
+            out.frame   = v.frame;
+            out.simTime = v.simTime;
+            out.inputNs = v.inputNs;
+            if (valid(v)) return true;
+        }
+        return false;
+    }
+
+private:
+    template <class T>
+    static const T* columnAt(const unsigned char* base, std::size_t size, const StateBlock::Column& c) {
+        if (!base || c.type != StateBlock::typeOf<T>() || c.offset + c.count * sizeof(T) > size)
+            return nullptr;
+        return reinterpret_cast<const T*>(base + c.offset);
+    }
+
+    ShmRegion         region_;
+    const StateBlock* block_ = nullptr;
+};
@@ -0,0 +1,502 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "mapped_file.hpp"
+#include "async_io.hpp"
+
+// Columnar telemetry file:
+//   TelemetryFileHeader, TelemetryChannelDesc[channelCount],
+//   then blocks of up to blockSamples samples:
+//   TelemetryBlockHeader, per channel { uint32 byteLen, encoded bytes }.
+// Floating channels are XOR-encoded against the previous sample (byte
+// aligned, Gorilla-style); integer channels as zigzag varint deltas of
+// their int64 value, so both round-trip exactly (uint64 as its bit pattern).
+// Sample k of a block belongs to frame firstFrame + k * decimation.
+struct TelemetryFileHeader {
+    static constexpr std::uint32_t kMagic   = 0x4C455453; // "STEL"
+    static constexpr std::uint32_t kVersion = 1;
+    std::uint32_t magic        = kMagic;
+    std::uint32_t version      = kVersion;
+    std::uint32_t channelCount = 0;
+    std::uint32_t decimation   = 1;
+    std::uint32_t blockSamples = 0;
+    std::uint32_t reserved     = 0;
+    double        hz           = 0.0;
+};
+
+struct TelemetryChannelDesc {
+    static constexpr std::size_t kNameLen = 48;
+    enum Encoding : std::uint32_t { XorFloat = 0, DeltaInt = 1 };
+    char          name[kNameLen]{};
+    std::uint32_t encoding = XorFloat;
+    std::uint32_t reserved = 0;
+};
+
+struct TelemetryBlockHeader {
+    static constexpr std::uint32_t kMagic = 0x4B4C4254; // "TBLK"
+    std::uint32_t magic        = kMagic;
+    std::uint32_t sampleCount  = 0;
+    std::int64_t  firstFrame   = 0;
+    std::uint64_t payloadBytes = 0;
+};
+
+struct TelemetryCodec {
+    static void encodeXor(const double* v, std::size_t n, std::vector<std::uint8_t>& out) {
+        std::uint64_t prev = 0;
+        for (std::size_t i = 0; i < n; ++i) putXor(std::bit_cast<std::uint64_t>(v[i]), prev, out);
+    }
+    // Same encoding from the doubles' bit patterns.
+    static void encodeXor(const std::uint64_t* bits, std::size_t n, std::vector<std::uint8_t>& out) {
+        std::uint64_t prev = 0;
+        for (std::size_t i = 0; i < n; ++i) putXor(bits[i], prev, out);
+    }
+    static bool decodeXor(const std::uint8_t* p, std::size_t len, std::size_t n, double* out) {
+        const std::uint8_t* end = p + len;
+        std::uint64_t prev = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (p >= end) return false;
+            std::uint8_t ctl = *p++;
+            std::uint64_t x = 0;
+            if (ctl != 0xFF) {
+                unsigned lz = ctl >> 4, tz = ctl & 0xF;
+                if (lz + tz >= 8) return false;
+                unsigned nb = 8 - lz - tz;
+                if (static_cast<std::size_t>(end - p) < nb) return false;
+                for (unsigned b = 0; b < nb; ++b) x |= std::uint64_t(p[b]) << (8 * b);
+                p += nb;
+                x <<= tz * 8;
+            }
+            prev ^= x;
+            std::memcpy(&out[i], &prev, sizeof(prev));
+        }
+        return p == end;
+    }
+
+    // Deltas wrap modulo 2^64, so any int64 sequence round-trips.
+    static void encodeDelta(const std::int64_t* v, std::size_t n, std::vector<std::uint8_t>& out) {
+        std::uint64_t prev = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            auto cur = static_cast<std::uint64_t>(v[i]);
+            auto d = static_cast<std::int64_t>(cur - prev);
+            prev = cur;
+            std::uint64_t z = (static_cast<std::uint64_t>(d) << 1) ^ static_cast<std::uint64_t>(d >> 63);
+            while (z >= 0x80) { out.push_back(static_cast<std::uint8_t>(z | 0x80)); z >>= 7; }
+            out.push_back(static_cast<std::uint8_t>(z));
+        }
+    }
+    static bool decodeDelta(const std::uint8_t* p, std::size_t len, std::size_t n, std::int64_t* out) {
+        const std::uint8_t* end = p + len;
+        std::uint64_t prev = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            std::uint64_t z = 0;
+            for (unsigned shift = 0;; shift += 7) {
+                if (p >= end || shift > 63) return false;
+                std::uint8_t b = *p++;
+                z |= std::uint64_t(b & 0x7F) << shift;
+                if (!(b & 0x80)) break;
+            }
+            prev += (z >> 1) ^ (~(z & 1) + 1);
+            out[i] = static_cast<std::int64_t>(prev);
+        }
+        return p == end;
+    }
+
+private:
+    static void putXor(std::uint64_t bits, std::uint64_t& prev, std::vector<std::uint8_t>& out) {
+        std::uint64_t x = bits ^ prev;
+        prev = bits;
+        if (x == 0) { out.push_back(0xFF); return; }
+        unsigned lz = static_cast<unsigned>(std::countl_zero(x)) / 8;
+        unsigned tz = static_cast<unsigned>(std::countr_zero(x)) / 8;
+        out.push_back(static_cast<std::uint8_t>((lz << 4) | tz));
+        x >>= tz * 8;
+        for (unsigned b = 0; b < 8 - lz - tz; ++b, x >>= 8)
+            out.push_back(static_cast<std::uint8_t>(x));
+    }
+};
+
+// Snapshots selected column elements every `decimation` frames into
+// column-major blocks; a writer thread encodes and writes full blocks.
+// The sim thread only copies values and, once per block, swaps buffers
+// under a short lock. A full queue drops the block instead of waiting.
+//
+// The file is opened by open() (setup code) or, if that was not called,
+// by the writer thread before its first block; record() never makes a
+// syscall. The writer waits for AsyncIO buffers rather than letting a block
+// be cut short; a block that still fails to write is counted as dropped
+// and ends the file, so what is on disk always parses.
+class TelemetryRecorder {
+public:
+    struct Config {
+        std::string   path         = "simcore.stel";
+        std::uint32_t decimation   = 1;
+        std::uint32_t blockSamples = 256;
+        std::size_t   queueBlocks  = 8;
+        AsyncIO*      io           = nullptr;   // route file writes through it
+    };
+
+    TelemetryRecorder() : TelemetryRecorder(Config{}) {}
+    explicit TelemetryRecorder(const Config& c) : cfg_(c) {
+        if (cfg_.decimation == 0) cfg_.decimation = 1;
+        if (cfg_.blockSamples == 0) cfg_.blockSamples = 1;
+        writer_ = std::thread([this]{ writerLoop(); });
+    }
+    ~TelemetryRecorder() {
+        flush();
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        writer_.join();
+        if (file_) std::fclose(file_);
+        if (ioFile_ >= 0) cfg_.io->close(ioFile_);
+    }
+    TelemetryRecorder(const TelemetryRecorder&) = delete;
+    TelemetryRecorder& operator=(const TelemetryRecorder&) = delete;
+
+    // Register channels before the first record(); the vectors must outlive
+    // the recorder. Integer columns are delta-encoded, floating ones XORed.
+    template <class T>
+    bool addChannel(const std::string& name, const std::vector<T>& column, std::size_t index = 0) {
+        static_assert(std::is_arithmetic_v<T>, "telemetry channels are numeric");
+        if (frozen_) return false;
+        Channel c;
+        c.name     = name;
+        c.encoding = std::is_floating_point_v<T> ? TelemetryChannelDesc::XorFloat
+                                                 : TelemetryChannelDesc::DeltaInt;
+        c.column   = &column;
+        c.index    = index;
+        c.get      = &getAt<T>;
+        channels_.push_back(std::move(c));
+        return true;
+    }
+    // One channel per element: prefix[0], prefix[1], ...
+    template <class T>
+    std::size_t addColumn(const std::string& prefix, const std::vector<T>& column) {
+        std::size_t added = 0;
+        for (std::size_t i = 0; i < column.size(); ++i)
+            added += addChannel(prefix + "[" + std::to_string(i) + "]", column, i) ? 1 : 0;
+        return added;
+    }
+
+    void setHz(double hz) { hz_ = hz; }
+
+    // Freeze the channel list, open the file and write its header. Blocking
+    // file IO: call it before the run, not from the sim thread. Without it
+    // the writer thread opens the file when the first block is ready.
+    bool open() {
+        if (!frozen_) freeze();
+        return openFile();
+    }
+
+    // Open, header written, and no write failed since.
+    bool ok() const { return opened_ && !failed_; }
+
+    // Sim main thread, end of frame.
+    void record(std::int64_t frame) {
+        if (frame % cfg_.decimation) return;
+        if (!frozen_) freeze();
+        if (fill_ == 0) blockFirst_ = frame;
+        const std::size_t stride = cfg_.blockSamples;
+        for (std::size_t c = 0; c < channels_.size(); ++c) {
+            const auto& ch = channels_[c];
+            cur_[c * stride + fill_] = ch.get(ch.column, ch.index);
+        }
+        ++samples_;
+        if (++fill_ == cfg_.blockSamples) submit();
+    }
+
+    // Push out the partial block and wait until everything queued is written.
+    void flush() {
+        if (fill_) submit();
+        std::unique_lock<std::mutex> lk(m_);
+        idleCv_.wait(lk, [this]{ return queue_.empty() && !writing_; });
+        if (file_) std::fflush(file_);
+        if (ioFile_ >= 0) cfg_.io->flush();
+    }
+
+    std::uint64_t samples() const { return samples_; }
+    std::uint64_t droppedBlocks() const { std::lock_guard<std::mutex> lk(m_); return dropped_; }
+    std::uint64_t bytesWritten() const { std::lock_guard<std::mutex> lk(m_); return bytes_; }
+
+private:
+    void freeze() {
+        frozen_ = true;
+        cur_.assign(channels_.size() * cfg_.blockSamples, 0);
+    }
+
+    // Writer thread, or open() before any block exists, so never both.
+    bool openFile() {
+        if (opened_ || failed_) return opened_ && !failed_;
+        if (cfg_.io) ioFile_ = cfg_.io->open(cfg_.path, true);
+        else         file_   = std::fopen(cfg_.path.c_str(), "wb");
+        if (!file_ && ioFile_ < 0) { failed_ = true; return false; }
+        opened_ = true;
+        TelemetryFileHeader h;
+        h.channelCount = static_cast<std::uint32_t>(channels_.size());
+        h.decimation   = cfg_.decimation;
+        h.blockSamples = cfg_.blockSamples;
+        h.hz           = hz_;
+        std::vector<TelemetryChannelDesc> descs(channels_.size());
+        for (std::size_t i = 0; i < channels_.size(); ++i) {
+            std::size_t len = std::min(channels_[i].name.size(), TelemetryChannelDesc::kNameLen - 1);
+            std::memcpy(descs[i].name, channels_[i].name.data(), len);
+            descs[i].encoding = channels_[i].encoding;
+        }
+        const std::size_t descBytes = descs.size() * sizeof(TelemetryChannelDesc);
+        if (!put(&h, sizeof(h)) || !put(descs.data(), descBytes)) {
+            failed_ = true;
+            return false;
+        }
+        std::lock_guard<std::mutex> lk(m_);
+        bytes_ += sizeof(h) + descBytes;
+        return true;
+    }
+
+    struct Channel {
+        std::string   name;
+        std::uint32_t encoding = TelemetryChannelDesc::XorFloat;
+        const void*   column   = nullptr;
+        std::size_t   index    = 0;
+        std::uint64_t (*get)(const void*, std::size_t) = nullptr;
+    };
+    // Samples as 64-bit words: double bit patterns for XorFloat channels,
+    // int64 values for DeltaInt ones.
+    struct Block {
+        std::int64_t               firstFrame = 0;
+        std::uint32_t              count      = 0;
+        std::vector<std::uint64_t> values;
+    };
+
+    template <class T>
+    static std::uint64_t getAt(const void* col, std::size_t i) {
+        const auto& v = *static_cast<const std::vector<T>*>(col);
+        if (i >= v.size()) return 0;
+        if constexpr (std::is_floating_point_v<T>)
+            return std::bit_cast<std::uint64_t>(static_cast<double>(v[i]));
+        else if constexpr (std::is_signed_v<T>)
+            return static_cast<std::uint64_t>(static_cast<std::int64_t>(v[i]));
+        else
+            return static_cast<std::uint64_t>(v[i]);
+    }
+
+    // Whole or not at all as far as the stream is concerned: a failed put
+    // ends the file (failed_), so a later block never follows a torn one.
+    bool put(const void* p, std::size_t n) {
+        if (n == 0) return true;
+        if (ioFile_ >= 0) return cfg_.io->writeWait(ioFile_, p, n);
+        return std::fwrite(p, 1, n, file_) == n;
+    }
+
+    void submit() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            if (queue_.size() >= cfg_.queueBlocks) {
+                ++dropped_;
+                fill_ = 0;
+                return;
+            }
+            queue_.push_back(Block{blockFirst_, fill_, std::move(cur_)});
+            if (!free_.empty()) { cur_ = std::move(free_.back()); free_.pop_back(); }
+        }
+        if (cur_.size() != channels_.size() * cfg_.blockSamples)
+            cur_.assign(channels_.size() * cfg_.blockSamples, 0);
+        fill_ = 0;
+        cv_.notify_one();
+    }
+
+    void writerLoop() {
+        std::vector<std::uint8_t> payload, enc;
+        std::unique_lock<std::mutex> lk(m_);
+        for (;;) {
+            cv_.wait(lk, [this]{ return stop_ || !queue_.empty(); });
+            if (queue_.empty()) { if (stop_) return; continue; }
+            Block b = std::move(queue_.front());
+            queue_.pop_front();
+            writing_ = true;
+            lk.unlock();
+
+            payload.clear();
+            for (std::size_t c = 0; c < channels_.size(); ++c) {
+                enc.clear();
+                const std::uint64_t* v = b.values.data() + c * cfg_.blockSamples;
+                if (channels_[c].encoding == TelemetryChannelDesc::DeltaInt)
+                    TelemetryCodec::encodeDelta(reinterpret_cast<const std::int64_t*>(v), b.count, enc);
+                else
+                    TelemetryCodec::encodeXor(v, b.count, enc);
+                auto len = static_cast<std::uint32_t>(enc.size());
+                const auto* lp = reinterpret_cast<const std::uint8_t*>(&len);
+                payload.insert(payload.end(), lp, lp + sizeof(len));
+                payload.insert(payload.end(), enc.begin(), enc.end());
+            }
+            TelemetryBlockHeader h;
+            h.sampleCount  = b.count;
+            h.firstFrame   = b.firstFrame;
+            h.payloadBytes = payload.size();
+
+            // The file is only touched here and in open(), which runs
+            // before any block exists, so no lock is needed around it.
+            const bool usable = openFile();
+            const bool written = usable && put(&h, sizeof(h)) && put(payload.data(), payload.size());
+
+            lk.lock();
+            if (written) bytes_ += sizeof(h) + payload.size();
+            else { ++dropped_; if (usable) failed_ = true; }
+            free_.push_back(std::move(b.values));
+            writing_ = false;
+            if (queue_.empty()) idleCv_.notify_all();
+        }
+    }
+
+    Config               cfg_;
+    double               hz_ = 0.0;
+    std::vector<Channel> channels_;
+    bool                 frozen_ = false;   // channels fixed; sim/setup thread
+    std::FILE*           file_   = nullptr;
+    AsyncIO::FileId      ioFile_ = -1;
+    std::atomic<bool>    opened_{false};
+    std::atomic<bool>    failed_{false};    // open or a write failed: file abandoned
+
+    std::vector<std::uint64_t> cur_;
+    std::uint32_t        fill_       = 0;
+    std::int64_t         blockFirst_ = 0;
+    std::uint64_t        samples_    = 0;
+
+    mutable std::mutex               m_;
+    std::condition_variable          cv_, idleCv_;
+    std::deque<Block>                queue_;
+    std::vector<std::vector<std::uint64_t>> free_;
+    bool                             writing_ = false;
+    bool                             stop_    = false;
+    std::uint64_t                    dropped_ = 0;
+    std::uint64_t                    bytes_   = 0;
+    std::thread                      writer_;
+};
+
+// Zero-parse reader: maps the file, indexes blocks, decodes on demand.
+class TelemetryReader {
+public:
+    explicit TelemetryReader(const std::string& path) : file_(MappedFile::open(path)) {
+        if (!file_.valid() || file_.size() < sizeof(TelemetryFileHeader)) return;
+        const std::uint8_t* p = file_.bytes();
+        const std::uint8_t* end = p + file_.size();
+        std::memcpy(&hdr_, p, sizeof(hdr_));
+        if (hdr_.magic != TelemetryFileHeader::kMagic || hdr_.version != TelemetryFileHeader::kVersion) return;
+        p += sizeof(hdr_);
+        if (static_cast<std::size_t>(end - p) < hdr_.channelCount * sizeof(TelemetryChannelDesc)) return;
+        descs_.resize(hdr_.channelCount);
+        if (hdr_.channelCount)
+            std::memcpy(descs_.data(), p, hdr_.channelCount * sizeof(TelemetryChannelDesc));
+        p += hdr_.channelCount * sizeof(TelemetryChannelDesc);
+
+        while (static_cast<std::size_t>(end - p) >= sizeof(TelemetryBlockHeader)) {
+            TelemetryBlockHeader bh;
+            std::memcpy(&bh, p, sizeof(bh));
+            p += sizeof(bh);
+            if (bh.magic != TelemetryBlockHeader::kMagic || bh.payloadBytes > std::uint64_t(end - p)) break;
+            BlockRef ref{bh.firstFrame, bh.sampleCount, {}};
+            const std::uint8_t* q = p;
+            const std::uint8_t* qEnd = p + bh.payloadBytes;
+            bool good = true;
+            for (std::uint32_t c = 0; c < hdr_.channelCount && good; ++c) {
+                std::uint32_t len = 0;
+                if (qEnd - q < 4) { good = false; break; }
+                std::memcpy(&len, q, sizeof(len));
+                q += sizeof(len);
+                if (static_cast<std::size_t>(qEnd - q) < len) { good = false; break; }
+                ref.chans.push_back({q, len});
+                q += len;
+            }
+            if (!good) break;
+            samples_ += bh.sampleCount;
+            blocks_.push_back(std::move(ref));
+            p = qEnd;
+        }
+        ok_ = true;
+    }
+
+    bool ok() const { return ok_; }
+    const TelemetryFileHeader& header() const { return hdr_; }
+    std::size_t channelCount() const { return descs_.size(); }
+    std::string channelName(std::size_t i) const { return descs_[i].name; }
+    long channelIndex(const std::string& name) const {
+        for (std::size_t i = 0; i < descs_.size(); ++i)
+            if (name == descs_[i].name) return static_cast<long>(i);
+        return -1;
+    }
+    std::size_t sampleCount() const { return samples_; }
+    std::size_t blockCount() const { return blocks_.size(); }
+
+    std::vector<std::int64_t> frames() const {
+        std::vector<std::int64_t> out;
+        out.reserve(samples_);
+        for (auto& b : blocks_)
+            for (std::uint32_t k = 0; k < b.count; ++k)
+                out.push_back(b.firstFrame + std::int64_t(k) * hdr_.decimation);
+        return out;
+    }
+
+    bool isInteger(std::size_t ch) const {
+        return ch < descs_.size() && descs_[ch].encoding == TelemetryChannelDesc::DeltaInt;
+    }
+
+    // Any channel as doubles; integer channels beyond 2^53 lose precision
+    // here, use the int64 overload for them.
+    bool readChannel(std::size_t ch, std::vector<double>& out) const {
+        if (!ok_ || ch >= descs_.size()) return false;
+        if (isInteger(ch)) {
+            std::vector<std::int64_t> raw;
+            if (!readChannel(ch, raw)) return false;
+            out.resize(raw.size());
+            for (std::size_t i = 0; i < raw.size(); ++i) out[i] = static_cast<double>(raw[i]);
+            return true;
+        }
+        out.resize(samples_);
+        std::size_t at = 0;
+        for (auto& b : blocks_) {
+            const auto& span = b.chans[ch];
+            if (!TelemetryCodec::decodeXor(span.first, span.second, b.count, out.data() + at)) return false;
+            at += b.count;
+        }
+        return true;
+    }
+
+    // Integer channels, exactly; false for floating ones.
+    bool readChannel(std::size_t ch, std::vector<std::int64_t>& out) const {
+        if (!ok_ || !isInteger(ch)) return false;
+        out.resize(samples_);
+        std::size_t at = 0;
+        for (auto& b : blocks_) {
+            const auto& span = b.chans[ch];
+            if (!TelemetryCodec::decodeDelta(span.first, span.second, b.count, out.data() + at)) return false;
+            at += b.count;
+        }
+        return true;
+    }
+
+private:
+    struct BlockRef {
+        std::int64_t  firstFrame = 0;
+        std::uint32_t count      = 0;
+        std::vector<std::pair<const std::uint8_t*, std::size_t>> chans;
+    };
+
+    MappedFile                        file_;
+    TelemetryFileHeader               hdr_{};
+    std::vector<TelemetryChannelDesc> descs_;
+    std::vector<BlockRef>             blocks_;
+    std::size_t                       samples_ = 0;
+    bool                              ok_ = false;
+};
@@ -0,0 +1,455 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "SimCore.hpp"
+#include "mapped_file.hpp"
+#include "simd.hpp"
+
+// Tiled heightfield terrain, memory-mapped from disk.
+//
+// Heights are stored in 4x4-sample float tiles, one 64-byte cache line
+// each. Neighbouring tiles share their edge row/column, so a tile covers
+// 3x3 cells and every bilinear lookup reads exactly one line. Tiles are
+// laid out in Z (Morton) order: the low bits of tx and ty are interleaved
+// and the remaining high bits of the longer axis sit on top, so nearby
+// tiles are nearby in the file and a region around a vehicle is a handful
+// of pages. Each cell also has a material id (16 bytes per tile, parallel
+// to the height tiles) indexing a friction table.
+//
+// File: TerrainFileHeader, then the height tiles, material tiles and the
+// friction table, each at a 64-byte aligned offset. Tile slots exist for
+// every Morton index, so sizes of 3*2^k + 1 samples per axis waste none.
+struct TerrainFileHeader {
+    static constexpr std::uint32_t kMagic   = 0x52524554; // "TERR"
+    static constexpr std::uint32_t kVersion = 1;
+    std::uint32_t magic         = kMagic;
+    std::uint32_t version       = kVersion;
+    std::uint32_t samplesX      = 0;
+    std::uint32_t samplesY      = 0;
+    std::uint32_t tilesX        = 0;
+    std::uint32_t tilesY        = 0;
+    std::uint32_t bitsX         = 0;    // ceil(log2(tilesX))
+    std::uint32_t bitsY         = 0;
+    std::uint32_t materialCount = 0;
+    std::uint32_t reserved      = 0;
+    double        cellSize      = 1.0;  // m
+    double        originX       = 0.0;  // world position of sample (0, 0)
+    double        originY       = 0.0;
+    std::uint64_t heightsOffset   = 0;  // (1 << (bitsX + bitsY)) * 16 floats
+    std::uint64_t materialsOffset = 0;  // same count * 16 bytes, cell r*4+c
+    std::uint64_t frictionOffset  = 0;  // materialCount floats
+    std::uint64_t fileBytes       = 0;
+};
+
+namespace terrain {
+
+constexpr std::uint32_t kTileSamples = 4;
+constexpr std::uint32_t kTileCells   = kTileSamples - 1;
+constexpr std::uint32_t kMaxBits     = 26;   // bitsX + bitsY; keeps sample indices in int32
+
+inline std::uint32_t bitsFor(std::uint32_t n) {
+    std::uint32_t b = 0;
+    while ((std::uint32_t(1) << b) < n) ++b;
+    return b;
+}
+
+// 16 bits -> even bit positions of 32.
+SIMCORE_SIMD_INLINE std::uint32_t spread(std::uint32_t v) {
+    v &= 0x0000FFFFu;
+    v = (v | (v << 8)) & 0x00FF00FFu;
+    v = (v | (v << 4)) & 0x0F0F0F0Fu;
+    v = (v | (v << 2)) & 0x33333333u;
+    v = (v | (v << 1)) & 0x55555555u;
+    return v;
+}
+
+// Rectangular Morton index; m = min(bitsX, bitsY).
+SIMCORE_SIMD_INLINE std::uint32_t tileIndex(std::uint32_t tx, std::uint32_t ty, std::uint32_t m) {
+    const std::uint32_t low = (std::uint32_t(1) << m) - 1u;
+    return spread(tx & low) | (spread(ty & low) << 1) | (((tx >> m) | (ty >> m)) << (2 * m));
+}
+
+} // namespace terrain
+
+class TerrainWriter {
+public:
+    TerrainWriter(std::uint32_t samplesX, std::uint32_t samplesY, double cellSize,
+                  double originX = 0.0, double originY = 0.0)
+        : sx_(std::max<std::uint32_t>(samplesX, 2)), sy_(std::max<std::uint32_t>(samplesY, 2)),
+          cell_(cellSize), ox_(originX), oy_(originY),
+          heights_(std::size_t(sx_) * sy_, 0.0f), materials_(std::size_t(sx_ - 1) * (sy_ - 1), 0),
+          friction_(1, 1.0f) {}
+
+    std::uint32_t samplesX() const { return sx_; }
+    std::uint32_t samplesY() const { return sy_; }
+    float& height(std::uint32_t x, std::uint32_t y) { return heights_[std::size_t(y) * sx_ + x]; }
+    std::uint8_t& material(std::uint32_t cx, std::uint32_t cy) { return materials_[std::size_t(cy) * (sx_ - 1) + cx]; }
+    void setFriction(std::uint8_t id, float mu) {
+        if (id >= friction_.size()) friction_.resize(std::size_t(id) + 1, 1.0f);
+        friction_[id] = mu;
+    }
+
+    bool write(const std::string& path) const {
+        using namespace terrain;
+        TerrainFileHeader h;
+        h.samplesX = sx_; h.samplesY = sy_;
+        h.tilesX   = (sx_ - 2) / kTileCells + 1;
+        h.tilesY   = (sy_ - 2) / kTileCells + 1;
+        h.bitsX    = bitsFor(h.tilesX);
+        h.bitsY    = bitsFor(h.tilesY);
+        if (h.bitsX + h.bitsY > kMaxBits || !(cell_ > 0.0)) return false;
+        h.materialCount = static_cast<std::uint32_t>(friction_.size());
+        h.cellSize = cell_; h.originX = ox_; h.originY = oy_;
+        const std::size_t slots = std::size_t(1) << (h.bitsX + h.bitsY);
+        h.heightsOffset   = align64(sizeof(h));
+        h.materialsOffset = align64(h.heightsOffset + slots * 16 * sizeof(float));
+        h.frictionOffset  = align64(h.materialsOffset + slots * 16);
+        h.fileBytes       = align64(h.frictionOffset + friction_.size() * sizeof(float));
+
+        std::vector<unsigned char> out(h.fileBytes, 0);
+        std::memcpy(out.data(), &h, sizeof(h));
+        float*        ht = reinterpret_cast<float*>(out.data() + h.heightsOffset);
+        std::uint8_t* mt = out.data() + h.materialsOffset;
+        const std::uint32_t m = std::min(h.bitsX, h.bitsY);
+        for (std::uint32_t ty = 0; ty < h.tilesY; ++ty)
+            for (std::uint32_t tx = 0; tx < h.tilesX; ++tx) {
+                const std::size_t t = tileIndex(tx, ty, m);
+                // Samples past the edge repeat the last row/column; queries
+                // are clamped, so they only ever get zero weight.
+                for (std::uint32_t r = 0; r < kTileSamples; ++r)
+                    for (std::uint32_t c = 0; c < kTileSamples; ++c) {
+                        const std::uint32_t x = std::min(tx * kTileCells + c, sx_ - 1);
+                        const std::uint32_t y = std::min(ty * kTileCells + r, sy_ - 1);
+                        ht[t * 16 + r * 4 + c] = heights_[std::size_t(y) * sx_ + x];
+                        const std::uint32_t cx = std::min(x, sx_ - 2), cy = std::min(y, sy_ - 2);
+                        mt[t * 16 + r * 4 + c] = materials_[std::size_t(cy) * (sx_ - 1) + cx];
+                    }
+            }
+        std::memcpy(out.data() + h.frictionOffset, friction_.data(), friction_.size() * sizeof(float));
+
+        std::FILE* f = std::fopen(path.c_str(), "wb");
+        if (!f) return false;
+        const bool ok = std::fwrite(out.data(), 1, out.size(), f) == out.size();
+        return std::fclose(f) == 0 && ok;
+    }
+
+private:
+    static std::size_t align64(std::size_t n) { return (n + 63) & ~std::size_t(63); }
+
+    std::uint32_t sx_, sy_;
+    double        cell_, ox_, oy_;
+    std::vector<float>        heights_;
+    std::vector<std::uint8_t> materials_;
+    std::vector<float>        friction_;
+};
+
+// Batched wheel queries, SoA. x/y in, the rest out; normal is unit length.
+struct TerrainQueries {
+    std::vector<double> x, y;
+    std::vector<double> height, normalX, normalY, normalZ, friction;
+
+    std::size_t size() const { return x.size(); }
+    void resize(std::size_t n) {
+        x.resize(n); y.resize(n);
+        height.resize(n); normalX.resize(n); normalY.resize(n); normalZ.resize(n); friction.resize(n);
+    }
+};
+
+// Read side. Queries are answered in batches: tile keys for the batch,
+// optionally a sort by key so queries on the same tile run back to back,
+// then one vectorizable bilinear pass. Points outside the map are clamped
+// to its edge. Pages are faulted in on first touch; prefetch() and
+// Config::lookahead stream a region ahead.
+//
+// The sort pays when a batch holds many queries on few tiles in scattered
+// order. With the usual car-major wheel layout the four wheels of a car
+// are already adjacent and the sort costs more than it saves
+// (BM_TerrainQuery), so it is off by default.
+class Terrain {
+public:
+    struct Config {
+        std::size_t batch       = 256;    // queries per pass (and per sort), <= 512
+        bool        sortByTile  = false;
+        double      lookahead   = 0.0;    // m around the queries to prefetch; <= 0 off
+        int         prefetchFrames = 16;  // frames between lookahead passes; size lookahead
+                                          // to cover the travel in between
+    };
+
+    Terrain() : Terrain(Config{}) {}
+    explicit Terrain(const Config& cfg) : cfg_(cfg) {
+        cfg_.batch = std::clamp<std::size_t>(cfg_.batch, 1, kMaxBatch);
+        cfg_.prefetchFrames = std::max(cfg_.prefetchFrames, 1);
+    }
+
+    bool open(const std::string& path) {
+        heights_ = nullptr; error_.clear();
+        file_ = MappedFile::open(path, MappedFile::Access::Random);
+        if (!file_.valid()) return fail("cannot map " + path);
+        const std::size_t size = file_.size();
+        if (size < sizeof(TerrainFileHeader)) return fail("truncated header");
+        std::memcpy(&h_, file_.data(), sizeof(h_));
+        if (h_.magic != TerrainFileHeader::kMagic) return fail("bad magic");
+        if (h_.version != TerrainFileHeader::kVersion) return fail("unsupported version " + std::to_string(h_.version));
+        if (h_.fileBytes != size) return fail("size mismatch");
+        if (h_.samplesX < 2 || h_.samplesY < 2 || !(h_.cellSize > 0.0)) return fail("bad dimensions");
+        if (h_.tilesX != (h_.samplesX - 2) / terrain::kTileCells + 1 ||
+            h_.tilesY != (h_.samplesY - 2) / terrain::kTileCells + 1) return fail("bad tile count");
+        if (h_.bitsX != terrain::bitsFor(h_.tilesX) || h_.bitsY != terrain::bitsFor(h_.tilesY) ||
+            h_.bitsX + h_.bitsY > terrain::kMaxBits) return fail("bad tile bits");
+        if (h_.materialCount == 0) return fail("empty friction table");
+        const std::uint64_t slots = std::uint64_t(1) << (h_.bitsX + h_.bitsY);
+        if (!section(h_.heightsOffset, slots * 16 * sizeof(float), size) ||
+            !section(h_.materialsOffset, slots * 16, size) ||
+            !section(h_.frictionOffset, std::uint64_t(h_.materialCount) * sizeof(float), size))
+            return fail("section out of bounds");
+
+        materialRows_ = reinterpret_cast<const std::uint32_t*>(file_.bytes() + h_.materialsOffset);
+        friction_     = reinterpret_cast<const float*>(file_.bytes() + h_.frictionOffset);
+        heights_      = reinterpret_cast<const float*>(file_.bytes() + h_.heightsOffset);
+        invCell_      = 1.0 / h_.cellSize;
+        lastMaterial_ = static_cast<std::int32_t>(std::min<std::uint32_t>(h_.materialCount, 256) - 1);
+        morton_       = std::min(h_.bitsX, h_.bitsY);
+        return true;
+    }
+
+    bool valid() const { return heights_ != nullptr; }
+    const std::string& error() const { return error_; }
+    const TerrainFileHeader& header() const { return h_; }
+    double sizeX() const { return (h_.samplesX - 1) * h_.cellSize; }
+    double sizeY() const { return (h_.samplesY - 1) * h_.cellSize; }
+    std::uint64_t prefetchPasses() const { return prefetchPasses_; }   // lookahead passes issued
+
+    // Single point, for tools and tests; same arithmetic as query().
+    double heightAt(double x, double y, double* friction = nullptr) const {
+        std::uint32_t t; double u, v;
+        locate(x, y, t, u, v);
+        Sample s = sample(t, u, v);
+        if (friction) *friction = s.mu;
+        return s.h;
+    }
+
+    // Answers queries [b, e) in place.
+    void query(TerrainQueries& q, std::size_t b, std::size_t e) const {
+        for (std::size_t s = b; s < e; s += cfg_.batch)
+            batch(q, s, std::min(e, s + cfg_.batch));
+    }
+
+    // Asks for the tiles under [x0, x1] x [y0, y1] to be read in ahead of
+    // use (MADV_WILLNEED); returns without waiting for the reads.
+    void prefetch(double x0, double y0, double x1, double y1) const {
+        if (!valid()) return;
+        std::vector<Range> ranges;
+        addBox(x0, y0, x1, y1, ranges);
+        issue(ranges);
+    }
+
+    // Answers `queries` as a range task of one phase; the element count
+    // follows queries.size() every frame. With a lookahead, every
+    // prefetchFrames-th frame also issues the prefetch, on the sim thread
+    // (madvise only queues the reads), into a buffer kept between passes.
+    // Returns the phase index.
+    std::size_t install(SimCore& sim, TerrainQueries& queries, const std::string& name = "Terrain") {
+        const std::size_t ph = sim.addPhase(name, queries.size());
+        sim.setPhaseChunkSize(ph, cfg_.batch);
+        sim.addSerialSubsystem(ph, [this, &sim, &queries, ph](std::int64_t frame, SimCore::Seconds){
+            sim.setPhaseElementCount(ph, queries.size());
+            if (cfg_.lookahead > 0.0 && queries.size() > 0 && frame % cfg_.prefetchFrames == 0)
+                prefetchAround(queries);
+        });
+        sim.addParallelRangeTask(ph, [this, &queries](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            query(queries, b, e);
+        });
+        return ph;
+    }
+
+private:
+    static constexpr std::size_t kMaxBatch = 512;
+
+    struct Sample { double h, dx, dy, mu; };
+
+    static bool section(std::uint64_t off, std::uint64_t bytes, std::size_t size) {
+        return off % 64 == 0 && off <= size && bytes <= size - off;
+    }
+
+    bool fail(const std::string& msg) {
+        error_ = msg;
+        heights_ = nullptr;
+        file_.reset();
+        return false;
+    }
+
+    // Fractional sample coordinates, clamped to the map.
+    SIMCORE_SIMD_INLINE void grid(double x, double y, double& fx, double& fy) const {
+        fx = simd::min(simd::max((x - h_.originX) * invCell_, 0.0), double(h_.samplesX - 1));
+        fy = simd::min(simd::max((y - h_.originY) * invCell_, 0.0), double(h_.samplesY - 1));
+    }
+
+    void tileCoords(double x, double y, std::uint32_t& tx, std::uint32_t& ty) const {
+        double fx, fy;
+        grid(x, y, fx, fy);
+        tx = std::min(static_cast<std::uint32_t>(fx / terrain::kTileCells), h_.tilesX - 1);
+        ty = std::min(static_cast<std::uint32_t>(fy / terrain::kTileCells), h_.tilesY - 1);
+    }
+
+    // Tile and position inside it, u, v in [0, 3].
+    SIMCORE_SIMD_INLINE void locate(double x, double y, std::uint32_t& t, double& u, double& v) const {
+        double fx, fy;
+        grid(x, y, fx, fy);
+        const double tx = simd::min(std::floor(fx * (1.0 / terrain::kTileCells)), double(h_.tilesX - 1));
+        const double ty = simd::min(std::floor(fy * (1.0 / terrain::kTileCells)), double(h_.tilesY - 1));
+        u = fx - tx * terrain::kTileCells;
+        v = fy - ty * terrain::kTileCells;
+        t = terrain::tileIndex(static_cast<std::uint32_t>(static_cast<std::int32_t>(tx)),
+                               static_cast<std::uint32_t>(static_cast<std::int32_t>(ty)), morton_);
+    }
+
+    SIMCORE_SIMD_INLINE Sample sample(std::uint32_t t, double u, double v) const {
+        const double c = simd::min(std::floor(u), 2.0), r = simd::min(std::floor(v), 2.0);
+        const double fu = u - c, fv = v - r;
+        // 32-bit index math: double -> int64 conversions have no AVX2 form.
+        const std::int32_t ci  = static_cast<std::int32_t>(c);
+        const std::int32_t row = static_cast<std::int32_t>(t) * 4 + static_cast<std::int32_t>(r);
+        const std::int32_t k   = row * 4 + ci;
+        const double h00 = heights_[k],     h10 = heights_[k + 1];
+        const double h01 = heights_[k + 4], h11 = heights_[k + 5];
+        const double du = (h10 - h00) * (1.0 - fv) + (h11 - h01) * fv;
+        const double dv = (h01 - h00) * (1.0 - fu) + (h11 - h10) * fu;
+        // No byte gathers: load the row's four ids as one word.
+        const std::uint32_t ids = materialRows_[row];
+        const std::int32_t  m   = std::min(static_cast<std::int32_t>((ids >> (8 * ci)) & 0xFFu), lastMaterial_);
+        return {h00 + (h10 - h00) * fu + dv * fv, du * invCell_, dv * invCell_, double(friction_[m])};
+    }
+
+    // Indexed loads vectorize as gathers (AVX2 and up) where the indexed
+    // stores of a scatter would not, so the bilinear pass reads x/y through
+    // the sort order and writes its results contiguously; a plain loop puts
+    // them back in query order.
+    void batch(TerrainQueries& q, std::size_t b, std::size_t e) const {
+        const std::size_t n = e - b;
+        std::uint64_t order[kMaxBatch];
+        std::uint32_t slot[kMaxBatch];
+        double        rh[kMaxBatch], rx[kMaxBatch], ry[kMaxBatch], rz[kMaxBatch], rm[kMaxBatch];
+        const double* qx = q.x.data() + b;
+        const double* qy = q.y.data() + b;
+
+        SIMCORE_SIMD_LOOP
+        for (std::size_t k = 0; k < n; ++k) {
+            std::uint32_t t; double u, v;
+            locate(qx[k], qy[k], t, u, v);
+            order[k] = (std::uint64_t(t) << 32) | k;
+        }
+        if (cfg_.sortByTile) sortByTile(order, n);
+        SIMCORE_SIMD_LOOP
+        for (std::size_t j = 0; j < n; ++j) slot[j] = static_cast<std::uint32_t>(order[j]);
+
+        SIMCORE_SIMD_LOOP
+        for (std::size_t j = 0; j < n; ++j) {
+            std::uint32_t t; double u, v;
+            locate(qx[slot[j]], qy[slot[j]], t, u, v);
+            const Sample s = sample(t, u, v);
+            const double inv = 1.0 / std::sqrt(s.dx * s.dx + s.dy * s.dy + 1.0);
+            rh[j] = s.h;
+            rx[j] = -s.dx * inv; ry[j] = -s.dy * inv; rz[j] = inv;
+            rm[j] = s.mu;
+        }
+
+        double* oh = q.height.data() + b;
+        double* nx = q.normalX.data() + b;
+        double* ny = q.normalY.data() + b;
+        double* nz = q.normalZ.data() + b;
+        double* mu = q.friction.data() + b;
+        for (std::size_t j = 0; j < n; ++j) {
+            const std::uint32_t k = slot[j];
+            oh[k] = rh[j]; nx[k] = rx[j]; ny[k] = ry[j]; nz[k] = rz[j]; mu[k] = rm[j];
+        }
+    }
+
+    // Stable LSD radix sort on the tile half of (tile << 32 | query), over
+    // only the bits tile indices use; branch-free, unlike a comparison sort
+    // of a few hundred keys.
+    void sortByTile(std::uint64_t* order, std::size_t n) const {
+        std::uint64_t tmp[kMaxBatch];
+        std::uint64_t* src = order;
+        std::uint64_t* dst = tmp;
+        for (std::uint32_t shift = 32; shift < 32 + h_.bitsX + h_.bitsY; shift += 8) {
+            std::uint32_t count[257] = {};
+            for (std::size_t i = 0; i < n; ++i) ++count[((src[i] >> shift) & 0xFFu) + 1];
+            for (std::size_t d = 1; d < 257; ++d) count[d] += count[d - 1];
+            for (std::size_t i = 0; i < n; ++i) dst[count[(src[i] >> shift) & 0xFFu]++] = src[i];
+            std::swap(src, dst);
+        }
+        if (src != order) std::memcpy(order, src, n * sizeof(std::uint64_t));
+    }
+
+    // Tile index ranges, [first, last].
+    struct Range { std::uint32_t first, last; };
+
+    // Morton order is monotone in each coordinate, so the index range
+    // between a box's corners covers the box. Boxes whose range is mostly
+    // tiles outside them (straddling a high bit) are split first.
+    void addTiles(std::uint32_t tx0, std::uint32_t ty0, std::uint32_t tx1, std::uint32_t ty1,
+                  std::vector<Range>& out) const {
+        const std::uint32_t lo = terrain::tileIndex(tx0, ty0, morton_);
+        const std::uint32_t hi = terrain::tileIndex(tx1, ty1, morton_);
+        const std::uint64_t area = std::uint64_t(tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+        if (std::uint64_t(hi - lo) + 1 <= 4 * area || area <= 4) { out.push_back({lo, hi}); return; }
+        if (tx1 - tx0 >= ty1 - ty0) {
+            const std::uint32_t mid = tx0 + (tx1 - tx0) / 2;
+            addTiles(tx0, ty0, mid, ty1, out);
+            addTiles(mid + 1, ty0, tx1, ty1, out);
+        } else {
+            const std::uint32_t mid = ty0 + (ty1 - ty0) / 2;
+            addTiles(tx0, ty0, tx1, mid, out);
+            addTiles(tx0, mid + 1, tx1, ty1, out);
+        }
+    }
+
+    void addBox(double x0, double y0, double x1, double y1, std::vector<Range>& out) const {
+        std::uint32_t tx0, ty0, tx1, ty1;
+        tileCoords(std::min(x0, x1), std::min(y0, y1), tx0, ty0);
+        tileCoords(std::max(x0, x1), std::max(y0, y1), tx1, ty1);
+        addTiles(tx0, ty0, tx1, ty1, out);
+    }
+
+    // Sorted, with ranges less than a page apart merged, so neighbouring
+    // wheels cost one madvise between them.
+    void issue(std::vector<Range>& ranges) const {
+        constexpr std::uint32_t kGap = 4096 / 64;
+        std::sort(ranges.begin(), ranges.end(), [](const Range& a, const Range& b){ return a.first < b.first; });
+        for (std::size_t i = 0; i < ranges.size();) {
+            std::uint32_t last = ranges[i].last;
+            std::size_t j = i + 1;
+            for (; j < ranges.size() && ranges[j].first <= last + kGap; ++j) last = std::max(last, ranges[j].last);
+            const std::size_t first = ranges[i].first, count = std::size_t(last) - first + 1;
+            file_.willNeed(h_.heightsOffset + first * 16 * sizeof(float), count * 16 * sizeof(float));
+            file_.willNeed(h_.materialsOffset + first * 16, count * 16);
+            i = j;
+        }
+    }
+
+    void prefetchAround(const TerrainQueries& q) {
+        ranges_.clear();
+        const double r = cfg_.lookahead;
+        for (std::size_t i = 0; i < q.size(); ++i) addBox(q.x[i] - r, q.y[i] - r, q.x[i] + r, q.y[i] + r, ranges_);
+        issue(ranges_);
+        ++prefetchPasses_;
+    }
+
+    Config            cfg_;
+    MappedFile        file_;
+    TerrainFileHeader h_{};
+    const float*        heights_   = nullptr;
+    const std::uint32_t* materialRows_ = nullptr;   // 4 little-endian ids per word
+    const float*        friction_  = nullptr;
+    double        invCell_ = 1.0;
+    std::int32_t  lastMaterial_ = 0;
+    std::uint32_t morton_  = 0;
+    std::string   error_;
+    std::vector<Range> ranges_;             // lookahead pass scratch, capacity kept
+    std::uint64_t prefetchPasses_ = 0;
+};
@@ -0,0 +1,327 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "async_io.hpp"
+
+// Flight recorder for frame timing: fixed-size binary events in a ring,
+// frozen to disk when a frame misses its deadline or drift jumps.
+//
+// Ring slots are seqlocked: workers may still be recording (a WaveEnd for
+// the wave the main thread just finished, or a late WaveBegin) while a
+// window is copied out, so the copy waits briefly for a slot being written
+// and skips one it cannot get whole.
+
+enum class TraceKind : std::uint16_t {
+    FrameBegin = 0, FrameEnd, PhaseBegin, PhaseEnd,
+    TaskBegin, TaskEnd, WaveBegin, WaveEnd, CatchUp
+};
+
+struct TraceEvent {
+    std::uint64_t tsNs   = 0;   // steady_clock ns
+    std::int64_t  frame  = 0;
+    TraceKind     kind   = TraceKind::FrameBegin;
+    std::uint16_t thread = 0;   // 0 = main, 1.. = worker index + 1
+    std::uint32_t arg    = 0;   // phase / task index, catch-up count
+};
+
+struct TraceFileHeader {
+    static constexpr std::uint32_t kMagic   = 0x43525453; // "STRC"
+    static constexpr std::uint32_t kVersion = 1;
+    enum Reason : std::uint32_t { Lateness = 1, DriftJump = 2 };
+
+    std::uint32_t magic        = kMagic;
+    std::uint32_t version      = kVersion;
+    std::int64_t  triggerFrame = 0;
+    std::int64_t  firstFrame   = 0;
+    std::int64_t  lastFrame    = 0;
+    std::int64_t  latenessNs   = 0;
+    double        driftMs      = 0.0;
+    double        driftJumpMs  = 0.0;
+    std::uint32_t reason       = 0;
+    std::uint32_t truncated    = 0;   // window overran the ring
+    std::uint32_t settingsLen  = 0;   // bytes of settings text after header
+    std::uint32_t eventCount   = 0;   // TraceEvents after settings text
+};
+
+class TraceCapture {
+public:
+    struct Config {
+        std::size_t  framesBefore    = 64;     // N frames kept before trigger
+        std::size_t  framesAfter     = 16;     // M frames recorded after
+        double       latenessMs      = 1.0;    // trigger when later than this
+        double       driftJumpMs     = 2.0;    // or drift moves by more than this
+        std::size_t  eventCapacity   = 1u << 16; // rounded up to power of two
+        int          maxCaptures     = 8;
+        std::string  pathPrefix      = "simcore_trace";
+        AsyncIO*     io              = nullptr; // route file writes through it
+    };
+
+    TraceCapture() : TraceCapture(Config{}) {}
+    explicit TraceCapture(const Config& c) : cfg_(c) {
+        std::size_t cap = 1;
+        while (cap < cfg_.eventCapacity) cap <<= 1;
+        ring_ = std::make_unique<Slot[]>(cap);
+        capacity_ = cap;
+        mask_ = cap - 1;
+        // slack covers catch-up steps landing past the post-trigger window
+        frameStart_.resize(cfg_.framesBefore + cfg_.framesAfter + 64);
+        scratch_.reserve(cap);
+        writer_ = std::thread([this]{ writerLoop(); });
+    }
+    ~TraceCapture() {
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        writer_.join();
+    }
+    TraceCapture(const TraceCapture&) = delete;
+    TraceCapture& operator=(const TraceCapture&) = delete;
+
+    // Main thread (SimCore::applySettings). A capture carries the tag that
+    // was current when it triggered; the writer only sees that copy.
+    void setSettingsTag(std::string s) { settings_ = std::move(s); }
+
+    // Hot path: any thread, lock-free.
+    void record(TraceKind k, std::int64_t frame, std::uint16_t thread, std::uint32_t arg) {
+        std::uint64_t slot = head_.fetch_add(1, std::memory_order_relaxed);
+        Slot& s = ring_[slot & mask_];
+        s.seq.store(2 * slot + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.ev.tsNs   = nowNs();
+        s.ev.frame  = frame;
+        s.ev.kind   = k;
+        s.ev.thread = thread;
+        s.ev.arg    = arg;
+        s.seq.store(2 * slot + 2, std::memory_order_release);
+    }
+
+    // Main thread, before any event of `frame` is recorded.
+    void beginFrame(std::int64_t frame) {
+        frameStart_[index(frame)] = head_.load(std::memory_order_relaxed);
+        lastFrame_ = frame;
+    }
+
+    // Main thread, once per paced frame, after its catch-up steps; `frame`
+    // is the paced frame the lateness and drift were measured for. May
+    // freeze a window.
+    void endFrame(std::int64_t frame, std::int64_t latenessNs, double driftMs) {
+        double jump = havePrevDrift_ ? driftMs - prevDriftMs_ : 0.0;
+        prevDriftMs_ = driftMs;
+        havePrevDrift_ = true;
+
+        if (pending_) {
+            if (lastFrame_ >= pendingHdr_.triggerFrame +
+                              static_cast<std::int64_t>(cfg_.framesAfter))
+                freeze();
+            return;
+        }
+        if (captures_ >= cfg_.maxCaptures) return;
+
+        std::uint32_t reason = 0;
+        if (double(latenessNs) / 1e6 > cfg_.latenessMs) reason |= TraceFileHeader::Lateness;
+        if (std::abs(jump) > cfg_.driftJumpMs)          reason |= TraceFileHeader::DriftJump;
+        if (!reason) return;
+
+        pendingHdr_ = TraceFileHeader{};
+        pendingHdr_.triggerFrame = frame;
+        pendingHdr_.latenessNs   = latenessNs;
+        pendingHdr_.driftMs      = driftMs;
+        pendingHdr_.driftJumpMs  = jump;
+        pendingHdr_.reason       = reason;
+        pendingSettings_ = settings_;
+        pending_ = true;
+        ++captures_;
+        if (cfg_.framesAfter == 0) freeze();
+    }
+
+    int captures() const { return captures_; }
+
+    // Block until queued captures are on disk.
+    void flush() {
+        std::unique_lock<std::mutex> lk(m_);
+        idleCv_.wait(lk, [this]{ return queue_.empty() && !writing_; });
+    }
+
+    std::vector<std::string> writtenFiles() const {
+        std::lock_guard<std::mutex> lk(m_);
+        return written_;
+    }
+
+    static bool readFile(const std::string& path, TraceFileHeader& hdr,
+                         std::string& settings, std::vector<TraceEvent>& events) {
+        std::FILE* f = std::fopen(path.c_str(), "rb");
+        if (!f) return false;
+        bool ok = std::fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+                  hdr.magic == TraceFileHeader::kMagic &&
+                  hdr.version == TraceFileHeader::kVersion;
+        if (ok) {
+            settings.resize(hdr.settingsLen);
+            events.resize(hdr.eventCount);
+            ok = (hdr.settingsLen == 0 ||
+                  std::fread(settings.data(), 1, hdr.settingsLen, f) == hdr.settingsLen) &&
+                 (hdr.eventCount == 0 ||
+                  std::fread(events.data(), sizeof(TraceEvent), hdr.eventCount, f) == hdr.eventCount);
+        }
+        std::fclose(f);
+        return ok;
+    }
+
+private:
+    struct Capture {
+        TraceFileHeader         hdr;
+        std::vector<TraceEvent> events;
+        std::string             settings;   // tag at trigger time
+    };
+
+    // seq is 2 * position + 1 while the event at ring position `position`
+    // is being written, 2 * position + 2 once it is complete.
+    struct Slot {
+        std::atomic<std::uint64_t> seq{0};
+        TraceEvent                 ev;
+    };
+
+    static std::uint64_t nowNs() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    std::size_t index(std::int64_t frame) const {
+        return static_cast<std::size_t>(frame) % frameStart_.size();
+    }
+
+    // Copy the window out of the ring; the file write happens off-thread.
+    void freeze() {
+        pending_ = false;
+        std::int64_t first = pendingHdr_.triggerFrame - static_cast<std::int64_t>(cfg_.framesBefore);
+        if (first < 0) first = 0;
+        std::uint64_t end = head_.load(std::memory_order_acquire);
+        std::uint64_t begin = frameStart_[index(first)];
+        if (end - begin > capacity_) {
+            begin = end - capacity_;
+            pendingHdr_.truncated = 1;
+        }
+        pendingHdr_.firstFrame = first;
+        pendingHdr_.lastFrame  = lastFrame_;
+
+        scratch_.clear();
+        for (std::uint64_t i = begin; i < end; ++i) {
+            TraceEvent e;
+            if (readSlot(i, e)) scratch_.push_back(e);
+        }
+
+        Capture c{pendingHdr_, {}, std::move(pendingSettings_)};
+        c.events.swap(scratch_);
+        scratch_.reserve(capacity_);
+        {
+            std::lock_guard<std::mutex> lk(m_);
+            queue_.push_back(std::move(c));
+        }
+        cv_.notify_one();
+    }
+
+    // Copy of the event at ring position i; false if it was overwritten or
+    // its writer did not finish within a short spin.
+    bool readSlot(std::uint64_t i, TraceEvent& out) const {
+        const Slot& s = ring_[i & mask_];
+        const std::uint64_t done = 2 * i + 2;
+        for (int spin = 0; spin < 1000; ++spin) {
+            std::uint64_t s1 = s.seq.load(std::memory_order_acquire);
+            if (s1 > done) return false;                 // lapped by a newer event
+            if (s1 == done) {
+                out = s.ev;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (s.seq.load(std::memory_order_relaxed) == done) return true;
+                return false;
+            }
+            std::this_thread::yield();                   // reserved or mid-write
+        }
+        return false;
+    }
+
+    void writerLoop() {
+        std::unique_lock<std::mutex> lk(m_);
+        for (;;) {
+            cv_.wait(lk, [this]{ return stop_ || !queue_.empty(); });
+            if (queue_.empty()) { if (stop_) break; continue; }
+            Capture c = std::move(queue_.front());
+            queue_.pop_front();
+            writing_ = true;
+            lk.unlock();
+            std::string path = writeCapture(c);
+            lk.lock();
+            writing_ = false;
+            if (!path.empty()) written_.push_back(path);
+            idleCv_.notify_all();
+        }
+        idleCv_.notify_all();
+    }
+
+    // Written to a .tmp sibling and renamed only once every byte is out,
+    // so a listed capture is never truncated.
+    std::string writeCapture(Capture& c) {
+        std::string path = cfg_.pathPrefix + "_f" + std::to_string(c.hdr.triggerFrame) + ".sctrace";
+        std::string tmp  = path + ".tmp";
+        const std::string& settings = c.settings;
+        c.hdr.settingsLen = static_cast<std::uint32_t>(settings.size());
+        c.hdr.eventCount  = static_cast<std::uint32_t>(c.events.size());
+        bool ok = false;
+        if (cfg_.io) {
+            AsyncIO::FileId fd = cfg_.io->open(tmp, true);
+            if (fd < 0) return {};
+            ok = cfg_.io->writeWait(fd, &c.hdr, sizeof(c.hdr)) &&
+                 cfg_.io->writeWait(fd, settings) &&
+                 cfg_.io->writeWait(fd, c.events.data(), c.events.size() * sizeof(TraceEvent));
+            ok = cfg_.io->close(fd) && ok;
+        } else {
+            std::FILE* f = std::fopen(tmp.c_str(), "wb");
+            if (!f) return {};
+            ok = std::fwrite(&c.hdr, sizeof(c.hdr), 1, f) == 1;
+            if (ok && !settings.empty())
+                ok = std::fwrite(settings.data(), 1, settings.size(), f) == settings.size();
+            if (ok && !c.events.empty())
+                ok = std::fwrite(c.events.data(), sizeof(TraceEvent), c.events.size(), f) == c.events.size();
+            ok = std::fclose(f) == 0 && ok;
+        }
+        if (ok && std::rename(tmp.c_str(), path.c_str()) == 0) return path;
+        std::remove(tmp.c_str());
+        return {};
+    }
+
+    Config                     cfg_;
+    std::unique_ptr<Slot[]>    ring_;
+    std::size_t                capacity_ = 0;
+    std::uint64_t              mask_ = 0;
+    std::atomic<std::uint64_t> head_{0};
+    std::vector<std::uint64_t> frameStart_;
+    std::vector<TraceEvent>    scratch_;
+    std::string                settings_;
+
+    std::int64_t    lastFrame_     = 0;
+    double          prevDriftMs_   = 0.0;
+    bool            havePrevDrift_ = false;
+    bool            pending_       = false;
+    TraceFileHeader pendingHdr_{};
+    std::string     pendingSettings_;
+    int             captures_      = 0;
+
+    mutable std::mutex      m_;
+    std::condition_variable cv_, idleCv_;
+    std::deque<Capture>     queue_;
+    std::vector<std::string> written_;
+    bool                    writing_ = false;
+    bool                    stop_    = false;
+    std::thread             writer_;
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "SimCore.hpp"
+#include "simd.hpp"
+
+// Batched Pacejka Magic Formula tyre forces over SoA wheel columns.
+//   F(x) = D * Fz * sin(C * atan(B*x - E*(B*x - atan(B*x))))
+// with x the slip ratio (Fx) or slip angle in rad (Fy), D the peak friction
+// coefficient scaled per wheel by grip (surface). With `combined`, the
+// pair is clamped to the friction ellipse. evaluate() is the vectorized
+// kernel (simd::atan / simd::sin); evaluateReference() uses libm and is the
+// accuracy baseline.
+class TyreBatch {
+public:
+    struct Coeffs {
+        double B = 10.0;   // stiffness
+        double C = 1.9;    // shape
+        double D = 1.0;    // peak friction coefficient
+        double E = 0.97;   // curvature
+    };
+
+    struct Config {
+        Coeffs lon{10.0, 1.65, 1.0, 0.97};
+        Coeffs lat{ 8.0, 1.30, 0.95, -0.5};
+        bool   combined = true;
+    };
+
+    TyreBatch(std::size_t wheels, const Config& cfg)
+        : slipRatio(wheels, 0.0), slipAngle(wheels, 0.0), load(wheels, 0.0),
+          grip(wheels, 1.0), fx(wheels, 0.0), fy(wheels, 0.0), cfg_(cfg) {}
+    explicit TyreBatch(std::size_t wheels) : TyreBatch(wheels, Config{}) {}
+
+    const Config& config() const { return cfg_; }
+    std::size_t size() const { return load.size(); }
+
+    // Inputs
+    std::vector<double> slipRatio;   // kappa
+    std::vector<double> slipAngle;   // alpha, rad
+    std::vector<double> load;        // Fz, N
+    std::vector<double> grip;        // surface friction scale
+    // Outputs
+    std::vector<double> fx, fy;      // N
+
+    static double magicFormula(const Coeffs& c, double x, double fz) {
+        const double bx = c.B * x;
+        return c.D * fz * std::sin(c.C * std::atan(bx - c.E * (bx - std::atan(bx))));
+    }
+
+    void evaluate(std::size_t b, std::size_t e) {
+        if (cfg_.combined) kernel<true>(b, e);
+        else               kernel<false>(b, e);
+    }
+
+    void evaluateReference(std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; ++i) {
+            const double z = std::max(load[i], 0.0) * grip[i];
+            double x = magicFormula(cfg_.lon, slipRatio[i], z);
+            double y = magicFormula(cfg_.lat, slipAngle[i], z);
+            if (cfg_.combined) {
+                const double px = cfg_.lon.D * z, py = cfg_.lat.D * z;
+                const double nx = px > 0.0 ? x / px : 0.0;
+                const double ny = py > 0.0 ? y / py : 0.0;
+                const double n2 = nx * nx + ny * ny;
+                if (n2 > 1.0) { const double s = 1.0 / std::sqrt(n2); x *= s; y *= s; }
+            }
+            fx[i] = x;
+            fy[i] = y;
+        }
+    }
+
+    // One range task over all wheels in `phase`; inputs are expected to be
+    // written by an earlier phase (or serial subsystem) of the same frame.
+    void install(SimCore& sim, std::size_t phase) {
+        sim.setPhaseElementCount(phase, size());
+        sim.addParallelRangeTask(phase, [this](std::size_t b, std::size_t e,
+                                               std::int64_t, SimCore::Seconds){
+            evaluate(b, e);
+        });
+    }
+
+private:
+    template <bool Combined>
+    void kernel(std::size_t b, std::size_t e) {
+        const Coeffs lo = cfg_.lon, la = cfg_.lat;
+        const double* kap = slipRatio.data();
+        const double* alp = slipAngle.data();
+        const double* fz  = load.data();
+        const double* mu  = grip.data();
+        double* ox = fx.data();
+        double* oy = fy.data();
+        SIMCORE_SIMD_LOOP
+        for (std::size_t i = b; i < e; ++i) {
+            const double z  = simd::max(fz[i], 0.0) * mu[i];
+            const double bx = lo.B * kap[i];
+            const double by = la.B * alp[i];
+            double x = lo.D * z * simd::sin(lo.C * simd::atan(bx - lo.E * (bx - simd::atan(bx))));
+            double y = la.D * z * simd::sin(la.C * simd::atan(by - la.E * (by - simd::atan(by))));
+            if constexpr (Combined) {
+                // Friction ellipse; z == 0 gives x == y == 0 and s == 1.
+                const double rz = 1.0 / simd::max(z, 1e-300);
+                const double nx = x * rz / lo.D, ny = y * rz / la.D;
+                const double s  = 1.0 / std::sqrt(simd::max(nx * nx + ny * ny, 1.0));
+                x *= s; y *= s;
+            }
+            ox[i] = x;
+            oy[i] = y;
+        }
+    }
+
+    Config cfg_;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <cstdint>
+
+// USDT (SystemTap SDT v3) static tracepoints without <sys/sdt.h>.
+// Each probe is a single nop plus a .note.stapsdt entry describing where
+// its arguments live; perf / bpftrace patch the nop only while attached.
+//
+//   SIMCORE_PROBE1(frame_end, frame_);
+//   bpftrace -e 'usdt:./simcore_app:simcore:frame_end { @last = arg0; }'
+//
+// Arguments are widened to 64-bit signed integers (pointers to uintptr).
+
+#if defined(SIMCORE_USDT) && defined(__linux__) && \
+    (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__aarch64__))
+
+#define SIMCORE_USDT_STR_(x) #x
+#define SIMCORE_USDT_STR(x) SIMCORE_USDT_STR_(x)
+
+#define SIMCORE_USDT_NOTE(name, argfmt)                                         \
+    "990: nop\n"                                                                \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n"                               \
+    ".balign 4\n"                                                               \
+    ".4byte 992f-991f, 994f-993f, 3\n"                                          \
+    "991: .asciz \"stapsdt\"\n"                                                 \
+    "992: .balign 4\n"                                                          \
+    "993: .8byte 990b\n"                                                        \
+    ".8byte _.stapsdt.base\n"                                                   \
+    ".8byte 0\n"                                                                \
+    ".asciz \"simcore\"\n"                                                      \
+    ".asciz \"" SIMCORE_USDT_STR(name) "\"\n"                                   \
+    ".asciz \"" argfmt "\"\n"                                                   \
+    "994: .balign 4\n"                                                          \
+    ".popsection\n"                                                             \
+    ".ifndef _.stapsdt.base\n"                                                  \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n"     \
+    ".weak _.stapsdt.base\n"                                                    \
+    ".hidden _.stapsdt.base\n"                                                  \
+    "_.stapsdt.base: .space 1\n"                                                \
+    ".size _.stapsdt.base, 1\n"                                                 \
+    ".popsection\n"                                                             \
+    ".endif\n"
+
+#define SIMCORE_USDT_ARG(x) "nor"(static_cast<std::int64_t>(x))
+
+#define SIMCORE_PROBE0(name) \
+    __asm__ __volatile__(SIMCORE_USDT_NOTE(name, ""))
+#define SIMCORE_PROBE1(name, a) \
+    __asm__ __volatile__(SIMCORE_USDT_NOTE(name, "-8@%0") \
+        :: SIMCORE_USDT_ARG(a))
+#define SIMCORE_PROBE2(name, a, b) \
+    __asm__ __volatile__(SIMCORE_USDT_NOTE(name, "-8@%0 -8@%1") \
+        :: SIMCORE_USDT_ARG(a), SIMCORE_USDT_ARG(b))
+#define SIMCORE_PROBE3(name, a, b, c) \
+    __asm__ __volatile__(SIMCORE_USDT_NOTE(name, "-8@%0 -8@%1 -8@%2") \
+        :: SIMCORE_USDT_ARG(a), SIMCORE_USDT_ARG(b), SIMCORE_USDT_ARG(c))
+#define SIMCORE_PROBE4(name, a, b, c, d) \
+    __asm__ __volatile__(SIMCORE_USDT_NOTE(name, "-8@%0 -8@%1 -8@%2 -8@%3") \
+        :: SIMCORE_USDT_ARG(a), SIMCORE_USDT_ARG(b), SIMCORE_USDT_ARG(c), SIMCORE_USDT_ARG(d))
+
+#define SIMCORE_USDT_PTR(p) reinterpret_cast<std::uintptr_t>(p)
+
+#else
+
+#define SIMCORE_PROBE0(name) do{}while(0)
+#define SIMCORE_PROBE1(name, a) do{ (void)(a); }while(0)
+#define SIMCORE_PROBE2(name, a, b) do{ (void)(a); (void)(b); }while(0)
+#define SIMCORE_PROBE3(name, a, b, c) do{ (void)(a); (void)(b); (void)(c); }while(0)
+#define SIMCORE_PROBE4(name, a, b, c, d) do{ (void)(a); (void)(b); (void)(c); (void)(d); }while(0)
+#define SIMCORE_USDT_PTR(p) (p)
+
+#endif
@@ -0,0 +1,179 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "SimCore.hpp"
+
+// Synthetic workloads for scheduler evaluation. Each element carries an
+// integer cost (units of kernel work) drawn from a configurable
+// distribution; the kernel is compute-bound (dependent sqrt/FMA chain) or
+// memory-bound (dependent loads through a table larger than LLC). All
+// work is registered through the normal Phase API, so every scheduling
+// mode runs the same inputs. Output is deterministic for a given config.
+class SyntheticWorkload {
+public:
+    enum class Dist   { Uniform, HeavyTailed, Hotspots, TimeVarying };
+    enum class Kernel { Compute, Memory };
+    enum class Shape  { Single, MultiTask, Pipeline };
+
+    struct Config {
+        Dist          dist          = Dist::Uniform;
+        Kernel        kernel        = Kernel::Compute;
+        Shape         shape         = Shape::Single;
+        unsigned      baseCost      = 16;        // units per element
+        double        tailAlpha     = 1.5;       // Pareto shape (HeavyTailed)
+        unsigned      maxFactor     = 1000;      // cap on cost / baseCost
+        std::size_t   hotspots      = 4;         // Hotspots / TimeVarying
+        double        hotspotWidth  = 0.01;      // fraction of elements per hot spot
+        unsigned      hotspotFactor = 50;
+        std::int64_t  periodFrames  = 200;       // TimeVarying: frames per sweep
+        std::size_t   stages        = 3;         // MultiTask tasks / Pipeline phases
+        std::size_t   tableBytes    = 64u << 20; // Memory kernel working set
+        std::uint64_t seed          = 12345;
+    };
+
+    SyntheticWorkload(std::size_t n, const Config& cfg)
+        : cfg_(cfg), cost_(n), in_(n), out_(n, 0.0) {
+        std::uint64_t s = cfg_.seed;
+        for (std::size_t i = 0; i < n; ++i) {
+            in_[i] = 0.1 + 0.8 * uniform(s);
+            double c = cfg_.baseCost;
+            if (cfg_.dist == Dist::HeavyTailed)
+                c *= std::min<double>(cfg_.maxFactor, std::pow(1.0 - uniform(s), -1.0 / cfg_.tailAlpha));
+            cost_[i] = std::max(1u, static_cast<unsigned>(c));
+        }
+        width_ = std::max<std::size_t>(1, static_cast<std::size_t>(cfg_.hotspotWidth * double(n)));
+        if (cfg_.dist == Dist::Hotspots) {
+            for (std::size_t h = 0; h < cfg_.hotspots && n; ++h) {
+                std::size_t c = static_cast<std::size_t>(uniform(s) * double(n)) % n;
+                for (std::size_t i = c; i < std::min(n, c + width_); ++i)
+                    cost_[i] = cfg_.baseCost * cfg_.hotspotFactor;
+            }
+        }
+        if (cfg_.kernel == Kernel::Memory) buildTable(s);
+    }
+
+    explicit SyntheticWorkload(std::size_t n) : SyntheticWorkload(n, Config{}) {}
+
+    // "heavy+memory+pipeline" (or comma-separated) -> Config; unknown tokens fail.
+    static bool parse(std::string spec, Config& cfg) {
+        std::replace(spec.begin(), spec.end(), ',', '+');
+        std::stringstream ss(spec);
+        std::string tok;
+        while (std::getline(ss, tok, '+')) {
+            if      (tok == "uniform")   cfg.dist   = Dist::Uniform;
+            else if (tok == "heavy")     cfg.dist   = Dist::HeavyTailed;
+            else if (tok == "hotspots")  cfg.dist   = Dist::Hotspots;
+            else if (tok == "varying")   cfg.dist   = Dist::TimeVarying;
+            else if (tok == "compute")   cfg.kernel = Kernel::Compute;
+            else if (tok == "memory")    cfg.kernel = Kernel::Memory;
+            else if (tok == "single")    cfg.shape  = Shape::Single;
+            else if (tok == "multitask") cfg.shape  = Shape::MultiTask;
+            else if (tok == "pipeline")  cfg.shape  = Shape::Pipeline;
+            else if (!tok.empty()) return false;
+        }
+        return true;
+    }
+
+    void install(SimCore& sim) {
+        const std::size_t n = cost_.size();
+        const std::size_t stages = std::max<std::size_t>(1, cfg_.stages);
+        auto range = [this](std::size_t b, std::size_t e, std::int64_t f, SimCore::Seconds) {
+            for (std::size_t i = b; i < e; ++i) out_[i] = work(i, f);
+        };
+        switch (cfg_.shape) {
+        case Shape::Single: {
+            auto ph = sim.addPhase("Synth", n);
+            sim.addParallelRangeTask(ph, range);
+            break;
+        }
+        case Shape::MultiTask: {
+            // Several waves in one phase, each with its own barrier.
+            auto ph = sim.addPhase("Synth", n);
+            for (std::size_t t = 0; t < stages; ++t) sim.addParallelRangeTask(ph, range);
+            break;
+        }
+        case Shape::Pipeline: {
+            // Serial preamble, then parallel stages each closed by a reduction.
+            auto pre = sim.addPhase("SynthInput");
+            sim.addSerialSubsystem(pre, [this](std::int64_t f, SimCore::Seconds) {
+                if (!in_.empty()) in_[static_cast<std::size_t>(f) % in_.size()] += 1e-9;
+            });
+            for (std::size_t t = 0; t < stages; ++t) {
+                auto ph = sim.addPhase("SynthStage" + std::to_string(t), n);
+                sim.addParallelRangeTask(ph, range);
+                sim.addReductionTask(ph, [this](std::int64_t, SimCore::Seconds) {
+                    double s = 0.0;
+                    for (double v : out_) s += v;
+                    checksum_ = s;
+                });
+            }
+            break;
+        }
+        }
+    }
+
+    // Effective cost of element i in frame f (TimeVarying hot spots sweep
+    // across the range once per periodFrames).
+    unsigned costAt(std::size_t i, std::int64_t f) const {
+        if (cfg_.dist != Dist::TimeVarying || cfg_.hotspots == 0) return cost_[i];
+        const std::size_t n = cost_.size();
+        const std::int64_t period = std::max<std::int64_t>(1, cfg_.periodFrames);
+        const std::size_t shift = static_cast<std::size_t>(double(f % period) / double(period) * double(n));
+        const std::size_t pos = (i + n - shift % n) % n;
+        const std::size_t spacing = std::max<std::size_t>(1, n / cfg_.hotspots);
+        return (pos % spacing) < width_ ? cost_[i] * cfg_.hotspotFactor : cost_[i];
+    }
+
+    std::uint64_t totalUnits(std::int64_t frame = 0) const {
+        std::uint64_t t = 0;
+        for (std::size_t i = 0; i < cost_.size(); ++i) t += costAt(i, frame);
+        return t;
+    }
+
+    const std::vector<unsigned>& costs() const { return cost_; }
+    const std::vector<double>& output() const { return out_; }
+    double checksum() const { return checksum_; }
+    const Config& config() const { return cfg_; }
+
+private:
+    static double uniform(std::uint64_t& s) {
+        s ^= s << 13; s ^= s >> 7; s ^= s << 17;
+        return double(s >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    void buildTable(std::uint64_t& s) {
+        // Single-cycle random permutation (Sattolo): every load depends on
+        // the previous one and lands on an unpredictable line.
+        std::size_t m = std::max<std::size_t>(2, cfg_.tableBytes / sizeof(std::uint32_t));
+        table_.resize(m);
+        for (std::size_t i = 0; i < m; ++i) table_[i] = static_cast<std::uint32_t>(i);
+        for (std::size_t i = m - 1; i > 0; --i) {
+            std::size_t j = static_cast<std::size_t>(uniform(s) * double(i));
+            std::swap(table_[i], table_[j]);
+        }
+    }
+
+    double work(std::size_t i, std::int64_t f) const {
+        const unsigned units = costAt(i, f);
+        double v = in_[i];
+        if (cfg_.kernel == Kernel::Compute) {
+            for (unsigned k = 0; k < units; ++k) v = v * 0.999 + std::sqrt(v + 1.0) * 1e-3;
+        } else {
+            std::uint32_t idx = static_cast<std::uint32_t>((i * 2654435761u) % table_.size());
+            for (unsigned k = 0; k < units; ++k) idx = table_[idx];
+            v += double(idx) * 1e-12;
+        }
+        return v;
+    }
+
+    Config                     cfg_;
+    std::vector<unsigned>      cost_;
+    std::vector<double>        in_, out_;
+    std::vector<std::uint32_t> table_;
+    std::size_t                width_ = 1;
+    double                     checksum_ = 0.0;
+};
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Synthetic local interference for soak runs. Each kind runs on its own
+// threads until stop(); CPU time of the load threads is reported so it can
+// be separated from the simulator's own consumption.
+class BackgroundLoad {
+public:
+    enum class Kind { MemBandwidth, CacheThrash, SyscallStorm };
+
+    static bool parseKind(const std::string& s, Kind& k) {
+        if (s == "membw")   { k = Kind::MemBandwidth; return true; }
+        if (s == "cache")   { k = Kind::CacheThrash;  return true; }
+        if (s == "syscall") { k = Kind::SyscallStorm; return true; }
+        return false;
+    }
+
+    ~BackgroundLoad() { stop(); }
+
+    void start(Kind k, std::size_t threads, std::size_t bufferBytes = 64u << 20) {
+        for (std::size_t i = 0; i < threads; ++i)
+            threads_.emplace_back([this, k, bufferBytes, i]{ run(k, bufferBytes, i); });
+    }
+
+    void stop() {
+        stop_.store(true, std::memory_order_relaxed);
+        for (auto& t : threads_) t.join();
+        threads_.clear();
+    }
+
+    double cpuSeconds() const { return double(cpuNs_.load()) / 1e9; }
+    std::uint64_t operations() const { return ops_.load(); }
+
+private:
+    static std::uint64_t threadCpuNs() {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return std::uint64_t(ts.tv_sec) * 1'000'000'000ull + std::uint64_t(ts.tv_nsec);
+    }
+
+    void run(Kind k, std::size_t bytes, std::size_t seed) {
+        std::uint64_t ops = 0;
+        switch (k) {
+        case Kind::MemBandwidth: {
+            // Stream two buffers far larger than LLC back and forth.
+            std::vector<char> a(bytes, 1), b(bytes, 2);
+            while (!stop_.load(std::memory_order_relaxed)) {
+                std::memcpy(a.data(), b.data(), bytes);
+                std::memcpy(b.data(), a.data(), bytes);
+                ops += 2;
+            }
+            break;
+        }
+        case Kind::CacheThrash: {
+            // Dependent random read-modify-writes: evicts lines, defeats prefetch.
+            std::size_t n = bytes / sizeof(std::uint64_t);
+            std::vector<std::uint64_t> buf(n);
+            for (std::size_t i = 0; i < n; ++i) buf[i] = i * 2654435761u;
+            std::uint64_t x = 0x9E3779B97F4A7C15ull ^ seed;
+            while (!stop_.load(std::memory_order_relaxed)) {
+                for (int i = 0; i < 4096; ++i) {
+                    x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+                    auto& v = buf[(x ^ buf[x % n]) % n];
+                    v += x;
+                }
+                ops += 4096;
+            }
+            break;
+        }
+        case Kind::SyscallStorm: {
+            int fd = ::open("/dev/null", O_WRONLY);
+            char byte = 0;
+            while (!stop_.load(std::memory_order_relaxed)) {
+                ::syscall(SYS_getppid);
+                if (fd >= 0 && ::write(fd, &byte, 1) < 0) break;
+                ::sched_yield();
+                ops += 3;
+            }
+            if (fd >= 0) ::close(fd);
+            break;
+        }
+        }
+        ops_.fetch_add(ops);
+        cpuNs_.fetch_add(threadCpuNs());
+    }
+
+    std::vector<std::thread>   threads_;
+    std::atomic<bool>          stop_{false};
+    std::atomic<std::uint64_t> cpuNs_{0};
+    std::atomic<std::uint64_t> ops_{0};
+};
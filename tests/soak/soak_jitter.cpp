@@ -0,0 +1,166 @@
+// Real-time jitter soak: runs the paced loop for minutes to hours and
+// reports the full frame-lateness distribution, deadline misses, max
+// drift and the CPU cost of pacing, optionally under synthetic load.
+//
+//   simcore_soak --seconds 3600 --hz 1000 --load membw,cache --load-threads 2
+//
+// Exit code is non-zero when --max-miss-rate / --max-drift-ms are exceeded.
+#include "simcore.hpp"
+#include "logger.hpp"
+#include "histogram.hpp"
+#include "background_load.hpp"
+#include "bench_common.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <sys/resource.h>
+
+static double parseDouble(const char* s, double def){ if(!s) return def; char* e=nullptr; double v=strtod(s,&e); return (e && *e==0)? v: def; }
+static long   parseLong  (const char* s, long def){ if(!s) return def; char* e=nullptr; long v=strtol(s,&e,10); return (e && *e==0)? v: def; }
+
+static double cpuSeconds(clockid_t id) {
+    timespec ts{};
+    clock_gettime(id, &ts);
+    return double(ts.tv_sec) + double(ts.tv_nsec) / 1e9;
+}
+
+static double processCpuSeconds() {
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    auto tv = [](timeval t){ return double(t.tv_sec) + double(t.tv_usec) / 1e6; };
+    return tv(ru.ru_utime) + tv(ru.ru_stime);
+}
+
+static void printPercentiles(const char* label, const LogHistogram& h) {
+    std::printf("  %-14s p50=%9.1f p90=%9.1f p99=%9.1f p99.9=%9.1f p99.99=%9.1f max=%9.1f us\n",
+                label,
+                double(h.percentile(0.50)) / 1e3, double(h.percentile(0.90)) / 1e3,
+                double(h.percentile(0.99)) / 1e3, double(h.percentile(0.999)) / 1e3,
+                double(h.percentile(0.9999)) / 1e3, double(h.max()) / 1e3);
+}
+
+int main(int argc, char* argv[]) {
+    SimCore::Settings cfg;
+    cfg.hz = 1000.0;
+    cfg.threads = std::max<std::size_t>(2, std::thread::hardware_concurrency() / 2);
+    cfg.chunkSize = 256;
+    cfg.driftLogInterval = 0;
+    cfg.maxCatchUp = 4;
+    double seconds = 60.0;
+    std::size_t elements = 20000;
+    std::string loads;
+    std::size_t loadThreads = 1;
+    double maxMissRate = -1.0, maxDriftMs = -1.0;
+    const char* histPath = nullptr;
+
+    for (int i=1;i<argc;++i){
+        if (std::strcmp(argv[i],"--seconds")==0 && i+1<argc) seconds = parseDouble(argv[++i], seconds);
+        else if (std::strcmp(argv[i],"--hz")==0 && i+1<argc) cfg.hz = parseDouble(argv[++i], cfg.hz);
+        else if (std::strcmp(argv[i],"--threads")==0 && i+1<argc) cfg.threads = (std::size_t)parseLong(argv[++i], (long)cfg.threads);
+        else if (std::strcmp(argv[i],"--chunk")==0 && i+1<argc) cfg.chunkSize = (std::size_t)parseLong(argv[++i], (long)cfg.chunkSize);
+        else if (std::strcmp(argv[i],"--elements")==0 && i+1<argc) elements = (std::size_t)parseLong(argv[++i], (long)elements);
+        else if (std::strcmp(argv[i],"--adaptive")==0 && i+1<argc) cfg.adaptive = (std::atoi(argv[++i])!=0);
+        else if (std::strcmp(argv[i],"--maxCatchUp")==0 && i+1<argc) cfg.maxCatchUp = (int)parseLong(argv[++i], cfg.maxCatchUp);
+        else if (std::strcmp(argv[i],"--spinMicros")==0 && i+1<argc) cfg.spinMicros = (int)parseLong(argv[++i], cfg.spinMicros);
+        else if (std::strcmp(argv[i],"--load")==0 && i+1<argc) loads = argv[++i];
+        else if (std::strcmp(argv[i],"--load-threads")==0 && i+1<argc) loadThreads = (std::size_t)parseLong(argv[++i], (long)loadThreads);
+        else if (std::strcmp(argv[i],"--max-miss-rate")==0 && i+1<argc) maxMissRate = parseDouble(argv[++i], maxMissRate);
+        else if (std::strcmp(argv[i],"--max-drift-ms")==0 && i+1<argc) maxDriftMs = parseDouble(argv[++i], maxDriftMs);
+        else if (std::strcmp(argv[i],"--hist")==0 && i+1<argc) histPath = argv[++i];
+        else {
+            std::fprintf(stderr,
+                "usage: %s [--seconds S] [--hz HZ] [--threads T] [--chunk C] [--elements N]\n"
+                "          [--adaptive 0|1] [--maxCatchUp K] [--spinMicros US]\n"
+                "          [--load membw,cache,syscall] [--load-threads N]\n"
+                "          [--max-miss-rate FRAC] [--max-drift-ms MS] [--hist lateness.csv]\n", argv[0]);
+            return 2;
+        }
+    }
+    cfg.maxFrames = static_cast<std::int64_t>(seconds * cfg.hz);
+
+    BackgroundLoad load;
+    std::stringstream ls(loads);
+    std::string kindName;
+    while (std::getline(ls, kindName, ',')) {
+        BackgroundLoad::Kind k;
+        if (!BackgroundLoad::parseKind(kindName, k)) {
+            std::fprintf(stderr, "unknown load '%s' (membw, cache, syscall)\n", kindName.c_str());
+            return 2;
+        }
+        load.start(k, loadThreads);
+    }
+
+    Logger log; log.setLevel(Logger::Level::Error);
+    SimCore sim(cfg);
+    sim.setLogger(&log);
+
+    PhysicsWorkload work(elements);
+    work.install(sim);
+
+    LogHistogram lateHist, wakeHist, computeHist;
+    std::uint64_t frames = 0, missed = 0, catchUpFrames = 0, catchUpSteps = 0;
+    double maxAbsDrift = 0.0, computeSeconds = 0.0;
+    sim.setFrameObserver([&](const SimCore::FrameTiming& t){
+        ++frames;
+        if (t.latenessNs > 0) { ++missed; lateHist.record(std::uint64_t(t.latenessNs)); }
+        else lateHist.record(0);
+        wakeHist.record(t.wakeErrorNs > 0 ? std::uint64_t(t.wakeErrorNs) : 0);
+        computeHist.record(std::uint64_t(t.computeNs));
+        computeSeconds += double(t.computeNs) / 1e9;
+        if (t.catchUpSteps) { ++catchUpFrames; catchUpSteps += std::uint64_t(t.catchUpSteps); }
+        maxAbsDrift = std::max(maxAbsDrift, std::fabs(t.driftMs));
+    });
+
+    double proc0 = processCpuSeconds();
+    double main0 = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    auto wall0 = std::chrono::steady_clock::now();
+    sim.run();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    double mainCpu = cpuSeconds(CLOCK_THREAD_CPUTIME_ID) - main0;
+    load.stop();
+    double procCpu = processCpuSeconds() - proc0;
+    double simCpu  = procCpu - load.cpuSeconds();
+    double missRate = frames ? double(missed) / double(frames) : 0.0;
+
+    std::printf("SimCore soak: %.1fs wall, %llu paced frames @ %.1f Hz, threads=%zu elements=%zu adaptive=%d load=%s x%zu\n",
+                wall, (unsigned long long)frames, cfg.hz, cfg.threads, elements, (int)cfg.adaptive,
+                loads.empty() ? "none" : loads.c_str(), loadThreads);
+    std::printf("  missed deadlines: %llu (%.4f%%)  catch-up frames: %llu (+%llu steps)  max |drift|: %.3f ms\n",
+                (unsigned long long)missed, missRate * 100.0,
+                (unsigned long long)catchUpFrames, (unsigned long long)catchUpSteps, maxAbsDrift);
+    printPercentiles("lateness", lateHist);
+    printPercentiles("wake error", wakeHist);
+    printPercentiles("compute", computeHist);
+    // Main-thread CPU not spent computing frames is what pacing (sleep/spin) costs.
+    std::printf("  cpu: sim %.1f%% of one core (main %.1f%%, pacing %.1f%%), load threads %.1f%%\n",
+                100.0 * simCpu / wall, 100.0 * mainCpu / wall,
+                100.0 * std::max(0.0, mainCpu - computeSeconds) / wall,
+                100.0 * load.cpuSeconds() / wall);
+
+    if (histPath) {
+        if (std::FILE* f = std::fopen(histPath, "w")) {
+            std::fprintf(f, "lateness_lo_ns,lateness_hi_ns,count\n");
+            for (std::size_t i = 0; i < LogHistogram::kBuckets; ++i)
+                if (auto c = lateHist.bucketCount(i))
+                    std::fprintf(f, "%llu,%llu,%llu\n",
+                                 (unsigned long long)LogHistogram::lowerBound(i),
+                                 (unsigned long long)(LogHistogram::lowerBound(i) + LogHistogram::width(i)),
+                                 (unsigned long long)c);
+            std::fclose(f);
+        }
+    }
+
+    int rc = 0;
+    if (maxMissRate >= 0.0 && missRate > maxMissRate) {
+        std::printf("FAIL: miss rate %.4f%% > %.4f%%\n", missRate * 100.0, maxMissRate * 100.0);
+        rc = 1;
+    }
+    if (maxDriftMs >= 0.0 && maxAbsDrift > maxDriftMs) {
+        std::printf("FAIL: max drift %.3f ms > %.3f ms\n", maxAbsDrift, maxDriftMs);
+        rc = 1;
+    }
+    return rc;
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "aero.hpp"
+#include <random>
+
+namespace {
+// Multilinear in the four inputs, so interpolation reproduces it exactly.
+double coeffOf(int c, double f, double r, double y, double s) {
+    return 0.3 + 0.1 * c + (1.0 + c) * f - 2.0 * r + 0.5 * f * r * (c - 1) + 0.2 * y * s + 0.05 * f * y * s * r;
+}
+
+AeroMap makeMap() {
+    AeroMap m({AeroMap::Grid{0.02, 0.10, 9}, AeroMap::Grid{0.04, 0.16, 7},
+               AeroMap::Grid{-0.2, 0.2, 5}, AeroMap::Grid{-0.5, 0.5, 11}});
+    for (std::uint32_t a = 0; a < 9; ++a)
+        for (std::uint32_t b = 0; b < 7; ++b)
+            for (std::uint32_t c = 0; c < 5; ++c)
+                for (std::uint32_t d = 0; d < 11; ++d)
+                    for (int ch = 0; ch < AeroMap::kChannels; ++ch)
+                        m.at(a, b, c, d, AeroMap::Channel(ch)) = float(coeffOf(ch,
+                            m.breakpoint(0, a), m.breakpoint(1, b), m.breakpoint(2, c), m.breakpoint(3, d)));
+    return m;
+}
+
+void randomInputs(AeroBatch& a, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        a.rideFront[i] = 0.02 + 0.08 * u(rng);
+        a.rideRear[i]  = 0.04 + 0.12 * u(rng);
+        a.yaw[i]       = -0.2 + 0.4 * u(rng);
+        a.steer[i]     = -0.5 + u(rng);
+        a.speed[i]     = 80.0 * u(rng);
+    }
+}
+}
+
+TEST(Aero, BatchedInterpolationMatchesTableAndReference) {
+    const AeroMap map = makeMap();
+    ASSERT_TRUE(map.valid());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(map.data()) % 64, 0u);
+    AeroBatch fast(map, 1000), ref(map, 1000);
+    randomInputs(fast, 1);
+    randomInputs(ref, 1);
+    fast.rideFront[0] = ref.rideFront[0] = 0.5;     // clamped to the last breakpoint
+    fast.steer[1] = ref.steer[1] = -3.0;
+    fast.evaluate(0, fast.size());
+    ref.evaluateReference(0, ref.size());
+
+    const double qa = 0.5 * 1.225;
+    for (std::size_t i = 0; i < fast.size(); ++i)
+        for (int c = 0; c < AeroMap::kChannels; ++c) {
+            const double f = std::min(fast.rideFront[i], 0.10), s = std::max(fast.steer[i], -0.5);
+            ASSERT_NEAR(fast.coeff[c][i], coeffOf(c, f, fast.rideRear[i], fast.yaw[i], s), 2e-6) << i;
+            ASSERT_NEAR(fast.coeff[c][i], ref.coeff[c][i], 1e-12) << i;
+            EXPECT_DOUBLE_EQ(fast.force[c][i], qa * fast.speed[i] * fast.speed[i] * fast.coeff[c][i]);
+        }
+
+    const AeroMap bad({AeroMap::Grid{0, 1, 1}, AeroMap::Grid{}, AeroMap::Grid{}, AeroMap::Grid{}});
+    EXPECT_FALSE(bad.valid());
+    AeroBatch none(bad, 10);
+    EXPECT_FALSE(none.valid());
+    randomInputs(none, 3);
+    none.step(0, none.size(), 0);
+    none.evaluateReference(0, none.size());
+    for (double f : none.force[AeroMap::Drag]) EXPECT_EQ(f, 0.0);
+}
+
+TEST(Aero, RateDividerStaggersLookupsButNotForces) {
+    const AeroMap map = makeMap();
+    AeroBatch::Config cfg;
+    cfg.rateDivider = 4;
+    cfg.group = 16;
+    AeroBatch a(map, 200, cfg), ref(map, 200);
+    randomInputs(a, 2);
+    randomInputs(ref, 2);
+    ref.evaluate(0, ref.size());
+    a.step(0, 100, 9);                               // first frame: every group
+    a.step(100, a.size(), 9);
+    EXPECT_EQ(a.coeff, ref.coeff);
+
+    std::vector<int> refreshed(a.size(), 0);
+    for (std::int64_t frame = 10; frame < 14; ++frame) {
+        randomInputs(a, std::uint32_t(frame));
+        randomInputs(ref, std::uint32_t(frame));
+        ref.evaluate(0, ref.size());
+        const auto before = a.coeff;
+        a.step(0, 100, frame);                       // two ranges, split mid-group
+        a.step(100, a.size(), frame);
+        std::size_t due = 0;
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            if (a.due(i, frame)) {
+                ++due; ++refreshed[i];
+                EXPECT_EQ(a.coeff[AeroMap::Drag][i], ref.coeff[AeroMap::Drag][i]) << i;
+            } else {
+                EXPECT_EQ(a.coeff[AeroMap::Drag][i], before[AeroMap::Drag][i]) << i;
+            }
+            EXPECT_EQ(a.speed[i], ref.speed[i]);
+            EXPECT_DOUBLE_EQ(a.force[AeroMap::Side][i],
+                             0.5 * 1.225 * a.speed[i] * a.speed[i] * a.coeff[AeroMap::Side][i]);
+        }
+        EXPECT_GE(due, 48u);                         // 13 groups over 4 frames
+        EXPECT_LE(due, 64u);
+    }
+    for (int r : refreshed) EXPECT_EQ(r, 1);
+}
+
+TEST(Aero, InstalledRangeTaskMatchesDirectEvaluation) {
+    const AeroMap map = makeMap();
+    AeroBatch::Config cfg;
+    cfg.rateDivider = 4;                             // primed on the first frame all the same
+    cfg.group = 16;
+    AeroBatch a(map, 500, cfg), ref(map, 500);
+    randomInputs(a, 5);
+    randomInputs(ref, 5);
+    ref.evaluate(0, ref.size());
+    SimCore::Settings st;
+    st.maxFrames = -1;
+    st.threads = 3;
+    st.chunkSize = 64;
+    st.driftLogInterval = 0;
+    SimCore sim(st);
+    a.install(sim, sim.addPhase("Aero"));
+    sim.step(1);
+    for (int c = 0; c < AeroMap::kChannels; ++c) {
+        EXPECT_EQ(a.coeff[c], ref.coeff[c]);
+        EXPECT_EQ(a.force[c], ref.force[c]);
+    }
+}
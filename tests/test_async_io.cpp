@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "async_io.hpp"
+#include "logger.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::string slurp(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(f), {});
+}
+
+class AsyncIOBackends : public ::testing::TestWithParam<bool> {};
+
+TEST_P(AsyncIOBackends, ConcurrentWritersLandInOrderPerThread) {
+    AsyncIO::Config cfg;
+    cfg.bufferSize = 4096;
+    cfg.bufferCount = 256;
+    cfg.useUring = GetParam();
+    AsyncIO io(cfg);
+    if (GetParam() && !io.usingUring()) GTEST_SKIP() << "io_uring unavailable here";
+
+    const std::string path = ::testing::TempDir() + "simcore_async_io_" + std::to_string(GetParam()) + ".txt";
+    std::remove(path.c_str());
+    auto fd = io.open(path, true);
+    ASSERT_GE(fd, 0);
+
+    constexpr int kThreads = 4, kLines = 2000;
+    std::vector<std::thread> ts;
+    for (int t = 0; t < kThreads; ++t)
+        ts.emplace_back([&, t]{
+            for (int i = 0; i < kLines; ++i)
+                io.write(fd, std::to_string(t) + ":" + std::to_string(i) + "\n");
+        });
+    for (auto& t : ts) t.join();
+    io.flush();
+    EXPECT_EQ(io.droppedBytes(), 0u);
+    EXPECT_EQ(io.writeErrors(), 0u);
+
+    std::string text = slurp(path);
+    EXPECT_EQ(io.bytesWritten(), text.size());
+    std::vector<int> next(kThreads, 0);
+    std::size_t lines = 0, pos = 0;
+    while (pos < text.size()) {
+        std::size_t nl = text.find('\n', pos);
+        ASSERT_NE(nl, std::string::npos);
+        std::string line = text.substr(pos, nl - pos);
+        int t = std::stoi(line.substr(0, line.find(':')));
+        int i = std::stoi(line.substr(line.find(':') + 1));
+        EXPECT_EQ(i, next[t]++);
+        ++lines;
+        pos = nl + 1;
+    }
+    EXPECT_EQ(lines, std::size_t(kThreads * kLines));
+    io.close(fd);
+    std::remove(path.c_str());
+}
+
+INSTANTIATE_TEST_SUITE_P(UringAndFallback, AsyncIOBackends, ::testing::Values(true, false));
+
+TEST(AsyncIO, LoggerFileSinkRoutesThroughService) {
+    const std::string path = ::testing::TempDir() + "simcore_async_log.txt";
+    std::remove(path.c_str());
+    AsyncIO io;
+    {
+        Logger log;
+        log.addSink(std::make_shared<Logger::FileSink>(path, &io));
+        log.setLevel(Logger::Level::Info);
+        LOG_INFO(&log, "hello {}", 42);
+    }
+    io.flush();
+    EXPECT_NE(slurp(path).find("hello 42"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(AsyncIO, DefaultFileSinkUsesTheSharedService) {
+    const std::string path = ::testing::TempDir() + "simcore_async_default_log.txt";
+    std::remove(path.c_str());
+    auto io = AsyncIO::shared();
+    EXPECT_EQ(io, AsyncIO::shared());
+    const std::uint64_t before = io->bytesWritten();
+    {
+        Logger log;
+        log.addSink(std::make_shared<Logger::FileSink>(path));
+        log.setLevel(Logger::Level::Info);
+        LOG_INFO(&log, "shared {}", 7);
+    }
+    EXPECT_EQ(io->bytesWritten() - before, std::string("shared 7\n").size());
+    EXPECT_EQ(slurp(path), "shared 7\n");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include "broadphase.hpp"
+#include <algorithm>
+#include <random>
+
+namespace {
+void scatterBoxes(BroadPhase& bp, std::uint32_t seed, double world) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> pos(-world, world), half(0.2, 2.5);
+    for (std::size_t i = 0; i < bp.size(); ++i)
+        bp.setBox(i, pos(rng), pos(rng), 0.1 * pos(rng), half(rng), half(rng), half(rng));
+}
+
+std::vector<BroadPhase::Pair> bruteForce(const BroadPhase& bp) {
+    std::vector<BroadPhase::Pair> out;
+    for (std::uint32_t a = 0; a < bp.size(); ++a)
+        for (std::uint32_t b = a + 1; b < bp.size(); ++b)
+            if (bp.minX[a] <= bp.maxX[b] && bp.minX[b] <= bp.maxX[a] &&
+                bp.minY[a] <= bp.maxY[b] && bp.minY[b] <= bp.maxY[a] &&
+                bp.minZ[a] <= bp.maxZ[b] && bp.minZ[b] <= bp.maxZ[a])
+                out.push_back({a, b});
+    return out;
+}
+
+std::vector<BroadPhase::Pair> sorted(std::vector<BroadPhase::Pair> v) {
+    std::sort(v.begin(), v.end(), [](auto& x, auto& y){ return x.a != y.a ? x.a < y.a : x.b < y.b; });
+    return v;
+}
+}
+
+TEST(BroadPhase, MatchesBruteForce) {
+    for (std::size_t n : {1u, 2u, 300u, 3000u}) {
+        BroadPhase::Config cfg;
+        cfg.blockSize = 128;
+        BroadPhase bp(n, cfg);
+        scatterBoxes(bp, 7u + std::uint32_t(n), 60.0);
+        bp.update();
+        const auto expect = bruteForce(bp);
+        EXPECT_EQ(sorted(bp.pairs()), expect) << "n=" << n;
+        EXPECT_EQ(bp.pairs().size(), expect.size());
+    }
+}
+
+TEST(BroadPhase, FixedCellSizeAndNegativeCoordinates) {
+    BroadPhase::Config cfg;
+    cfg.cellSize = 5.0;
+    BroadPhase bp(4, cfg);
+    bp.setBox(0, -0.1, -0.1, 0.0, 1.0, 1.0, 1.0);       // straddles the origin cells
+    bp.setBox(1,  0.1,  0.1, 0.0, 1.0, 1.0, 1.0);
+    bp.setBox(2, -4.9, -0.1, 0.0, 1.0, 1.0, 1.0);       // two cells over, no contact
+    bp.setBox(3,  0.0,  2.0, 0.0, 1.0, 1.0, 1.0);       // touches 1 only
+    bp.update();
+    EXPECT_EQ(sorted(bp.pairs()), (std::vector<BroadPhase::Pair>{{0, 1}, {1, 3}}));
+}
+
+TEST(BroadPhase, DeterministicAcrossThreadCounts) {
+    auto run = [](std::size_t threads) {
+        SimCore::Settings s;
+        s.maxFrames = -1;
+        s.threads = threads;
+        s.driftLogInterval = 0;
+        SimCore sim(s);
+        BroadPhase::Config cfg;
+        cfg.blockSize = 256;
+        BroadPhase bp(5000, cfg);
+        scatterBoxes(bp, 99u, 150.0);
+        bp.install(sim);
+        sim.step(2);
+        return bp.pairs();
+    };
+    const auto one = run(1), three = run(3);
+    EXPECT_FALSE(one.empty());
+    EXPECT_EQ(one, three);
+
+    BroadPhase::Config cfg;
+    cfg.blockSize = 256;
+    BroadPhase bp(5000, cfg);
+    scatterBoxes(bp, 99u, 150.0);
+    bp.update();
+    EXPECT_EQ(bp.pairs(), one);
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "constraint_solver.hpp"
+#include <random>
+#include <set>
+
+namespace {
+// Boxes resting in a jittered grid (touching neighbours and the ground),
+// tied pairwise by suspension-like springs.
+struct Pile {
+    explicit Pile(std::size_t n, ConstraintSolver::Config cfg = {})
+        : bodies(n), broad(n), narrow(bodies, broad), solver(bodies, cfg) {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<double> j(-0.05, 0.05);
+        const std::size_t row = 20;
+        for (std::size_t i = 0; i < n; ++i) {
+            bodies.px[i] = 0.98 * double(i % row) + j(rng);
+            bodies.py[i] = 0.98 * double(i / row) + j(rng);
+            bodies.pz[i] = 0.48 + j(rng);
+            bodies.vz[i] = -1.0 + j(rng);
+            bodies.vx[i] = 10.0 * j(rng);
+            bodies.setBox(i, 1.0, 1.0, 1.0, 1.0);
+        }
+        for (std::uint32_t i = 0; i + 1 < n; i += 3) {
+            ConstraintSolver::Joint jt;
+            jt.a = i; jt.b = i + 1;
+            jt.anchorA[2] = 0.5; jt.anchorB[2] = 0.5;
+            jt.rest = 1.0;
+            jt.frequency = 2.0;
+            jt.dampingRatio = 0.7;
+            solver.addJoint(jt);
+        }
+        solver.setContactSource(&narrow);
+    }
+    void collide() {
+        narrow.writeBounds(broad, 0, bodies.size());
+        broad.update();
+        narrow.update();
+    }
+    RigidBodySet     bodies;
+    BroadPhase       broad;
+    NarrowPhase      narrow;
+    ConstraintSolver solver;
+};
+}
+
+TEST(ConstraintSolver, ColorsShareNoDynamicBody) {
+    ConstraintSolver::Config cfg;
+    cfg.maxColors = 6;                       // small enough to overflow
+    Pile p(200, cfg);
+    p.bodies.setMass(7, 0.0, 0.0, 0.0, 0.0); // static body shared freely
+    p.collide();
+    p.solver.solve(1.0 / 60.0);
+    EXPECT_GT(p.solver.constraintCount(), 300u);
+    EXPECT_GT(p.solver.overflowCount(), 0u);
+    EXPECT_EQ(p.solver.colorEnd(cfg.maxColors - 1), p.solver.constraintCount());
+    for (std::size_t c = 0; c + 1 < cfg.maxColors; ++c) {
+        std::set<std::uint32_t> seen;
+        for (std::size_t i = p.solver.colorBegin(c); i < p.solver.colorEnd(c); ++i)
+            for (std::uint32_t b : {p.solver.bodyA(i), p.solver.bodyB(i)}) {
+                if (p.solver.isDynamic(b)) {
+                    EXPECT_TRUE(seen.insert(b).second) << "color " << c;
+                }
+            }
+    }
+}
+
+TEST(ConstraintSolver, ContactStopsApproachAndAppliesFriction) {
+    RigidBodySet bodies(1);
+    BroadPhase broad(1);
+    NarrowPhase narrow(bodies, broad);
+    ConstraintSolver::Config cfg;
+    cfg.iterations = 20;
+    cfg.friction = 0.5;
+    ConstraintSolver solver(bodies, cfg);
+    solver.setContactSource(&narrow);
+    bodies.setBox(0, 2.0, 1.0, 1.0, 1.0);
+    bodies.pz[0] = 0.499;                    // inside the slop: no bias
+    bodies.vz[0] = -1.0;
+    bodies.vx[0] = 1.0;
+    narrow.writeBounds(broad, 0, 1);
+    broad.update();
+    narrow.update();
+    ASSERT_EQ(narrow.contacts().size(), 4u);
+    solver.solve(1.0 / 60.0);
+    EXPECT_NEAR(bodies.vz[0], 0.0, 1e-6);
+    // Normal impulse m * 1 bounds friction to mu * m * 1.
+    EXPECT_NEAR(bodies.vx[0], 0.5, 1e-3);
+    EXPECT_NEAR(bodies.vy[0], 0.0, 1e-9);
+}
+
+TEST(ConstraintSolver, RigidJointRemovesStretchingVelocity) {
+    RigidBodySet bodies(2);
+    ConstraintSolver solver(bodies);
+    bodies.px[1] = 2.0;
+    bodies.vx[0] = -1.0;
+    bodies.vx[1] = 3.0;
+    bodies.vy[1] = 1.0;                      // sideways: not constrained
+    ConstraintSolver::Joint j;
+    j.a = 0; j.b = 1; j.rest = 2.0;
+    solver.addJoint(j);
+    solver.solve(1.0 / 60.0);
+    EXPECT_NEAR(bodies.vx[0], 1.0, 1e-9);
+    EXPECT_NEAR(bodies.vx[1], 1.0, 1e-9);
+    EXPECT_NEAR(bodies.vy[1], 1.0, 1e-9);
+    EXPECT_NEAR(bodies.wz[0], 0.0, 1e-9);
+}
+
+TEST(ConstraintSolver, DeterministicAcrossThreadCounts) {
+    auto run = [](std::size_t threads) {
+        SimCore::Settings st;
+        st.maxFrames = -1;
+        st.threads = threads;
+        st.driftLogInterval = 0;
+        SimCore sim(st);
+        ConstraintSolver::Config cfg;
+        cfg.blockSize = 16;
+        Pile p(400, cfg);
+        const auto bounds = sim.addPhase("Bounds", p.bodies.size());
+        sim.addParallelRangeTask(bounds, [&](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            p.narrow.writeBounds(p.broad, b, e);
+        });
+        p.broad.install(sim);
+        p.narrow.install(sim);
+        p.solver.install(sim);
+        RigidBodyIntegrator integ(p.bodies);
+        integ.install(sim, sim.addPhase("Integrate"));
+        sim.step(5);
+        std::vector<double> out;
+        for (const auto* c : {&p.bodies.px, &p.bodies.pz, &p.bodies.vx, &p.bodies.vz, &p.bodies.wy})
+            out.insert(out.end(), c->begin(), c->end());
+        return out;
+    };
+    const auto one = run(1), three = run(3);
+    EXPECT_EQ(one, three);
+}
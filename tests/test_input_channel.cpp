@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "simcore.hpp"
+#include "input_channel.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(InputChannel, DrainsDueSamplesAndInterpolates) {
+    InputChannel in(16, 2);
+    ASSERT_TRUE(in.push(0, 0.0, 100));
+    ASSERT_TRUE(in.push(0, 20.0, 300));
+    ASSERT_TRUE(in.push(0, 10.0, 200));   // out of order arrival
+    EXPECT_FALSE(in.push(5, 1.0, 100));   // no such channel
+
+    in.drain(150);
+    ASSERT_EQ(in.frameSamples().size(), 1u);
+    EXPECT_EQ(in.pendingCount(), 2u);
+    EXPECT_DOUBLE_EQ(in.value(0), 0.0);
+    in.setInterpolate(true);
+    EXPECT_DOUBLE_EQ(in.value(0), 5.0);
+
+    in.drain(250);
+    ASSERT_EQ(in.frameSamples().size(), 1u);
+    EXPECT_EQ(in.frameSamples()[0].tNs, 200);
+    EXPECT_DOUBLE_EQ(in.value(0), 15.0);
+
+    in.drain(1000);
+    EXPECT_DOUBLE_EQ(in.value(0), 20.0);
+    EXPECT_FALSE(in.hasValue(1));
+    EXPECT_EQ(in.latency().count(), 3u);
+}
+
+TEST(InputChannel, ProducersFeedSimFrames) {
+    SimCore::Settings s;
+    s.maxFrames = -1;
+    s.threads = 1;
+    s.driftLogInterval = 0;
+    SimCore sim(s);
+
+    constexpr int kProducers = 4, kPerProducer = 2000;
+    std::int64_t consumed = 0;
+    bool ordered = true;
+    auto ph = sim.addPhase("Input");
+    sim.addSerialSubsystem(ph, [&](std::int64_t, SimCore::Seconds){
+        const auto& f = sim.input().frameSamples();
+        for (std::size_t i = 1; i < f.size(); ++i) ordered &= f[i-1].tNs <= f[i].tNs;
+        consumed += static_cast<std::int64_t>(f.size());
+    });
+
+    std::atomic<int> pushed{0};
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p)
+        producers.emplace_back([&, p]{
+            for (int i = 0; i < kPerProducer; ++i) {
+                while (!sim.input().push(std::uint32_t(p), double(i))) std::this_thread::yield();
+                ++pushed;
+            }
+        });
+    while (pushed.load() < kProducers * kPerProducer) sim.step();
+    for (auto& t : producers) t.join();
+    sim.step(2);
+
+    EXPECT_EQ(consumed, kProducers * kPerProducer);
+    EXPECT_TRUE(ordered);
+    for (int p = 0; p < kProducers; ++p)
+        EXPECT_DOUBLE_EQ(sim.input().value(std::uint32_t(p)), double(kPerProducer - 1));
+}
+
+TEST(InputChannel, OutputPointsReportInputAge) {
+    SimCore::Settings s;
+    s.maxFrames = -1;
+    s.threads = 1;
+    s.driftLogInterval = 0;
+    SimCore sim(s);
+    auto ffb = sim.addOutputPoint("ffb");
+    auto ph = sim.addPhase("Output");
+    sim.addSerialSubsystem(ph, [&](std::int64_t, SimCore::Seconds){ sim.markOutput(ffb); });
+
+    sim.step();                                    // no input yet: nothing recorded
+    EXPECT_EQ(sim.outputPoint(ffb).histogram().count(), 0u);
+
+    const std::int64_t t0 = InputChannel::nowNs() - 2'000'000;
+    sim.input().push(0, 1.0, t0 - 1'000'000);
+    sim.input().push(1, 1.0, t0);
+    sim.step();
+    EXPECT_EQ(sim.input().newestNs(), t0);
+    EXPECT_EQ(sim.input().stampNs(0), t0 - 1'000'000);
+    auto h = sim.outputPoint(ffb).histogram();
+    ASSERT_EQ(h.count(), 1u);
+    EXPECT_GE(h.max(), 2'000'000u);
+
+    // Later frames without new input report the same tag, so the age grows.
+    sim.step();
+    h = sim.outputPoint(ffb).histogram();
+    ASSERT_EQ(h.count(), 2u);
+    EXPECT_GE(h.max(), 2'000'000u);
+
+    // An explicit tag, as a pipelined output stage would pass it.
+    sim.outputPoint(ffb).reset();
+    sim.outputPoint(ffb).emit(t0, t0 + 500'000);
+    EXPECT_EQ(sim.outputPoint(ffb).histogram().max(), 500'000u);
+}
@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "islands.hpp"
+#include <numeric>
+#include <random>
+
+namespace {
+// Reference components by serial union-find with the same rules.
+std::vector<std::uint32_t> serialRoots(const RigidBodySet& b, const ConstraintSolver& s) {
+    std::vector<std::uint32_t> p(b.size());
+    std::iota(p.begin(), p.end(), 0u);
+    auto find = [&](std::uint32_t x) { while (p[x] != x) x = p[x]; return x; };
+    for (std::size_t j = 0; j < s.jointCount(); ++j) {
+        const auto& jt = s.joint(j);
+        if (jt.b == ConstraintSolver::kWorld || !(b.invMass[jt.a] > 0.0) || !(b.invMass[jt.b] > 0.0)) continue;
+        const std::uint32_t x = find(jt.a), y = find(jt.b);
+        if (x != y) p[std::max(x, y)] = std::min(x, y);
+    }
+    std::vector<std::uint32_t> r(b.size());
+    for (std::uint32_t i = 0; i < b.size(); ++i) r[i] = b.invMass[i] > 0.0 ? find(i) : IslandBuilder::kNone;
+    return r;
+}
+
+void randomJoints(ConstraintSolver& s, std::size_t n, std::size_t count, std::uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<std::uint32_t> body(0, std::uint32_t(n - 1));
+    for (std::size_t k = 0; k < count; ++k) {
+        ConstraintSolver::Joint j;
+        j.a = body(rng);
+        j.b = body(rng);
+        s.addJoint(j);
+    }
+}
+}
+
+TEST(Islands, MatchSerialUnionFind) {
+    const std::size_t n = 5000;
+    RigidBodySet bodies(n);
+    for (std::size_t i = 0; i < n; i += 97) bodies.setMass(i, 0.0, 0.0, 0.0, 0.0);   // static: no links
+    ConstraintSolver solver(bodies);
+    randomJoints(solver, n, 2400, 11);
+    IslandBuilder::Config cfg;
+    cfg.blockSize = 100;
+    IslandBuilder islands(bodies, cfg);
+    islands.setJointSource(&solver);
+    islands.update();
+
+    const auto ref = serialRoots(bodies, solver);
+    std::size_t roots = 0;
+    for (std::uint32_t i = 0; i < n; ++i) {
+        if (ref[i] == IslandBuilder::kNone) { EXPECT_EQ(islands.islandOf(i), IslandBuilder::kNone); continue; }
+        roots += ref[i] == i;
+        const auto& is = islands.islands()[islands.islandOf(i)];
+        EXPECT_EQ(islands.bodies()[is.bodyBegin], ref[i]);     // lowest body first
+    }
+    ASSERT_EQ(islands.islands().size(), roots);
+    std::size_t edges = 0;
+    for (const auto& is : islands.islands()) {
+        for (std::uint32_t e = is.edgeBegin; e < is.edgeBegin + is.edgeCount; ++e)
+            EXPECT_EQ(ref[islands.edges()[e].a], islands.bodies()[is.bodyBegin]);
+        edges += is.edgeCount;
+        EXPECT_DOUBLE_EQ(is.cost, is.bodyCount + 4.0 * is.edgeCount);
+    }
+    EXPECT_LT(edges, solver.jointCount());                        // static endpoints dropped
+}
+
+TEST(Islands, JobsCoverAwakeIslandsOnceAcrossThreadCounts) {
+    auto run = [](std::size_t threads) {
+        SimCore::Settings st;
+        st.maxFrames = -1;
+        st.threads = threads;
+        st.driftLogInterval = 0;
+        SimCore sim(st);
+        const std::size_t n = 3000;
+        RigidBodySet bodies(n);
+        ConstraintSolver solver(bodies);
+        randomJoints(solver, n, 1500, 4);
+        for (std::size_t i = 0; i < 200; ++i) {                   // one big island
+            ConstraintSolver::Joint j;
+            j.a = std::uint32_t(i); j.b = std::uint32_t(i + 1);
+            solver.addJoint(j);
+        }
+        IslandBuilder::Config cfg;
+        cfg.blockSize = 128;
+        IslandBuilder islands(bodies, cfg);
+        islands.setJointSource(&solver);
+        islands.install(sim);
+        std::vector<int> seen(n, 0);
+        islands.installJobs(sim, [&](const IslandBuilder::Island& is, std::int64_t, SimCore::Seconds){
+            for (std::uint32_t m = is.bodyBegin; m < is.bodyBegin + is.bodyCount; ++m) ++seen[islands.bodies()[m]];
+        });
+        sim.step(1);
+        for (int s : seen) EXPECT_EQ(s, 1);
+        EXPECT_GT(islands.jobCount(), 1u);
+        EXPECT_EQ(islands.jobIslands()[0], islands.islandOf(0));  // biggest first
+        std::vector<std::uint32_t> out(islands.bodies());
+        out.insert(out.end(), islands.jobIslands().begin(), islands.jobIslands().end());
+        return out;
+    };
+    EXPECT_EQ(run(1), run(3));
+}
+
+TEST(Islands, RestingIslandSleepsAndWakesOnContact) {
+    RigidBodySet bodies(3);
+    ConstraintSolver solver(bodies);
+    ConstraintSolver::Joint j;
+    j.a = 0; j.b = 1;
+    solver.addJoint(j);
+    IslandBuilder::Config cfg;
+    cfg.sleepFrames = 3;
+    IslandBuilder islands(bodies, cfg);
+    islands.setJointSource(&solver);
+    bodies.vx[2] = 1.0;
+    bodies.vx[0] = 0.01;
+    for (int f = 0; f < 3; ++f) {
+        islands.update();
+        EXPECT_EQ(islands.asleep(0), f == 2) << f;
+    }
+    EXPECT_TRUE(islands.asleep(1));
+    EXPECT_FALSE(islands.asleep(2));
+    EXPECT_EQ(bodies.vx[0], 0.0);
+    EXPECT_EQ(islands.awakeCount(), 1u);
+    EXPECT_EQ(islands.jobCount(), 1u);
+
+    j.a = 1; j.b = 2;                                                // moving body touches it
+    solver.addJoint(j);
+    islands.update();
+    EXPECT_FALSE(islands.asleep(0));
+    EXPECT_EQ(islands.islands().size(), 1u);
+}
+
+TEST(Islands, SleepingIslandsAreSkippedBySolverAndIntegrator) {
+    RigidBodySet bodies(4);
+    ConstraintSolver solver(bodies);
+    ConstraintSolver::Joint j;
+    j.a = 0; j.b = 1; j.rest = 1.0;
+    solver.addJoint(j);                                              // resting pair
+    j.a = 2; j.b = 3; j.rest = 1.0;
+    solver.addJoint(j);                                              // stretched, moving pair
+    bodies.px[1] = 1.0;
+    bodies.px[3] = 2.0;
+    bodies.vx[3] = 1.0;
+    IslandBuilder::Config cfg;
+    cfg.sleepFrames = 2;
+    IslandBuilder islands(bodies, cfg);
+    islands.setJointSource(&solver);
+    solver.setAwakeMask(&islands.awakeMask());
+    RigidBodyIntegrator integ(bodies);
+    integ.setAwakeMask(&islands.awakeMask());
+
+    for (int f = 0; f < 2; ++f) islands.update();
+    ASSERT_TRUE(islands.asleep(0));
+    ASSERT_FALSE(islands.asleep(2));
+    EXPECT_EQ(islands.awakeMask(), (std::vector<std::uint8_t>{0, 0, 1, 1}));
+
+    solver.solve(0.01);
+    EXPECT_EQ(solver.constraintCount(), 1u);
+    EXPECT_EQ(solver.bodyA(0), 2u);
+    integ.integrate(0, bodies.size(), 0.01);
+    EXPECT_EQ(bodies.pz[0], 0.0);                                    // no gravity while asleep
+    EXPECT_EQ(bodies.vz[1], 0.0);
+    EXPECT_EQ(bodies.px[1], 1.0);
+    EXPECT_LT(bodies.vz[2], 0.0);
+    EXPECT_LT(bodies.pz[3], 0.0);
+}
+
+TEST(Islands, AppliedForceWakesASleepingIsland) {
+    RigidBodySet bodies(2);
+    ConstraintSolver solver(bodies);
+    ConstraintSolver::Joint j;
+    j.a = 0; j.b = 1;
+    solver.addJoint(j);
+    IslandBuilder::Config cfg;
+    cfg.sleepFrames = 2;
+    IslandBuilder islands(bodies, cfg);
+    islands.setJointSource(&solver);
+    RigidBodyIntegrator::Config icfg;
+    icfg.params.gravity[2] = 0.0;
+    RigidBodyIntegrator integ(bodies, icfg);
+    integ.setAwakeMask(&islands.awakeMask());
+    for (int f = 0; f < 2; ++f) islands.update();
+    ASSERT_TRUE(islands.asleep(0));
+
+    bodies.fx[1] = 100.0;                                            // applied after the islands pass
+    integ.integrate(0, bodies.size(), 0.01);
+    EXPECT_EQ(bodies.vx[1], 0.0);
+    EXPECT_EQ(bodies.fx[1], 100.0);                                  // kept, not lost
+    islands.update();
+    EXPECT_FALSE(islands.asleep(0));
+    EXPECT_FALSE(islands.asleep(1));
+    integ.integrate(0, bodies.size(), 0.01);
+    EXPECT_GT(bodies.vx[1], 0.0);
+    EXPECT_EQ(bodies.fx[1], 0.0);
+}
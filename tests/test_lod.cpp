@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "lod.hpp"
+#include <cmath>
+
+TEST(Lod, HysteresisAndStaggeredRates) {
+    LodScheduler lod(8);   // near < 100 (rate 1), mid < 400 (rate 2), far (rate 8)
+    const double d0[8] = {10, 99, 105, 150, 399, 500, 1000, 5000};
+    for (std::size_t i = 0; i < 8; ++i) lod.distance[i] = d0[i];
+    lod.update(0, 0.01);
+    EXPECT_EQ(lod.transfers(), 8u);
+    EXPECT_EQ(lod.members(0), (std::vector<std::uint32_t>{0, 1}));
+    EXPECT_EQ(lod.members(1), (std::vector<std::uint32_t>{2, 3, 4}));
+    EXPECT_EQ(lod.members(2), (std::vector<std::uint32_t>{5, 6, 7}));
+
+    lod.distance[1] = 105;    // inside the margin: stays near
+    lod.distance[2] = 95;     // inside the margin: stays mid
+    lod.distance[3] = 85;     // past it: becomes near
+    lod.update(1, 0.01);
+    EXPECT_EQ(lod.levelOf(1), 0);
+    EXPECT_EQ(lod.levelOf(2), 1);
+    EXPECT_EQ(lod.levelOf(3), 0);
+    EXPECT_EQ(lod.transfers(), 1u);
+
+    // Over 8 frames: near every frame, mid every 2nd, far once, each
+    // element on its own phase of the cycle.
+    std::vector<int> updates(8, 0);
+    for (std::int64_t f = 2; f < 10; ++f) {
+        lod.update(f, 0.01);
+        for (int l = 0; l < lod.levelCount(); ++l)
+            for (std::uint32_t id : lod.due(l)) ++updates[id];
+        EXPECT_LE(lod.due(2).size(), 1u);
+    }
+    EXPECT_EQ(updates, (std::vector<int>{8, 8, 4, 8, 4, 1, 1, 1}));
+}
+
+TEST(Lod, LevelPhasesConserveTimeAcrossTransfersThroughSimCore) {
+    SimCore::Settings st;
+    st.hz = 100.0;
+    st.maxFrames = -1;
+    st.threads = 3;
+    st.chunkSize = 16;
+    st.driftLogInterval = 0;
+    SimCore sim(st);
+    const std::size_t n = 300;
+    LodScheduler lod(n);
+    std::vector<double> simTime(n, 0.0);
+    std::vector<int> model(n, -1);        // which level's state the element holds
+    std::size_t badTasks = 0;
+
+    // Elements orbit at different radii and phases so they keep crossing
+    // level boundaries.
+    auto move = sim.addPhase("Move");
+    sim.addSerialSubsystem(move, [&](std::int64_t frame, SimCore::Seconds){
+        for (std::size_t i = 0; i < n; ++i)
+            lod.distance[i] = 250.0 + 240.0 * std::sin(0.05 * double(frame) + 0.37 * double(i));
+    });
+    lod.install(sim);
+    lod.setTransfer([&](std::uint32_t id, int from, int to) {
+        if (model[id] != from) ++badTasks;
+        model[id] = to;
+    });
+    for (int l = 0; l < lod.levelCount(); ++l) {
+        const std::size_t ph = lod.addLevelPhase(sim, l, lod.level(l).name);
+        lod.addLevelTask(sim, ph, [&, l](const std::uint32_t* ids, const double* dt,
+                                        std::size_t b, std::size_t e, std::int64_t) {
+            for (std::size_t k = b; k < e; ++k) {
+                if (model[ids[k]] != l || lod.levelOf(ids[k]) != l) ++badTasks;   // transfers ran first
+                simTime[ids[k]] += dt[k];
+            }
+        });
+    }
+    sim.step(400);
+    EXPECT_GT(lod.members(0).size(), 0u);
+    EXPECT_GT(lod.members(2).size(), 0u);
+
+    // Bring everything near so the far elements' pending time is flushed.
+    sim.addSerialSubsystem(move, [&](std::int64_t, SimCore::Seconds){
+        std::fill(lod.distance.begin(), lod.distance.end(), 0.0);
+    });
+    sim.step(1);
+    EXPECT_EQ(lod.members(0).size(), n);
+    EXPECT_EQ(badTasks, 0u);
+    for (std::size_t i = 0; i < n; ++i) EXPECT_NEAR(simTime[i], 401 * 0.01, 1e-9) << i;
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "simcore.hpp"
+#include "logger.hpp"
+#include "metrics_shm.hpp"
+#include <string>
+#include <unistd.h>
+
+TEST(MetricsShm, PublishesLastFrame) {
+    const std::string name = "/simcore_metrics_test_" + std::to_string(::getpid());
+    MetricsPublisher pub(name);
+    ASSERT_TRUE(pub.ok());
+
+    SimCore::Settings s;
+    s.hz = 1000.0;
+    s.maxFrames = 50;
+    s.threads = 2;
+    s.driftLogInterval = 0;
+
+    Logger log; log.setLevel(Logger::Level::Error);
+    SimCore sim(s);
+    sim.setLogger(&log);
+    sim.setMetricsPublisher(&pub);
+
+    auto in   = sim.addPhase("Input");
+    auto phys = sim.addPhase("Physics", 1024);
+    sim.addSerialSubsystem(in, [](int64_t, SimCore::Seconds){});
+    sim.addParallelRangeTask(phys, [](std::size_t, std::size_t, int64_t, SimCore::Seconds){});
+    sim.run();
+
+    MetricsReader reader(name);
+    ASSERT_TRUE(reader.ok());
+    MetricsBlock::Payload p{};
+    ASSERT_TRUE(reader.read(p));
+    EXPECT_EQ(p.frame, s.maxFrames);
+    EXPECT_DOUBLE_EQ(reader.hz(), s.hz);
+    ASSERT_EQ(p.phaseCount, 2u);
+    EXPECT_STREQ(p.phaseNames[0], "Input");
+    EXPECT_STREQ(p.phaseNames[1], "Physics");
+    EXPECT_EQ(p.workerCount, 2u);
+    EXPECT_GT(p.frameNs, 0);
+    EXPECT_GT(p.wallNs, 0u);
+
+    s.hz = 250.0;                 // runtime rate change reaches the monitor
+    s.maxFrames = 60;
+    sim.applySettings(s);
+    EXPECT_DOUBLE_EQ(reader.hz(), 250.0);
+}
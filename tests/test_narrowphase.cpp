@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include "narrowphase.hpp"
+#include <cmath>
+#include <random>
+
+namespace {
+// Bodies, their broad phase and narrow phase, wired the way a frame is.
+struct Scene {
+    explicit Scene(std::size_t n, NarrowPhase::Config cfg = {})
+        : bodies(n), broad(n), narrow(bodies, broad, cfg) {}
+    void place(std::size_t i, double x, double y, double z, double angle = 0.0,
+               double ax = 0.0, double ay = 0.0, double az = 1.0) {
+        bodies.px[i] = x; bodies.py[i] = y; bodies.pz[i] = z;
+        const double s = std::sin(0.5 * angle);
+        bodies.qw[i] = std::cos(0.5 * angle);
+        bodies.qx[i] = s * ax; bodies.qy[i] = s * ay; bodies.qz[i] = s * az;
+    }
+    void update() {
+        narrow.writeBounds(broad, 0, bodies.size());
+        broad.update();
+        narrow.update();
+    }
+    RigidBodySet bodies;
+    BroadPhase   broad;
+    NarrowPhase  narrow;
+};
+}
+
+TEST(NarrowPhase, BoxRestingOnGround) {
+    Scene s(2);
+    s.place(0, 0.0, 0.0, 0.45);
+    s.place(1, 5.0, 0.0, 0.45);
+    s.bodies.setMass(1, 0.0, 0.0, 0.0, 0.0);      // static: no ground contacts
+    s.update();
+    const auto& c = s.narrow.contacts();
+    ASSERT_EQ(c.size(), 4u);
+    for (const auto& k : c) {
+        EXPECT_EQ(k.a, 0u);
+        EXPECT_EQ(k.b, NarrowPhase::kGround);
+        EXPECT_DOUBLE_EQ(k.nz, -1.0);
+        EXPECT_NEAR(k.depth, 0.05, 1e-12);
+        EXPECT_NEAR(k.pz, -0.025, 1e-12);
+        EXPECT_NEAR(std::fabs(k.px), 0.5, 1e-12);
+    }
+}
+
+TEST(NarrowPhase, FaceContactIsClippedToFourPoints) {
+    NarrowPhase::Config cfg;
+    cfg.ground = false;
+    Scene s(4, cfg);
+    s.place(0, 0.0, 0.0, 0.0);
+    s.place(1, 0.0, 0.0, 0.95, 0.25 * 3.14159265358979);   // twisted: octagon overlap
+    // AABBs overlap, boxes do not: diagonal neighbours rotated 45 degrees.
+    s.place(2, 10.0, 0.0, 0.0, 0.25 * 3.14159265358979);
+    s.place(3, 11.1, 1.1, 0.0, 0.25 * 3.14159265358979);
+    s.update();
+    ASSERT_EQ(s.broad.pairs().size(), 2u);
+    const auto& c = s.narrow.contacts();
+    ASSERT_EQ(c.size(), 4u);
+    for (const auto& k : c) {
+        EXPECT_EQ(k.a, 0u);
+        EXPECT_EQ(k.b, 1u);
+        EXPECT_NEAR(k.nz, 1.0, 1e-12);
+        EXPECT_NEAR(k.depth, 0.05, 1e-9);
+        EXPECT_NEAR(k.pz, 0.475, 1e-9);
+        EXPECT_LE(std::hypot(k.px, k.py), std::sqrt(0.5) + 1e-9);
+    }
+}
+
+TEST(NarrowPhase, AlignedGridKeepsAtMostFourPointsPerPair) {
+    // Coincident edges and faces: every clip plane passes through vertices.
+    Scene s(100);
+    for (std::size_t i = 0; i < 100; ++i) s.place(i, 0.98 * double(i % 10), 0.98 * double(i / 10), 0.49);
+    s.update();
+    EXPECT_EQ(s.broad.pairs().size(), 2u * 9u * 10u + 2u * 9u * 9u);
+    std::size_t run = 0;
+    for (std::size_t i = 0; i < s.narrow.contacts().size(); ++i) {
+        const auto& c = s.narrow.contacts()[i];
+        const bool same = i > 0 && c.a == s.narrow.contacts()[i - 1].a && c.b == s.narrow.contacts()[i - 1].b;
+        run = same ? run + 1 : 1;
+        EXPECT_LE(run, 4u);
+        EXPECT_GT(c.depth, 0.0);
+    }
+}
+
+TEST(NarrowPhase, CrossedEdges) {
+    NarrowPhase::Config cfg;
+    cfg.ground = false;
+    Scene s(2, cfg);
+    const double q = 0.25 * 3.14159265358979, h = std::sqrt(0.5);
+    s.place(0, 0.0, 0.0, 0.0, q, 0.0, 1.0, 0.0);            // top edge along y
+    s.place(1, 0.0, 0.0, 2.0 * h - 0.02, q, 1.0, 0.0, 0.0); // bottom edge along x
+    s.update();
+    const auto& c = s.narrow.contacts();
+    ASSERT_EQ(c.size(), 1u);
+    EXPECT_NEAR(c[0].nz, 1.0, 1e-9);
+    EXPECT_NEAR(c[0].depth, 0.02, 1e-9);
+    EXPECT_NEAR(c[0].px, 0.0, 1e-9);
+    EXPECT_NEAR(c[0].py, 0.0, 1e-9);
+    EXPECT_NEAR(c[0].pz, h - 0.01, 1e-9);
+}
+
+TEST(NarrowPhase, DeterministicAcrossThreadCounts) {
+    auto run = [](std::size_t threads) {
+        SimCore::Settings st;
+        st.maxFrames = -1;
+        st.threads = threads;
+        st.driftLogInterval = 0;
+        SimCore sim(st);
+        NarrowPhase::Config cfg;
+        cfg.blockSize = 64;
+        Scene s(3000, cfg);
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<double> pos(-40.0, 40.0), ang(-3.0, 3.0), ext(0.3, 1.2);
+        for (std::size_t i = 0; i < s.bodies.size(); ++i) {
+            s.place(i, pos(rng), pos(rng), 0.5 + 0.02 * pos(rng), ang(rng), 0.6, 0.0, 0.8);
+            s.narrow.hx[i] = ext(rng); s.narrow.hy[i] = ext(rng); s.narrow.hz[i] = ext(rng);
+        }
+        const auto bounds = sim.addPhase("Bounds", s.bodies.size());
+        sim.addParallelRangeTask(bounds, [&](std::size_t b, std::size_t e, std::int64_t, SimCore::Seconds){
+            s.narrow.writeBounds(s.broad, b, e);
+        });
+        s.broad.install(sim);
+        s.narrow.install(sim);
+        sim.step(2);
+        std::vector<double> out;
+        for (const auto& k : s.narrow.contacts())
+            out.insert(out.end(), {double(k.a), double(k.b), k.nx, k.ny, k.nz, k.px, k.py, k.pz, k.depth});
+        return out;
+    };
+    const auto one = run(1), three = run(3);
+    EXPECT_GT(one.size(), 9u * 100u);
+    EXPECT_EQ(one, three);
+}
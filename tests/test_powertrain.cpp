@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include "powertrain.hpp"
+#include <cmath>
+
+namespace {
+constexpr double kRadPerRpm = simd::kPi / 30.0;
+}
+
+TEST(Powertrain, FreeRevvingEngineFollowsTheTorqueCurve) {
+    PowertrainBatch p(2);
+    ASSERT_TRUE(p.valid());
+    p.clutch[0] = 0.0;                        // disengaged, in gear
+    p.gear[0] = 2;
+    p.gear[1] = 0;                            // neutral, clutch engaged
+    for (std::size_t i = 0; i < 2; ++i) { p.throttle[i] = 1.0; p.engineSpeed[i] = 4000.0 * kRadPerRpm; }
+    p.integrate(0, 2, 1e-3);
+    // 4000 rpm is breakpoint 3 of the default curve: 320 N m full load.
+    const double expected = 4000.0 * kRadPerRpm + 320.0 * 1e-3 / 0.20;
+    EXPECT_NEAR(p.engineSpeed[0], expected, 2e-3);
+    EXPECT_EQ(p.torqueLeft[0], 0.0);
+    EXPECT_EQ(p.clutchTorque[0], 0.0);
+    // In neutral the driveline spins up with the engine; nothing reaches the wheels.
+    EXPECT_GT(p.drivelineSpeed[1], 0.0);
+    EXPECT_EQ(p.torqueLeft[1] + p.torqueRight[1], 0.0);
+
+    p.throttle[0] = 0.0;                      // closed throttle brakes the engine
+    const double before = p.engineSpeed[0];
+    p.integrate(0, 1, 1e-3);
+    EXPECT_LT(p.engineSpeed[0], before);
+}
+
+TEST(Powertrain, InvalidCurveLeavesStateAloneAndOutputsZero) {
+    PowertrainBatch::Config one;
+    one.curve.fullLoad = {300.0};             // a single point: no cell to interpolate in
+    one.curve.closed = {-20.0};
+    PowertrainBatch::Config uneven;
+    uneven.curve.closed.resize(3);            // shorter than fullLoad
+    for (const auto& cfg : {one, uneven}) {
+        PowertrainBatch p(3, cfg);
+        EXPECT_FALSE(p.valid());
+        for (std::size_t i = 0; i < 3; ++i) {
+            p.throttle[i] = 1.0;
+            p.engineSpeed[i] = 6000.0 * kRadPerRpm;
+            p.wheelSpeedLeft[i] = p.wheelSpeedRight[i] = 50.0;
+            p.gear[i] = 3;
+            p.torqueLeft[i] = 1.0;
+        }
+        p.integrate(0, 3, 1e-3);
+        for (std::size_t i = 0; i < 3; ++i) {
+            EXPECT_EQ(p.engineSpeed[i], 6000.0 * kRadPerRpm);
+            EXPECT_EQ(p.torqueLeft[i], 0.0);
+            EXPECT_EQ(p.clutchTorque[i], 0.0);
+        }
+    }
+}
+
+TEST(Powertrain, LockedClutchDrivesTheWheelsAtTheGearedSpeed) {
+    PowertrainBatch::Config cfg;
+    cfg.diffLocking = 0.0;
+    PowertrainBatch p(1, cfg);
+    p.gear[0] = 3;
+    p.throttle[0] = 0.4;
+    p.wheelSpeedLeft[0] = p.wheelSpeedRight[0] = 40.0;
+    const double r = 1.6 * 3.7;
+    p.engineSpeed[0] = p.drivelineSpeed[0] = r * 40.0;
+    for (int f = 0; f < 500; ++f) p.integrate(0, 1, 2e-3);
+
+    const double we = p.engineSpeed[0];
+    EXPECT_NEAR(we, r * 40.0, 1.0);           // only the regularization slip
+    double te = 0.0;                          // engine torque at the settled speed
+    {
+        PowertrainBatch q(1);
+        q.clutch[0] = 0.0;
+        q.throttle[0] = 0.4;
+        q.engineSpeed[0] = we;
+        q.integrate(0, 1, 1e-6);
+        te = (q.engineSpeed[0] - we) * 0.20 / 1e-6;
+    }
+    EXPECT_NEAR(p.clutchTorque[0], te, 0.5);
+    EXPECT_NEAR(p.torqueLeft[0] + p.torqueRight[0], te * r * 0.95, 5.0);
+    EXPECT_DOUBLE_EQ(p.torqueLeft[0], p.torqueRight[0]);
+}
+
+TEST(Powertrain, SlippingClutchIsCappedAndStiffCouplingsStayStable) {
+    PowertrainBatch::Config cfg;
+    cfg.clutchCapacity = 300.0;
+    cfg.clutchStiffness = 1e7;                // explicit Euler would need h << 1e-8 s
+    cfg.shaftDamping = 1e7;
+    cfg.substeps = 1;
+    PowertrainBatch p(4, cfg);
+    for (std::size_t i = 0; i < 4; ++i) {
+        p.gear[i] = 1;
+        p.throttle[i] = 1.0;
+        p.engineSpeed[i] = 6000.0 * kRadPerRpm;   // launch: wheels at rest
+    }
+    p.wheelSpeedLeft[3] = 10.0;                   // one car with a spinning left wheel
+    p.integrate(0, 4, 1.0 / 500.0);
+    EXPECT_DOUBLE_EQ(p.clutchTorque[0], 300.0);
+    EXPECT_LT(p.torqueLeft[3], p.torqueRight[3]);  // the locking diff feeds the slower wheel
+
+    for (std::size_t i = 0; i < 4; ++i) p.throttle[i] = 0.5;   // below capacity, so it can lock
+    for (int f = 0; f < 2000; ++f) {
+        for (std::size_t i = 0; i < 4; ++i) p.wheelSpeedLeft[i] = p.wheelSpeedRight[i] = 0.02 * f;
+        p.integrate(0, 4, 1.0 / 500.0);
+        for (std::size_t i = 0; i < 4; ++i) {
+            ASSERT_TRUE(std::isfinite(p.engineSpeed[i]) && std::isfinite(p.torqueLeft[i])) << f;
+            ASSERT_LE(std::fabs(p.clutchTorque[i]), 300.0 + 1e-9);
+        }
+    }
+    // Clutch locked again once the wheels caught up with the engine.
+    const double r = 3.2 * 3.7;
+    EXPECT_NEAR(p.engineSpeed[0], r * p.wheelSpeedLeft[0], 0.5);
+}
+
+TEST(Powertrain, InstalledRangeTaskMatchesDirectIntegration) {
+    auto fill = [](PowertrainBatch& p) {
+        for (std::size_t i = 0; i < p.size(); ++i) {
+            p.gear[i] = std::int32_t(i % 9) - 1;      // includes out-of-range gears
+            p.throttle[i] = double(i % 11) / 10.0;
+            p.clutch[i] = double(i % 5) / 4.0;
+            p.engineSpeed[i] = 100.0 + double(i % 600);
+            p.wheelSpeedLeft[i] = double(i % 70);
+            p.wheelSpeedRight[i] = double(i % 70) + 0.5;
+        }
+    };
+    PowertrainBatch a(1000), ref(1000);
+    fill(a);
+    fill(ref);
+    SimCore::Settings st;
+    st.hz = 1000.0;
+    st.maxFrames = -1;
+    st.threads = 3;
+    st.chunkSize = 64;
+    st.driftLogInterval = 0;
+    SimCore sim(st);
+    a.install(sim, sim.addPhase("Powertrain"));
+    sim.step(3);
+    for (int f = 0; f < 3; ++f) ref.integrate(0, ref.size(), sim.dtSeconds());
+    EXPECT_EQ(a.engineSpeed, ref.engineSpeed);
+    EXPECT_EQ(a.drivelineSpeed, ref.drivelineSpeed);
+    EXPECT_EQ(a.torqueLeft, ref.torqueLeft);
+    EXPECT_EQ(a.clutchTorque, ref.clutchTorque);
+}
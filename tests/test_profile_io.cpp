@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include "profiler.hpp"
+#include "profile_io.hpp"
+#include "histogram.hpp"
+#include <cstdio>
+
+TEST(LogHistogram, PercentilesWithinBucketError) {
+    LogHistogram h;
+    for (std::uint64_t v = 1; v <= 100000; ++v) h.record(v);
+    EXPECT_EQ(h.count(), 100000u);
+    EXPECT_NEAR(double(h.percentile(0.50)), 50000.0, 50000.0 * 0.04);
+    EXPECT_NEAR(double(h.percentile(0.99)), 99000.0, 99000.0 * 0.04);
+    EXPECT_EQ(h.percentile(1.0), 100000u);
+}
+
+TEST(ProfileFile, RoundTripAndCompare) {
+#ifdef PROF_ENABLED
+    Profiler base, slow;
+    for (int i = 0; i < 2000; ++i) {
+        base.record("Phase:Physics", 1000.0L + (i % 10));
+        slow.record("Phase:Physics", 1100.0L + (i % 10));
+        base.record("Phase:Input", 500.0L + (i % 7));
+        slow.record("Phase:Input", 500.0L + (i % 7));
+    }
+    const std::string path = ::testing::TempDir() + "simcore_profile_test.json";
+    ASSERT_TRUE(ProfileFile::save(path, base.summary(), "base \"run\""));
+
+    ProfileRun a;
+    std::string err;
+    ASSERT_TRUE(ProfileFile::load(path, a, &err)) << err;
+    std::remove(path.c_str());
+    EXPECT_EQ(a.label, "base \"run\"");
+    ASSERT_EQ(a.sections.size(), 2u);
+    const auto* phys = a.find("Phase:Physics");
+    ASSERT_NE(phys, nullptr);
+    EXPECT_EQ(phys->count, 2000u);
+    EXPECT_NEAR(double(phys->meanNs()), 1004.5, 1e-6);
+    EXPECT_GT(phys->p99Ns, phys->p50Ns - 1);
+
+    ProfileRun b{ProfileRun::kVersion, "slow", ProfileFile::sections(slow.summary())};
+    auto deltas = ProfileFile::compare(a, b);
+    ASSERT_EQ(deltas.size(), 2u);
+    EXPECT_EQ(deltas[0].name, "Phase:Input");
+    EXPECT_FALSE(deltas[0].significant);
+    EXPECT_EQ(deltas[1].name, "Phase:Physics");
+    EXPECT_TRUE(deltas[1].significant);
+    EXPECT_NEAR(deltas[1].deltaPct, 9.96, 0.05);
+    EXPECT_LT(deltas[1].ciLowPct, deltas[1].deltaPct);
+    EXPECT_GT(deltas[1].ciHighPct, deltas[1].deltaPct);
+#else
+    GTEST_SKIP() << "Profiler disabled";
+#endif
+}
+
+TEST(ProfileFile, FromBenchmarkJsonKeepsRepetitions) {
+    const char* text = R"({"context": {"host_name": "h"}, "benchmarks": [
+        {"name": "BM_A", "run_name": "BM_A", "run_type": "iteration", "real_time": 1.0, "cpu_time": 0.5, "time_unit": "us"},
+        {"name": "BM_A", "run_name": "BM_A", "run_type": "iteration", "real_time": 3.0, "cpu_time": 0.5, "time_unit": "us"},
+        {"name": "BM_A_mean", "run_name": "BM_A", "run_type": "aggregate", "real_time": 2.0, "cpu_time": 0.5, "time_unit": "us"},
+        {"name": "BM_B/8", "run_name": "BM_B/8", "run_type": "iteration", "real_time": 7.0, "cpu_time": 7.0, "time_unit": "ns"}
+    ]})";
+    Json doc;
+    ASSERT_TRUE(Json::parse(text, doc));
+    ProfileRun run;
+    ASSERT_TRUE(ProfileFile::fromBenchmarkJson(doc, run));
+    ASSERT_EQ(run.sections.size(), 2u);
+    EXPECT_EQ(run.sections[0].name, "BM_A");
+    EXPECT_EQ(run.sections[0].count, 2u);
+    EXPECT_NEAR(double(run.sections[0].totalNs), 4000.0, 1e-9);
+    EXPECT_NEAR(double(run.sections[0].minNs), 1000.0, 1e-9);
+    EXPECT_NEAR(double(run.sections[0].maxNs), 3000.0, 1e-9);
+    EXPECT_NEAR(double(run.sections[0].meanNs()), 2000.0, 1e-9);     // with or without PROF_ENABLED
+    EXPECT_NEAR(double(run.sections[0].stddevNs()), 1414.2136, 1e-3);
+    EXPECT_EQ(run.sections[1].name, "BM_B/8");
+    EXPECT_NEAR(double(run.sections[1].totalNs), 7.0, 1e-9);
+
+    ASSERT_TRUE(ProfileFile::fromBenchmarkJson(doc, run, /*cpuTime=*/true));
+    EXPECT_NEAR(double(run.sections[0].totalNs), 1000.0, 1e-9);
+}
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "scenario.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+std::string tempPath(const char* tag) {
+    return "/tmp/simcore_scenario_" + std::string(tag) + "_" + std::to_string(::getpid()) + ".scn";
+}
+}
+
+TEST(Scenario, RoundTripMapsColumns) {
+    const std::string path = tempPath("rt");
+    std::vector<double> mass(1000);
+    std::vector<std::int32_t> gear(1000);
+    for (std::size_t i = 0; i < mass.size(); ++i) { mass[i] = 700.0 + double(i); gear[i] = std::int32_t(i % 7); }
+    std::vector<float> grip = {1.1f};
+
+    ScenarioWriter w;
+    ASSERT_TRUE(w.addColumn("vehicles.mass", mass));
+    ASSERT_TRUE(w.addColumn("vehicles.gear", gear));
+    ASSERT_TRUE(w.addColumn("track.grip", grip));
+    EXPECT_FALSE(w.addColumn("vehicles.mass", mass));
+    ASSERT_TRUE(w.write(path));
+
+    Scenario s;
+    ASSERT_TRUE(s.open(path, true)) << s.error();
+    EXPECT_EQ(s.columnCount(), 3u);
+    EXPECT_EQ(s.rows("vehicles.mass"), 1000u);
+    EXPECT_EQ(s.rows("missing"), 0u);
+
+    std::size_t n = 0;
+    const double* m = s.view<double>("vehicles.mass", &n);
+    ASSERT_NE(m, nullptr);
+    EXPECT_EQ(n, 1000u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(m) % 64, 0u);
+    EXPECT_DOUBLE_EQ(m[999], 1699.0);
+    EXPECT_EQ(s.view<float>("vehicles.mass"), nullptr);
+
+    std::vector<std::int32_t> g;
+    ASSERT_TRUE(s.load("vehicles.gear", g));
+    EXPECT_EQ(g, gear);
+    std::vector<float> gr;
+    ASSERT_TRUE(s.load("track.grip", gr));
+    EXPECT_FLOAT_EQ(gr[0], 1.1f);
+    std::remove(path.c_str());
+}
+
+TEST(Scenario, RejectsCorruptFiles) {
+    const std::string path = tempPath("bad");
+    std::vector<double> v(64, 1.0);
+    ScenarioWriter w;
+    ASSERT_TRUE(w.addColumn("a.x", v));
+    ASSERT_TRUE(w.write(path));
+
+    std::string bytes;
+    { std::ifstream in(path, std::ios::binary); bytes.assign(std::istreambuf_iterator<char>(in), {}); }
+    auto rewrite = [&](const std::string& b) { std::ofstream(path, std::ios::binary | std::ios::trunc) << b; };
+
+    Scenario s;
+    // Flipped payload byte: header is fine, checksum is not.
+    std::string flipped = bytes;
+    flipped.back() ^= 0x1;
+    rewrite(flipped);
+    EXPECT_TRUE(s.open(path));
+    EXPECT_FALSE(s.open(path, true));
+    EXPECT_EQ(s.error(), "checksum mismatch");
+
+    rewrite(bytes.substr(0, bytes.size() - 8));
+    EXPECT_FALSE(s.open(path));
+    EXPECT_FALSE(s.valid());
+
+    std::string badMagic = bytes;
+    badMagic[0] = 'X';
+    rewrite(badMagic);
+    EXPECT_FALSE(s.open(path));
+    EXPECT_EQ(s.error(), "bad magic");
+
+    EXPECT_FALSE(s.open(path + ".missing"));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "simcore.hpp"
+#include "telemetry.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+TEST(Telemetry, CodecsRoundTrip) {
+    std::vector<double> f = {0.0, 0.0, 1.5, -1.5, 1e300, std::nan(""), 3.14159, 3.14159};
+    std::vector<std::int64_t> i = {0, 5, -7, (1LL << 53) + 1, INT64_MAX, INT64_MIN, -3};
+    std::vector<std::uint8_t> buf;
+    std::vector<double> out(f.size());
+    TelemetryCodec::encodeXor(f.data(), f.size(), buf);
+    ASSERT_TRUE(TelemetryCodec::decodeXor(buf.data(), buf.size(), f.size(), out.data()));
+    EXPECT_EQ(0, std::memcmp(f.data(), out.data(), f.size() * sizeof(double)));
+
+    buf.clear();
+    std::vector<std::int64_t> iout(i.size());
+    TelemetryCodec::encodeDelta(i.data(), i.size(), buf);
+    ASSERT_TRUE(TelemetryCodec::decodeDelta(buf.data(), buf.size(), i.size(), iout.data()));
+    EXPECT_EQ(i, iout);
+}
+
+TEST(Telemetry, RecordsDecimatedFramesFromSim) {
+    const std::string path = ::testing::TempDir() + "simcore_telemetry_test.stel";
+    const std::size_t N = 50;
+    std::vector<double> speed(N, 0.0);
+    std::vector<std::int32_t> gear(N, 1);
+    std::vector<std::int64_t> stamp(1, 0);   // beyond 2^53: must not go through double
+
+    {
+        TelemetryRecorder::Config cfg;
+        cfg.path = path;
+        cfg.decimation = 2;
+        cfg.blockSamples = 16;
+        TelemetryRecorder rec(cfg);
+        EXPECT_EQ(rec.addColumn("speed", speed), N);
+        ASSERT_TRUE(rec.addChannel("gear0", gear, 0));
+        ASSERT_TRUE(rec.addChannel("stamp", stamp));
+
+        SimCore::Settings s;
+        s.maxFrames = -1;
+        s.threads = 2;
+        s.driftLogInterval = 0;
+        SimCore sim(s);
+        sim.setTelemetry(&rec);
+        auto ph = sim.addPhase("Physics", N);
+        sim.addParallelRangeTask(ph, [&](std::size_t b, std::size_t e, std::int64_t f, SimCore::Seconds){
+            for (std::size_t k=b;k<e;++k) speed[k] = std::sin(double(f) * 0.01 + double(k));
+            if (b == 0) { gear[0] = std::int32_t(f / 10); stamp[0] = (std::int64_t(1) << 60) + 2 * f + 1; }
+        });
+        sim.step(101);
+        rec.flush();
+        EXPECT_EQ(rec.samples(), 51u);
+        EXPECT_EQ(rec.droppedBlocks(), 0u);
+    }
+
+    TelemetryReader rd(path);
+    ASSERT_TRUE(rd.ok());
+    EXPECT_EQ(rd.channelCount(), N + 2);
+    EXPECT_EQ(rd.sampleCount(), 51u);
+    EXPECT_EQ(rd.blockCount(), 4u);
+    auto frames = rd.frames();
+    ASSERT_EQ(frames.size(), 51u);
+    EXPECT_EQ(frames[1], 2);
+    EXPECT_EQ(frames.back(), 100);
+
+    std::vector<double> v;
+    ASSERT_TRUE(rd.readChannel(static_cast<std::size_t>(rd.channelIndex("speed[7]")), v));
+    EXPECT_DOUBLE_EQ(v[10], std::sin(20 * 0.01 + 7.0));
+    ASSERT_TRUE(rd.readChannel(static_cast<std::size_t>(rd.channelIndex("gear0")), v));
+    EXPECT_DOUBLE_EQ(v.back(), 10.0);
+    std::vector<std::int64_t> iv;
+    const auto st = static_cast<std::size_t>(rd.channelIndex("stamp"));
+    EXPECT_TRUE(rd.isInteger(st));
+    ASSERT_TRUE(rd.readChannel(st, iv));
+    EXPECT_EQ(iv[3], (std::int64_t(1) << 60) + 13);
+    EXPECT_EQ(iv.back(), (std::int64_t(1) << 60) + 201);
+    EXPECT_FALSE(rd.readChannel(static_cast<std::size_t>(rd.channelIndex("speed[0]")), iv));
+    std::remove(path.c_str());
+}
+
+TEST(Telemetry, BlocksLargerThanTheIoPoolAreWrittenWhole) {
+    const std::string path = ::testing::TempDir() + "simcore_telemetry_pool.stel";
+    const std::size_t N = 200;
+    std::vector<double> noise(N, 0.0);
+    AsyncIO::Config ioCfg;
+    ioCfg.bufferSize = 4096;
+    ioCfg.bufferCount = 4;          // a block is several times the whole pool
+    AsyncIO io(ioCfg);
+    std::uint64_t bytes = 0;
+    {
+        TelemetryRecorder::Config cfg;
+        cfg.path = path;
+        cfg.blockSamples = 64;
+        cfg.queueBlocks = 64;
+        cfg.io = &io;
+        TelemetryRecorder rec(cfg);
+        EXPECT_EQ(rec.addColumn("noise", noise), N);
+        ASSERT_TRUE(rec.open());
+        for (std::int64_t f = 0; f < 640; ++f) {
+            for (std::size_t k = 0; k < N; ++k) noise[k] = std::sin(double(f) * 1.7 + double(k) * 0.3);
+            rec.record(f);
+        }
+        rec.flush();
+        EXPECT_TRUE(rec.ok());
+        EXPECT_EQ(rec.droppedBlocks(), 0u);
+        bytes = rec.bytesWritten();
+    }
+    EXPECT_EQ(io.droppedBytes(), 0u);
+    EXPECT_EQ(io.writeErrors(), 0u);
+
+    TelemetryReader rd(path);
+    ASSERT_TRUE(rd.ok());
+    EXPECT_EQ(rd.blockCount(), 10u);
+    EXPECT_EQ(rd.sampleCount(), 640u);
+    std::ifstream f(path, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(static_cast<std::uint64_t>(f.tellg()), bytes);
+    std::vector<double> v;
+    ASSERT_TRUE(rd.readChannel(static_cast<std::size_t>(rd.channelIndex("noise[199]")), v));
+    EXPECT_DOUBLE_EQ(v[639], std::sin(639 * 1.7 + 199 * 0.3));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include "terrain.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unistd.h>
+
+namespace {
+std::string tempPath(const char* tag) {
+    return "/tmp/simcore_terrain_" + std::string(tag) + "_" + std::to_string(::getpid()) + ".ter";
+}
+
+// h = 0.25 x - 0.5 y + 3 on a 0.5 m grid offset to (-10, 5); bilinear
+// interpolation reproduces a plane exactly. Materials: 1 where cx+cy is odd.
+std::string writePlane(const char* tag, std::uint32_t sx, std::uint32_t sy) {
+    TerrainWriter w(sx, sy, 0.5, -10.0, 5.0);
+    for (std::uint32_t y = 0; y < sy; ++y)
+        for (std::uint32_t x = 0; x < sx; ++x)
+            w.height(x, y) = float(0.25 * (-10.0 + 0.5 * x) - 0.5 * (5.0 + 0.5 * y) + 3.0);
+    for (std::uint32_t y = 0; y + 1 < sy; ++y)
+        for (std::uint32_t x = 0; x + 1 < sx; ++x)
+            w.material(x, y) = std::uint8_t((x + y) & 1);
+    w.setFriction(0, 1.0f);
+    w.setFriction(1, 0.5f);
+    const std::string path = tempPath(tag);
+    EXPECT_TRUE(w.write(path));
+    return path;
+}
+
+double plane(double x, double y) { return 0.25 * x - 0.5 * y + 3.0; }
+}
+
+TEST(Terrain, BatchedQueriesInterpolateAPlaneAndLookUpMaterials) {
+    const std::string path = writePlane("plane", 100, 37);    // tile counts not powers of two
+    Terrain t;
+    ASSERT_TRUE(t.open(path)) << t.error();
+    EXPECT_EQ(t.header().tilesX, 33u);
+    EXPECT_EQ(t.header().tilesY, 12u);
+    EXPECT_DOUBLE_EQ(t.sizeX(), 49.5);
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> ux(-10.0, 39.5), uy(5.0, 23.0);
+    TerrainQueries q;
+    q.resize(1000);
+    for (std::size_t i = 0; i < q.size(); ++i) { q.x[i] = ux(rng); q.y[i] = uy(rng); }
+    q.x[0] = -10.0; q.y[0] = 5.0;                              // corners and far edges
+    q.x[1] = 39.5;  q.y[1] = 23.0;
+    q.x[2] = 39.5;  q.y[2] = 5.0;
+    t.query(q, 0, q.size());
+
+    const double n = 1.0 / std::sqrt(0.25 * 0.25 + 0.5 * 0.5 + 1.0);
+    for (std::size_t i = 0; i < q.size(); ++i) {
+        ASSERT_NEAR(q.height[i], plane(q.x[i], q.y[i]), 1e-5) << i;
+        EXPECT_NEAR(q.normalX[i], -0.25 * n, 1e-5);
+        EXPECT_NEAR(q.normalY[i], 0.5 * n, 1e-5);
+        EXPECT_NEAR(q.normalZ[i], n, 1e-5);
+        const double cx = std::min(std::floor((q.x[i] + 10.0) * 2.0), 98.0);
+        const double cy = std::min(std::floor((q.y[i] - 5.0) * 2.0), 35.0);
+        EXPECT_EQ(q.friction[i], (long(cx + cy) & 1) ? 0.5 : 1.0) << i;
+        double mu = 0.0;
+        EXPECT_DOUBLE_EQ(t.heightAt(q.x[i], q.y[i], &mu), q.height[i]);
+        EXPECT_EQ(mu, q.friction[i]);
+    }
+
+    q.x[0] = -100.0; q.y[0] = 1000.0;                          // clamped to the edge
+    t.query(q, 0, 1);
+    EXPECT_NEAR(q.height[0], plane(-10.0, 23.0), 1e-5);
+    t.prefetch(-20.0, 0.0, 50.0, 30.0);
+    std::remove(path.c_str());
+}
+
+TEST(Terrain, SortedAndUnsortedBatchesAgreeThroughSimCore) {
+    TerrainWriter w(193, 97, 1.0);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> hgt(-2.0f, 2.0f);
+    for (std::uint32_t y = 0; y < 97; ++y)
+        for (std::uint32_t x = 0; x < 193; ++x) w.height(x, y) = hgt(rng);
+    for (std::uint32_t y = 0; y < 96; ++y)
+        for (std::uint32_t x = 0; x < 192; ++x) w.material(x, y) = std::uint8_t((x / 7 + y / 5) % 4);
+    for (std::uint8_t m = 0; m < 4; ++m) w.setFriction(m, 0.4f + 0.2f * m);
+    const std::string path = tempPath("sort");
+    ASSERT_TRUE(w.write(path));
+
+    TerrainQueries ref;
+    ref.resize(2000);
+    std::uniform_real_distribution<double> ux(-5.0, 200.0), uy(-5.0, 100.0);
+    for (std::size_t i = 0; i < ref.size(); ++i) { ref.x[i] = ux(rng); ref.y[i] = uy(rng); }
+    TerrainQueries q = ref;
+
+    Terrain::Config cfg;
+    cfg.sortByTile = false;
+    Terrain plain(cfg);
+    ASSERT_TRUE(plain.open(path)) << plain.error();
+    plain.query(ref, 0, ref.size());
+
+    cfg.sortByTile = true;
+    cfg.batch = 64;
+    cfg.lookahead = 10.0;
+    Terrain sorted(cfg);
+    ASSERT_TRUE(sorted.open(path)) << sorted.error();
+    SimCore::Settings st;
+    st.maxFrames = -1;
+    st.threads = 3;
+    st.driftLogInterval = 0;
+    SimCore sim(st);
+    sorted.install(sim, q);
+    sim.step(1);
+    EXPECT_EQ(sorted.prefetchPasses(), 1u);
+    EXPECT_EQ(q.height, ref.height);
+    EXPECT_EQ(q.normalX, ref.normalX);
+    EXPECT_EQ(q.normalY, ref.normalY);
+    EXPECT_EQ(q.friction, ref.friction);
+    sim.step(32);
+    EXPECT_EQ(sorted.prefetchPasses(), 3u);     // frames 0, 16, 32
+    std::remove(path.c_str());
+}
+
+TEST(Terrain, OpenRejectsBadFiles) {
+    const std::string path = writePlane("bad", 10, 10);
+    Terrain t;
+    EXPECT_FALSE(t.open(tempPath("missing")));
+    EXPECT_FALSE(t.valid());
+
+    std::FILE* f = std::fopen(path.c_str(), "r+b");
+    ASSERT_NE(f, nullptr);
+    const std::uint32_t junk = 0;
+    std::fwrite(&junk, sizeof(junk), 1, f);
+    std::fclose(f);
+    EXPECT_FALSE(t.open(path));
+    EXPECT_EQ(t.error(), "bad magic");
+
+    writePlane("bad", 10, 10);
+    ASSERT_EQ(::truncate(path.c_str(), 512), 0);
+    EXPECT_FALSE(t.open(path));
+    EXPECT_EQ(t.error(), "size mismatch");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "simcore.hpp"
+#include "logger.hpp"
+#include "trace_capture.hpp"
+#include <cstdio>
+#include <thread>
+
+namespace {
+bool readBack(TraceCapture& trace, TraceFileHeader& hdr, std::string& settings,
+              std::vector<TraceEvent>& events) {
+    trace.flush();
+    auto files = trace.writtenFiles();
+    if (files.size() != 1u) return false;
+    bool ok = TraceCapture::readFile(files[0], hdr, settings, events);
+    std::remove(files[0].c_str());
+    return ok;
+}
+}
+
+// Frames driven by hand, so the deadline miss lands on a known frame.
+TEST(TraceCapture, FreezesWindowAroundLateFrame) {
+    TraceCapture::Config tc;
+    tc.framesBefore = 10;
+    tc.framesAfter  = 5;
+    tc.latenessMs   = 2.0;
+    tc.driftJumpMs  = 1e9;   // lateness trigger only
+    tc.maxCaptures  = 1;
+    tc.pathPrefix   = ::testing::TempDir() + "simcore_trace_test";
+    TraceCapture trace(tc);
+    trace.setSettingsTag("threads=2");
+
+    std::int64_t frame = 0;
+    auto step = [&] {
+        trace.beginFrame(frame);
+        trace.record(TraceKind::FrameBegin, frame, 0, 0);
+        trace.record(TraceKind::FrameEnd, frame, 0, 0);
+        ++frame;
+    };
+    while (frame < 200) {
+        const std::int64_t paced = frame;
+        step();
+        const bool late = paced == 100;
+        if (late) { step(); step(); }            // two catch-up steps after the late frame
+        trace.endFrame(paced, late ? 6'000'000 : 0, 0.0);
+        if (late) trace.setSettingsTag("threads=4");   // after the trigger: not this capture's
+    }
+
+    ASSERT_EQ(trace.captures(), 1);
+    TraceFileHeader hdr;
+    std::string settings;
+    std::vector<TraceEvent> events;
+    ASSERT_TRUE(readBack(trace, hdr, settings, events));
+
+    EXPECT_EQ(hdr.triggerFrame, 100);           // the late frame, not the last catch-up step
+    EXPECT_EQ(hdr.latenessNs, 6'000'000);
+    EXPECT_EQ(hdr.firstFrame, 90);
+    EXPECT_GE(hdr.lastFrame, 105);
+    EXPECT_EQ(hdr.truncated, 0u);
+    EXPECT_EQ(hdr.reason & TraceFileHeader::Lateness, TraceFileHeader::Lateness);
+    EXPECT_EQ(settings, "threads=2");           // tag at trigger time
+
+    ASSERT_FALSE(events.empty());
+    EXPECT_EQ(events.front().kind, TraceKind::FrameBegin);
+    EXPECT_EQ(events.front().frame, 90);
+    int frameBegins = 0;
+    for (auto& e : events)
+        if (e.kind == TraceKind::FrameBegin) ++frameBegins;
+    EXPECT_EQ(frameBegins, hdr.lastFrame - hdr.firstFrame + 1);
+}
+
+// Every frame counts as late, so the capture starts at frame 0 whatever
+// the machine load; the window holds whole events from the workers.
+TEST(TraceCapture, CapturesSimCoreFramesWithWorkerEvents) {
+    TraceCapture::Config tc;
+    tc.framesBefore = 10;
+    tc.framesAfter  = 20;
+    tc.latenessMs   = -1e9;
+    tc.driftJumpMs  = 1e9;
+    tc.maxCaptures  = 1;
+    tc.pathPrefix   = ::testing::TempDir() + "simcore_trace_sim_test";
+    TraceCapture trace(tc);
+
+    SimCore::Settings s;
+    s.hz = 1000.0;
+    s.maxFrames = 40;
+    s.threads = 2;
+    s.driftLogInterval = 0;
+
+    Logger log; log.setLevel(Logger::Level::Error);
+    SimCore sim(s);
+    sim.setLogger(&log);
+    sim.setTraceCapture(&trace);
+
+    auto phase = sim.addPhase("Work", 512);
+    sim.addParallelRangeTask(phase, [](std::size_t, std::size_t, int64_t, SimCore::Seconds){});
+    sim.run();
+
+    ASSERT_EQ(trace.captures(), 1);
+    TraceFileHeader hdr;
+    std::string settings;
+    std::vector<TraceEvent> events;
+    ASSERT_TRUE(readBack(trace, hdr, settings, events));
+
+    EXPECT_EQ(hdr.triggerFrame, 0);
+    EXPECT_EQ(hdr.firstFrame, 0);
+    EXPECT_GE(hdr.lastFrame, 20);
+    EXPECT_NE(settings.find("threads=2"), std::string::npos);
+    ASSERT_FALSE(events.empty());
+    EXPECT_EQ(events.front().kind, TraceKind::FrameBegin);
+    EXPECT_EQ(events.front().frame, 0);
+    for (auto& e : events) {
+        EXPECT_LE(e.kind, TraceKind::CatchUp);
+        EXPECT_LE(e.thread, 2u);
+        EXPECT_GE(e.frame, 0);
+        EXPECT_LE(e.frame, hdr.lastFrame);
+        EXPECT_GT(e.tsNs, 0u);
+    }
+}
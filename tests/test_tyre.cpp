@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include "tyre.hpp"
+#include <cmath>
+
+TEST(Tyre, SimdMathMatchesLibm) {
+    double atanErr = 0.0, sinErr = 0.0;
+    for (int i = -200000; i <= 200000; ++i) {
+        const double x = double(i) * 1e-3;                 // [-200, 200]
+        atanErr = std::max(atanErr, std::fabs(simd::atan(x) - std::atan(x)));
+        sinErr  = std::max(sinErr,  std::fabs(simd::sin(x)  - std::sin(x)));
+    }
+    EXPECT_LT(atanErr, 1e-9);
+    EXPECT_LT(sinErr, 1e-11);
+    EXPECT_EQ(simd::atan(0.0), 0.0);
+    EXPECT_DOUBLE_EQ(simd::atan(1e300), simd::kHalfPi);
+}
+
+TEST(Tyre, BatchMatchesScalarReference) {
+    const std::size_t n = 4096;
+    TyreBatch simdT(n), ref(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const double u = double(i) / double(n - 1);
+        for (auto* t : {&simdT, &ref}) {
+            t->slipRatio[i] = -1.0 + 2.0 * u;
+            t->slipAngle[i] = 0.5 * std::sin(37.0 * u);
+            t->load[i]      = 500.0 + 7000.0 * std::fmod(u * 13.0, 1.0);
+            t->grip[i]      = 0.6 + 0.4 * u;
+        }
+    }
+    ref.load[7] = simdT.load[7] = -10.0;                   // wheel in the air
+    simdT.evaluate(0, n);
+    ref.evaluateReference(0, n);
+
+    double maxErr = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        const double peak = std::max(ref.load[i], 0.0) * ref.grip[i];
+        if (peak > 0.0) {
+            maxErr = std::max(maxErr, std::fabs(simdT.fx[i] - ref.fx[i]) / peak);
+            maxErr = std::max(maxErr, std::fabs(simdT.fy[i] - ref.fy[i]) / peak);
+        }
+        // Combined forces never leave the friction ellipse.
+        const double ex = ref.fx[i] / (ref.config().lon.D * std::max(peak, 1e-9));
+        const double ey = ref.fy[i] / (ref.config().lat.D * std::max(peak, 1e-9));
+        EXPECT_LE(ex * ex + ey * ey, 1.0 + 1e-9);
+    }
+    EXPECT_LT(maxErr, 1e-8);
+    EXPECT_EQ(simdT.fx[7], 0.0);
+    EXPECT_EQ(simdT.fy[7], 0.0);
+}
+
+TEST(Tyre, RunsAsRangeTask) {
+    SimCore::Settings s;
+    s.maxFrames = -1;
+    s.threads = 2;
+    s.chunkSize = 64;
+    s.driftLogInterval = 0;
+    SimCore sim(s);
+    TyreBatch tyres(1000);
+    auto ph = sim.addPhase("Tyres");
+    tyres.install(sim, ph);
+    std::fill(tyres.load.begin(), tyres.load.end(), 4000.0);
+    std::fill(tyres.slipRatio.begin(), tyres.slipRatio.end(), 0.05);
+    sim.step();
+    const double expect = TyreBatch::magicFormula(tyres.config().lon, 0.05, 4000.0);
+    EXPECT_NEAR(tyres.fx.front(), expect, 1e-6);
+    EXPECT_NEAR(tyres.fx.back(), expect, 1e-6);
+    EXPECT_EQ(tyres.fy[500], 0.0);
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "simcore.hpp"
+#include "workloads.hpp"
+#include <algorithm>
+#include <vector>
+
+static SimCore::Settings headless(std::size_t threads) {
+    SimCore::Settings s;
+    s.maxFrames = -1;
+    s.threads = threads;
+    s.chunkSize = 64;
+    s.driftLogInterval = 0;
+    return s;
+}
+
+TEST(SyntheticWorkload, CostDistributions) {
+    SyntheticWorkload::Config cfg;
+    cfg.dist = SyntheticWorkload::Dist::HeavyTailed;
+    SyntheticWorkload heavy(20000, cfg);
+    auto c = heavy.costs();
+    std::sort(c.begin(), c.end());
+    EXPECT_GE(c.front(), cfg.baseCost);
+    EXPECT_GT(c.back(), 20u * c[c.size() / 2]);   // long tail well above the median
+
+    cfg.dist = SyntheticWorkload::Dist::TimeVarying;
+    SyntheticWorkload varying(1000, cfg);
+    EXPECT_NE(varying.costAt(0, 0), varying.costAt(0, cfg.periodFrames / 8));
+    EXPECT_EQ(varying.totalUnits(0), varying.totalUnits(cfg.periodFrames));
+
+    EXPECT_TRUE(SyntheticWorkload::parse("hotspots+memory+pipeline", cfg));
+    EXPECT_EQ(cfg.dist, SyntheticWorkload::Dist::Hotspots);
+    EXPECT_EQ(cfg.kernel, SyntheticWorkload::Kernel::Memory);
+    EXPECT_EQ(cfg.shape, SyntheticWorkload::Shape::Pipeline);
+    EXPECT_FALSE(SyntheticWorkload::parse("heavy+bogus", cfg));
+}
+
+TEST(SyntheticWorkload, SameOutputForAnyThreadCount) {
+    SyntheticWorkload::Config cfg;
+    cfg.dist = SyntheticWorkload::Dist::Hotspots;
+    cfg.kernel = SyntheticWorkload::Kernel::Memory;
+    cfg.shape = SyntheticWorkload::Shape::Pipeline;
+    cfg.tableBytes = 1u << 20;
+
+    auto run = [&](std::size_t threads) {
+        SimCore sim(headless(threads));
+        SyntheticWorkload w(3000, cfg);
+        w.install(sim);
+        sim.step(5);
+        return std::make_pair(w.output(), w.checksum());
+    };
+    auto a = run(1);
+    auto b = run(3);
+    EXPECT_EQ(a.first, b.first);
+    EXPECT_DOUBLE_EQ(a.second, b.second);
+    EXPECT_NE(a.second, 0.0);
+}
+
+TEST(SyntheticWorkload, EmptyWorkloadStepsInEveryShape) {
+    for (auto shape : {SyntheticWorkload::Shape::Single, SyntheticWorkload::Shape::MultiTask,
+                       SyntheticWorkload::Shape::Pipeline}) {
+        SyntheticWorkload::Config cfg;
+        cfg.dist = SyntheticWorkload::Dist::TimeVarying;
+        cfg.shape = shape;
+        SimCore sim(headless(2));
+        SyntheticWorkload w(0, cfg);
+        w.install(sim);
+        sim.step(3);
+        EXPECT_EQ(w.totalUnits(), 0u);
+        EXPECT_EQ(w.checksum(), 0.0);
+    }
+}
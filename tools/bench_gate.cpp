@@ -0,0 +1,125 @@
+// Benchmark regression gate. Runs simcore_bench (or reads an existing
+// Google Benchmark JSON result), stores it as a ProfileFile baseline and
+// compares later runs against it. A benchmark regresses when the Welch CI
+// on the mean excludes zero and the slowdown exceeds both --threshold and
+// --noise-mult x the larger coefficient of variation of the two runs.
+//
+//   simcore_bench_gate --bench ./simcore_bench --save-baseline bench/baselines/host.json
+//   simcore_bench_gate --bench ./simcore_bench --baseline bench/baselines/host.json
+//
+// Exit: 0 no regression, 1 regression, 2 usage / IO error.
+#include "profile_io.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static double parseDouble(const char* s, double def){ if(!s) return def; char* e=nullptr; double v=strtod(s,&e); return (e && *e==0)? v: def; }
+static long   parseLong  (const char* s, long def){ if(!s) return def; char* e=nullptr; long v=strtol(s,&e,10); return (e && *e==0)? v: def; }
+
+static double cvPct(const ProfileSection* e) {
+    if (!e || e->meanNs() <= 0) return 0.0;
+    return 100.0 * double(e->stddevNs() / e->meanNs());
+}
+
+int main(int argc, char* argv[]) {
+    std::string benchExe, inputPath, outPath = "simcore_bench_results.json";
+    std::string baselinePath, savePath, label, filter;
+    long reps = 10;
+    bool cpuTime = false;
+    double confidence = 0.99;
+    double thresholdPct = 5.0;
+    double noiseMult = 2.0;
+
+    for (int i=1;i<argc;++i){
+        if (std::strcmp(argv[i],"--bench")==0 && i+1<argc) benchExe = argv[++i];
+        else if (std::strcmp(argv[i],"--input")==0 && i+1<argc) inputPath = argv[++i];
+        else if (std::strcmp(argv[i],"--out")==0 && i+1<argc) outPath = argv[++i];
+        else if (std::strcmp(argv[i],"--baseline")==0 && i+1<argc) baselinePath = argv[++i];
+        else if (std::strcmp(argv[i],"--save-baseline")==0 && i+1<argc) savePath = argv[++i];
+        else if (std::strcmp(argv[i],"--label")==0 && i+1<argc) label = argv[++i];
+        else if (std::strcmp(argv[i],"--filter")==0 && i+1<argc) filter = argv[++i];
+        else if (std::strcmp(argv[i],"--reps")==0 && i+1<argc) reps = parseLong(argv[++i], reps);
+        else if (std::strcmp(argv[i],"--cpu-time")==0) cpuTime = true;
+        else if (std::strcmp(argv[i],"--confidence")==0 && i+1<argc) confidence = parseDouble(argv[++i], confidence);
+        else if (std::strcmp(argv[i],"--threshold")==0 && i+1<argc) thresholdPct = parseDouble(argv[++i], thresholdPct);
+        else if (std::strcmp(argv[i],"--noise-mult")==0 && i+1<argc) noiseMult = parseDouble(argv[++i], noiseMult);
+        else { benchExe.clear(); inputPath.clear(); break; }
+    }
+    if ((benchExe.empty() == inputPath.empty()) || (baselinePath.empty() && savePath.empty()) ||
+        reps < 2 || confidence <= 0.0 || confidence >= 1.0) {
+        std::fprintf(stderr,
+            "usage: %s (--bench EXE [--reps N] [--filter RE] [--out run.json] | --input run.json)\n"
+            "          [--save-baseline FILE [--label TEXT]] [--baseline FILE]\n"
+            "          [--cpu-time] [--confidence 0.99] [--threshold pct] [--noise-mult k]\n",
+            argv[0]);
+        return 2;
+    }
+
+    if (!benchExe.empty()) {
+        // Console output stays visible as progress; JSON goes to --out.
+        std::string cmd = "\"" + benchExe + "\" --benchmark_out_format=json --benchmark_out=\"" + outPath +
+                          "\" --benchmark_repetitions=" + std::to_string(reps);
+        if (!filter.empty()) cmd += " --benchmark_filter=\"" + filter + "\"";
+        std::fprintf(stderr, "running: %s\n", cmd.c_str());
+        if (std::system(cmd.c_str()) != 0) {
+            std::fprintf(stderr, "benchmark run failed\n");
+            return 2;
+        }
+        inputPath = outPath;
+    }
+
+    Json doc;
+    ProfileRun cur;
+    std::string err;
+    if (!Json::parseFile(inputPath, doc, &err) || !ProfileFile::fromBenchmarkJson(doc, cur, cpuTime, &err)) {
+        std::fprintf(stderr, "%s: %s\n", inputPath.c_str(), err.c_str());
+        return 2;
+    }
+    const Json& ctx = doc["context"];
+    cur.label = label.empty() ? ctx["host_name"].str() + " " + ctx["date"].str() : label;
+    cur.label += cpuTime ? " (cpu_time)" : " (real_time)";
+
+    if (!savePath.empty()) {
+        if (!ProfileFile::save(savePath, cur.sections, cur.label)) {
+            std::fprintf(stderr, "cannot write %s\n", savePath.c_str());
+            return 2;
+        }
+        std::printf("baseline: %zu benchmarks -> %s [%s]\n", cur.sections.size(), savePath.c_str(), cur.label.c_str());
+    }
+    if (baselinePath.empty()) return 0;
+
+    ProfileRun base;
+    if (!ProfileFile::load(baselinePath, base, &err)) {
+        std::fprintf(stderr, "%s\n(record one with --save-baseline or the bench_baseline target)\n", err.c_str());
+        return 2;
+    }
+
+    auto deltas = ProfileFile::compare(base, cur, confidence, 0.0);
+    std::printf("base: %s [%s]\nnew:  %s [%s]\n%.1f%% CI, threshold max(%.1f%%, %.1f x CV)\n\n",
+                baselinePath.c_str(), base.label.c_str(), inputPath.c_str(), cur.label.c_str(),
+                confidence * 100.0, thresholdPct, noiseMult);
+    std::printf("%-44s %12s %12s %9s %21s %7s  %s\n",
+                "Benchmark", "base(ns)", "new(ns)", "delta", "CI", "limit", "verdict");
+
+    int regressed = 0, improved = 0;
+    for (auto& d : deltas) {
+        if (d.onlyInA || d.onlyInB) {
+            std::printf("%-44s %s\n", d.name.c_str(), d.onlyInA ? "(not run)" : "(new, no baseline)");
+            continue;
+        }
+        double limit = std::max(thresholdPct, noiseMult * std::max(cvPct(base.find(d.name)), cvPct(cur.find(d.name))));
+        const char* verdict = "ok";
+        if (d.significant && std::fabs(d.deltaPct) >= limit) {
+            if (d.deltaPct > 0) { verdict = "REGRESSED"; ++regressed; }
+            else                { verdict = "improved";  ++improved; }
+        }
+        std::printf("%-44s %12.2f %12.2f %+8.2f%% [%+8.2f%%,%+8.2f%%] %6.1f%%  %s\n",
+                    d.name.c_str(), d.meanA, d.meanB, d.deltaPct, d.ciLowPct, d.ciHighPct, limit, verdict);
+    }
+    std::printf("\n%d regressed, %d improved, %zu benchmarks\n", regressed, improved, deltas.size());
+    if (regressed) std::printf("FAIL: performance regression against %s\n", baselinePath.c_str());
+    return regressed ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+// Attaches to the shared-memory metrics block published by SimCore and
+// prints (or records as CSV) frame time, drift, phase cost and worker load.
+// Exits with status 3 once the frame counter has not moved for --stale ms
+// (producer gone or hung; 0 waits forever), since the segment outlives it.
+#include "metrics_shm.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+static long parseLong(const char* s, long def){ if(!s) return def; char* e=nullptr; long v=strtol(s,&e,10); return (e && *e==0)? v: def; }
+
+int main(int argc, char* argv[]) {
+    std::string name = "/simcore_metrics";
+    long intervalMs = 250;
+    long samples = -1;
+    long staleMs = 2000;
+    bool csv = false;
+
+    for (int i=1;i<argc;++i){
+        if (std::strcmp(argv[i],"--name")==0 && i+1<argc) name = argv[++i];
+        else if (std::strcmp(argv[i],"--interval")==0 && i+1<argc) intervalMs = parseLong(argv[++i], intervalMs);
+        else if (std::strcmp(argv[i],"--samples")==0 && i+1<argc) samples = parseLong(argv[++i], samples);
+        else if (std::strcmp(argv[i],"--stale")==0 && i+1<argc) staleMs = parseLong(argv[++i], staleMs);
+        else if (std::strcmp(argv[i],"--csv")==0) csv = true;
+        else {
+            std::fprintf(stderr, "usage: %s [--name /shm] [--interval ms] [--samples n] [--stale ms] [--csv]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    MetricsReader reader(name);
+    for (int tries = 0; !reader.ok() && tries < 50; ++tries) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        reader = MetricsReader(name);
+    }
+    if (!reader.ok()) {
+        std::fprintf(stderr, "metrics segment '%s' not found\n", name.c_str());
+        return 1;
+    }
+
+    MetricsBlock::Payload prev{}, cur{};
+    bool havePrev = false;
+    std::uint32_t headerVersion = ~0u;
+    using Clock = std::chrono::steady_clock;
+    auto lastProgress = Clock::now();
+    std::int64_t lastFrame = -1;
+    auto stale = [&] {
+        return staleMs > 0 && Clock::now() - lastProgress > std::chrono::milliseconds(staleMs);
+    };
+
+    for (long n = 0; samples < 0 || n < samples; ++n) {
+        if (!reader.read(cur)) {
+            if (stale()) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+        if (cur.frame != lastFrame) {
+            lastFrame = cur.frame;
+            lastProgress = Clock::now();
+        } else if (stale()) {
+            break;
+        }
+        if (havePrev && cur.frame < prev.frame) havePrev = false; // producer restarted
+
+        if (csv && headerVersion != cur.namesVersion) {
+            std::printf("frame,frame_us,lateness_us,drift_ms,catchup");
+            for (std::uint32_t i = 0; i < cur.phaseCount; ++i)
+                std::printf(",phase_%s_us", cur.phaseNames[i]);
+            for (std::uint32_t i = 0; i < cur.workerCount; ++i)
+                std::printf(",worker%u_util", i);
+            std::printf("\n");
+            headerVersion = cur.namesVersion;
+        }
+
+        std::uint64_t dWall = havePrev ? cur.wallNs - prev.wallNs : 0;
+        auto util = [&](std::uint32_t w) {
+            if (!havePrev || dWall == 0) return 0.0;
+            return double(cur.workerBusyNs[w] - prev.workerBusyNs[w]) / double(dWall);
+        };
+
+        if (csv) {
+            std::printf("%lld,%.3f,%.3f,%.3f,%u", (long long)cur.frame,
+                        double(cur.frameNs) / 1e3, double(cur.latenessNs) / 1e3,
+                        cur.driftMs, cur.catchUpSteps);
+            for (std::uint32_t i = 0; i < cur.phaseCount; ++i)
+                std::printf(",%.3f", double(cur.phaseNs[i]) / 1e3);
+            for (std::uint32_t i = 0; i < cur.workerCount; ++i)
+                std::printf(",%.3f", util(i));
+            std::printf("\n");
+        } else {
+            double fps = (havePrev && dWall) ? double(cur.frame - prev.frame) * 1e9 / double(dWall) : 0.0;
+            std::printf("frame=%lld rate=%.1fHz (target %.1f) frame=%.1fus late=%.1fus drift=%.2fms catchup=%u\n",
+                        (long long)cur.frame, fps, reader.hz(),
+                        double(cur.frameNs) / 1e3, double(cur.latenessNs) / 1e3,
+                        cur.driftMs, cur.catchUpSteps);
+            for (std::uint32_t i = 0; i < cur.phaseCount; ++i)
+                std::printf("  %-24s %10.1fus\n", cur.phaseNames[i], double(cur.phaseNs[i]) / 1e3);
+            if (cur.workerCount) {
+                std::printf("  workers:");
+                for (std::uint32_t i = 0; i < cur.workerCount; ++i)
+                    std::printf(" %3.0f%%", util(i) * 100.0);
+                std::printf("\n");
+            }
+        }
+        std::fflush(stdout);
+        prev = cur;
+        havePrev = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    }
+    if (stale()) {
+        std::fprintf(stderr, "metrics segment '%s' stale: frame %lld unchanged for %ld ms\n",
+                     name.c_str(), (long long)lastFrame, staleMs);
+        return 3;
+    }
+}
@@ -0,0 +1,65 @@
+// Compare two saved profiles (ProfileFile::save) section by section and
+// report mean deltas with confidence intervals plus p50/p99 side by side.
+#include "profile_io.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static double parseDouble(const char* s, double def){ if(!s) return def; char* e=nullptr; double v=strtod(s,&e); return (e && *e==0)? v: def; }
+
+int main(int argc, char* argv[]) {
+    std::string pathA, pathB;
+    double confidence = 0.95;
+    double minEffectPct = 1.0;
+    bool failOnSlower = false;
+    bool showAll = false;
+
+    for (int i=1;i<argc;++i){
+        if (std::strcmp(argv[i],"--confidence")==0 && i+1<argc) confidence = parseDouble(argv[++i], confidence);
+        else if (std::strcmp(argv[i],"--min-effect")==0 && i+1<argc) minEffectPct = parseDouble(argv[++i], minEffectPct);
+        else if (std::strcmp(argv[i],"--fail-on-slower")==0) failOnSlower = true;
+        else if (std::strcmp(argv[i],"--all")==0) showAll = true;
+        else if (pathA.empty()) pathA = argv[i];
+        else if (pathB.empty()) pathB = argv[i];
+    }
+    if (pathA.empty() || pathB.empty() || confidence <= 0.0 || confidence >= 1.0) {
+        std::fprintf(stderr,
+            "usage: %s BASE.json NEW.json [--confidence 0.95] [--min-effect pct] [--all] [--fail-on-slower]\n",
+            argv[0]);
+        return 2;
+    }
+
+    ProfileRun a, b;
+    std::string err;
+    if (!ProfileFile::load(pathA, a, &err) || !ProfileFile::load(pathB, b, &err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 2;
+    }
+
+    auto deltas = ProfileFile::compare(a, b, confidence, minEffectPct);
+    std::printf("A: %s (%s)\nB: %s (%s)\n%.1f%% CI, min effect %.2f%%\n\n",
+                pathA.c_str(), a.label.c_str(), pathB.c_str(), b.label.c_str(),
+                confidence * 100.0, minEffectPct);
+    std::printf("%-40s %10s %10s %9s %21s %10s %10s  %s\n",
+                "Section", "A avg(us)", "B avg(us)", "delta", "CI", "A p99(us)", "B p99(us)", "verdict");
+
+    int slower = 0, faster = 0;
+    for (auto& d : deltas) {
+        if (d.onlyInA || d.onlyInB) {
+            std::printf("%-40s %s\n", d.name.c_str(), d.onlyInA ? "(only in A)" : "(only in B)");
+            continue;
+        }
+        if (!showAll && !d.significant) continue;
+        const char* verdict = "~";
+        if (d.significant) {
+            verdict = d.deltaPct > 0 ? "SLOWER" : "faster";
+            (d.deltaPct > 0 ? slower : faster)++;
+        }
+        std::printf("%-40s %10.3f %10.3f %+8.2f%% [%+8.2f%%,%+8.2f%%] %10.3f %10.3f  %s\n",
+                    d.name.c_str(), d.meanA / 1e3, d.meanB / 1e3, d.deltaPct,
+                    d.ciLowPct, d.ciHighPct, d.p99A / 1e3, d.p99B / 1e3, verdict);
+    }
+    std::printf("\n%d slower, %d faster, %zu sections compared\n", slower, faster, deltas.size());
+    return (failOnSlower && slower) ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+// Builds a binary scenario file (scenario.hpp) from text configs, or lists
+// the columns of an existing one.
+//
+//   CSV input:  table named after the file stem (or "table=path.csv"); the
+//               header row names the fields, optionally typed as
+//               "field:f64|f32|i64|i32|u8" (default f64).
+//   Other text: "key = value" lines, '#' comments; each key becomes a
+//               one-element f64 column "<table>.<key>".
+#include "scenario.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::string trim(const std::string& s) {
+    std::size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return {};
+    std::size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> out;
+    std::stringstream ss(line);
+    std::string cell;
+    while (std::getline(ss, cell, ',')) out.push_back(trim(cell));
+    if (!line.empty() && line.back() == ',') out.emplace_back();
+    return out;
+}
+
+bool parseNumber(const std::string& s, double& v) {
+    if (s.empty()) return false;
+    char* e = nullptr;
+    v = std::strtod(s.c_str(), &e);
+    return e && *e == 0;
+}
+
+struct Field {
+    std::string name;
+    ScenarioColumnDesc::Type type = ScenarioColumnDesc::Type::F64;
+    std::vector<double> values;
+};
+
+bool parseType(const std::string& s, ScenarioColumnDesc::Type& t) {
+    using T = ScenarioColumnDesc::Type;
+    if (s == "f64") t = T::F64;
+    else if (s == "f32") t = T::F32;
+    else if (s == "i64") t = T::I64;
+    else if (s == "i32") t = T::I32;
+    else if (s == "u8")  t = T::U8;
+    else return false;
+    return true;
+}
+
+template <class T>
+bool inRange(double v) {
+    return v >= static_cast<double>(std::numeric_limits<T>::lowest()) &&
+           v <  static_cast<double>(std::numeric_limits<T>::max()) + 1.0;
+}
+
+// Why v cannot be stored in a column of type t, or null if it can:
+// integer columns take whole numbers in range, f32 keeps finite values finite.
+const char* checkValue(ScenarioColumnDesc::Type t, double v) {
+    using T = ScenarioColumnDesc::Type;
+    if (t == T::F64) return nullptr;
+    if (t == T::F32)
+        return std::isfinite(v) && std::fabs(v) > double(std::numeric_limits<float>::max())
+             ? "out of range for f32" : nullptr;
+    if (v != std::trunc(v)) return std::isinf(v) ? "out of range" : "not an integer";
+    bool ok = false;
+    switch (t) {
+        case T::I64: ok = inRange<std::int64_t>(v); break;
+        case T::I32: ok = inRange<std::int32_t>(v); break;
+        case T::U8:  ok = inRange<std::uint8_t>(v); break;
+        default: break;
+    }
+    return ok ? nullptr : "out of range";
+}
+
+// Values were checked by checkValue() when parsed.
+template <class T>
+bool addAs(ScenarioWriter& w, const std::string& name, const std::vector<double>& v) {
+    std::vector<T> out(v.size());
+    for (std::size_t i = 0; i < v.size(); ++i) out[i] = static_cast<T>(v[i]);
+    return w.addColumn(name, out);
+}
+
+bool addField(ScenarioWriter& w, const std::string& table, const Field& f) {
+    using T = ScenarioColumnDesc::Type;
+    const std::string name = table + "." + f.name;
+    switch (f.type) {
+        case T::F64: return w.addColumn(name, f.values);
+        case T::F32: return addAs<float>(w, name, f.values);
+        case T::I64: return addAs<std::int64_t>(w, name, f.values);
+        case T::I32: return addAs<std::int32_t>(w, name, f.values);
+        case T::U8:  return addAs<std::uint8_t>(w, name, f.values);
+    }
+    return false;
+}
+
+bool convertCsv(ScenarioWriter& w, const std::string& table, const std::string& path) {
+    std::ifstream in(path);
+    if (!in) { std::fprintf(stderr, "cannot open %s\n", path.c_str()); return false; }
+    std::string line;
+    std::vector<Field> fields;
+    std::size_t lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        std::string t = trim(line);
+        if (t.empty() || t[0] == '#') continue;
+        auto cells = splitCsv(t);
+        if (fields.empty()) {
+            for (auto& c : cells) {
+                Field f;
+                std::size_t colon = c.find(':');
+                f.name = trim(c.substr(0, colon));
+                if (colon != std::string::npos && !parseType(trim(c.substr(colon + 1)), f.type)) {
+                    std::fprintf(stderr, "%s:%zu: unknown type in '%s'\n", path.c_str(), lineNo, c.c_str());
+                    return false;
+                }
+                fields.push_back(std::move(f));
+            }
+            continue;
+        }
+        if (cells.size() != fields.size()) {
+            std::fprintf(stderr, "%s:%zu: expected %zu cells, got %zu\n", path.c_str(), lineNo, fields.size(), cells.size());
+            return false;
+        }
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            double v;
+            if (!parseNumber(cells[i], v)) {
+                std::fprintf(stderr, "%s:%zu: '%s' is not a number\n", path.c_str(), lineNo, cells[i].c_str());
+                return false;
+            }
+            if (const char* why = checkValue(fields[i].type, v)) {
+                std::fprintf(stderr, "%s:%zu: '%s' for %s: %s\n", path.c_str(), lineNo, cells[i].c_str(),
+                             fields[i].name.c_str(), why);
+                return false;
+            }
+            fields[i].values.push_back(v);
+        }
+    }
+    for (auto& f : fields) {
+        if (!addField(w, table, f)) {
+            std::fprintf(stderr, "%s: cannot add column %s.%s\n", path.c_str(), table.c_str(), f.name.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool convertKeyValue(ScenarioWriter& w, const std::string& table, const std::string& path) {
+    std::ifstream in(path);
+    if (!in) { std::fprintf(stderr, "cannot open %s\n", path.c_str()); return false; }
+    std::string line;
+    std::size_t lineNo = 0;
+    while (std::getline(in, line)) {
+        ++lineNo;
+        std::string t = trim(line.substr(0, line.find('#')));
+        if (t.empty()) continue;
+        std::size_t eq = t.find('=');
+        double v;
+        if (eq == std::string::npos || !parseNumber(trim(t.substr(eq + 1)), v)) {
+            std::fprintf(stderr, "%s:%zu: expected 'key = number'\n", path.c_str(), lineNo);
+            return false;
+        }
+        Field f;
+        f.name = trim(t.substr(0, eq));
+        f.values.push_back(v);
+        if (!addField(w, table, f)) {
+            std::fprintf(stderr, "%s:%zu: cannot add column %s.%s\n", path.c_str(), lineNo, table.c_str(), f.name.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+const char* typeName(ScenarioColumnDesc::Type t) {
+    using T = ScenarioColumnDesc::Type;
+    switch (t) {
+        case T::F64: return "f64";
+        case T::F32: return "f32";
+        case T::I64: return "i64";
+        case T::I32: return "i32";
+        case T::U8:  return "u8";
+    }
+    return "?";
+}
+
+int info(const std::string& path) {
+    Scenario s;
+    if (!s.open(path, true)) {
+        std::fprintf(stderr, "%s: %s\n", path.c_str(), s.error().c_str());
+        return 1;
+    }
+    for (std::size_t i = 0; i < s.columnCount(); ++i) {
+        const auto& c = s.column(i);
+        std::printf("%-40s %-4s %10llu @%llu\n", c.name, typeName(c.type),
+                    (unsigned long long)c.count, (unsigned long long)c.offset);
+    }
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string out;
+    std::vector<std::string> inputs;
+    for (int i=1;i<argc;++i){
+        if ((std::strcmp(argv[i],"-o")==0 || std::strcmp(argv[i],"--out")==0) && i+1<argc) out = argv[++i];
+        else if (std::strcmp(argv[i],"--info")==0 && i+1<argc) return info(argv[++i]);
+        else if (argv[i][0] != '-') inputs.push_back(argv[i]);
+        else {
+            std::fprintf(stderr, "usage: %s -o out.scn [table=]file.csv|file.cfg ...\n"
+                                 "       %s --info file.scn\n", argv[0], argv[0]);
+            return 2;
+        }
+    }
+    if (out.empty() || inputs.empty()) {
+        std::fprintf(stderr, "usage: %s -o out.scn [table=]file.csv|file.cfg ...\n", argv[0]);
+        return 2;
+    }
+
+    ScenarioWriter w;
+    for (const auto& arg : inputs) {
+        std::string path = arg, table;
+        std::size_t eq = arg.find('=');
+        if (eq != std::string::npos) { table = arg.substr(0, eq); path = arg.substr(eq + 1); }
+        std::size_t slash = path.find_last_of('/');
+        std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+        std::size_t dot = base.find_last_of('.');
+        std::string ext = dot == std::string::npos ? std::string() : base.substr(dot + 1);
+        if (table.empty()) table = base.substr(0, dot);
+        bool ok = ext == "csv" ? convertCsv(w, table, path) : convertKeyValue(w, table, path);
+        if (!ok) return 1;
+    }
+    if (!w.write(out)) {
+        std::fprintf(stderr, "cannot write %s\n", out.c_str());
+        return 1;
+    }
+    std::printf("wrote %s (%zu columns)\n", out.c_str(), w.columnCount());
+    return 0;
+}